@@ -913,106 +913,246 @@ heap_modify_tuple_by_cols(HeapTuple tuple,
 }
 
 /*
- * heap_deform_tuple
- *		Given a tuple, extract data into values/isnull arrays; this is
- *		the inverse of heap_form_tuple.
- *
- *		Storage for the values/isnull arrays is provided by the caller;
- *		it should be sized according to tupleDesc->natts not
- *		HeapTupleHeaderGetNatts(tuple->t_data).
+ * Alignment, in bytes, called for by an attalign value
+ */
+static int
+attalign_bytes(char attalign)
+{
+	switch (attalign)
+	{
+		case 'c':
+			return 1;
+		case 's':
+			return ALIGNOF_SHORT;
+		case 'i':
+			return ALIGNOF_INT;
+		case 'd':
+			return ALIGNOF_DOUBLE;
+		default:
+			elog(ERROR, "invalid attalign value: %c", attalign);
+			return 0;			/* keep compiler quiet */
+	}
+}
+
+/*
+ * build_deform_steps
+ *		Fill in the deforming steps of a tuple descriptor.
  *
- *		Note that for pass-by-reference datatypes, the pointer placed
- *		in the Datum will point into the given tuple.
+ * The attributes are divided into runs, within which the position of each
+ * attribute relative to the start of the run doesn't depend on the data.
+ * A run ends after a variable-width attribute, and before an attribute that
+ * needs more alignment than the start of the run is known to have.  Only the
+ * first attribute of a run has to be aligned at run time; the alignment
+ * padding before each of the others is computed here, and is good as long as
+ * no attribute of the run is null.  Since the tuple data is MAXALIGN'd, the
+ * first run starts at offset 0 and never ends because of alignment, so its
+ * attributes are at fixed offsets in every tuple without nulls among them.
+ * Those are the ones attcacheoff can be set for, too, so we take the chance.
  *
- *		When all or most of a tuple's fields need to be extracted,
- *		this routine will be significantly quicker than a loop around
- *		heap_getattr; the loop will become O(N^2) as soon as any
- *		noncacheable attribute offsets are involved.
+ * A varlena can belong to a run only if it needs no padding there, as it
+ * is not aligned at all if it has a short header; see att_align_pointer.
  */
-void
-heap_deform_tuple(HeapTuple tuple, TupleDesc tupleDesc,
-				  Datum *values, bool *isnull)
+static void
+build_deform_steps(TupleDesc tupleDesc)
 {
-	HeapTupleHeader tup = tuple->t_data;
-	bool		hasnulls = HeapTupleHasNulls(tuple);
 	Form_pg_attribute *att = tupleDesc->attrs;
-	int			tdesc_natts = tupleDesc->natts;
-	int			natts;			/* number of atts to extract */
+	int			natts = tupleDesc->natts;
+	int			nfixed = 0;
+	bool		inrun = true;	/* can the next attribute join the run? */
+	bool		leading = true; /* is the run the first one? */
+	int			runalign = MAXIMUM_ALIGNOF;
+	long		reloff = 0;		/* end of run so far, from start of run */
 	int			attnum;
+
+	for (attnum = 0; attnum < natts; attnum++)
+	{
+		Form_pg_attribute thisatt = att[attnum];
+		TupleDeformStep *step = &tupleDesc->tddeform[attnum];
+		int			alignby = attalign_bytes(thisatt->attalign);
+		long		aligned = att_align_nominal(reloff, thisatt->attalign);
+
+		step->attlen = thisatt->attlen;
+		step->attbyval = thisatt->attbyval;
+		step->attalign = thisatt->attalign;
+
+		if (inrun && alignby <= runalign &&
+			(thisatt->attlen != -1 || aligned == reloff))
+		{
+			step->attpad = (uint8) (aligned - reloff);
+			step->attrealign = false;
+			reloff = aligned;
+		}
+		else
+		{
+			/* start a new run */
+			step->attpad = 0;
+			step->attrealign = true;
+			leading = false;
+			runalign = alignby;
+			reloff = 0;
+		}
+
+		if (leading)
+		{
+			step->attoff = (int32) reloff;
+			thisatt->attcacheoff = (int32) reloff;
+			nfixed = attnum + 1;
+		}
+		else
+			step->attoff = -1;
+
+		if (thisatt->attlen > 0)
+			reloff += thisatt->attlen;
+		else
+		{
+			inrun = false;
+			leading = false;
+		}
+	}
+
+	tupleDesc->tdnfixed = nfixed;
+}
+
+/*
+ * deform_tuple_data
+ *		Extract attributes attnum .. natts - 1 of a tuple into values/isnull,
+ *		following the tuple descriptor's deforming steps.
+ *
+ * On entry, *offp is the offset at which attribute attnum's data starts, if
+ * it's not null, before alignment; and *slowp tells whether the precomputed
+ * alignment padding can't be relied upon, because an earlier attribute in
+ * the same run was null.  Both are updated for the next attribute on exit.
+ * Returns the number of the attribute after the last one extracted.
+ * Caller must make sure the steps have been built, and that the tuple has at
+ * least natts attributes.
+ */
+static inline int
+deform_tuple_data(TupleDesc tupleDesc, HeapTupleHeader tup, bool hasnulls,
+				  int attnum, int natts, Datum *values, bool *isnull,
+				  long *offp, bool *slowp)
+{
+	TupleDeformStep *steps = tupleDesc->tddeform;
 	char	   *tp;				/* ptr to tuple data */
-	long		off;			/* offset in tuple data */
+	long		off = *offp;	/* offset in tuple data */
 	bits8	   *bp = tup->t_bits;	/* ptr to null bitmap in tuple */
-	bool		slow = false;	/* can we use/set attcacheoff? */
+	bool		slow = *slowp;	/* can we use the precomputed padding? */
+	int			nfast;
 
-	natts = HeapTupleHeaderGetNatts(tup);
+	tp = (char *) tup + tup->t_hoff;
 
 	/*
-	 * In inheritance situations, it is possible that the given tuple actually
-	 * has more fields than the caller is expecting.  Don't run off the end of
-	 * the caller's arrays.
+	 * Without nulls, the leading attributes can be fetched straight from
+	 * their fixed offsets.
 	 */
-	natts = Min(natts, tdesc_natts);
+	nfast = Min(natts, tupleDesc->tdnfixed);
+	if (!hasnulls && attnum < nfast)
+	{
+		TupleDeformStep *step;
 
-	tp = (char *) tup + tup->t_hoff;
+		for (; attnum < nfast; attnum++)
+		{
+			step = &steps[attnum];
+			values[attnum] = fetch_att(tp + step->attoff, step->attbyval,
+									   step->attlen);
+			isnull[attnum] = false;
+		}
 
-	off = 0;
+		step = &steps[attnum - 1];
+		off = att_addlength_pointer(step->attoff, step->attlen,
+									tp + step->attoff);
+		slow = false;
+	}
 
-	for (attnum = 0; attnum < natts; attnum++)
+	for (; attnum < natts; attnum++)
 	{
-		Form_pg_attribute thisatt = att[attnum];
+		TupleDeformStep *step = &steps[attnum];
 
 		if (hasnulls && att_isnull(attnum, bp))
 		{
 			values[attnum] = (Datum) 0;
 			isnull[attnum] = true;
-			slow = true;		/* can't use attcacheoff anymore */
+			slow = true;		/* later padding in the run may differ */
 			continue;
 		}
 
 		isnull[attnum] = false;
 
-		if (!slow && thisatt->attcacheoff >= 0)
-			off = thisatt->attcacheoff;
-		else if (thisatt->attlen == -1)
+		if (step->attrealign || slow)
 		{
-			/*
-			 * We can only cache the offset for a varlena attribute if the
-			 * offset is already suitably aligned, so that there would be no
-			 * pad bytes in any case: then the offset will be valid for either
-			 * an aligned or unaligned value.
-			 */
-			if (!slow &&
-				off == att_align_nominal(off, thisatt->attalign))
-				thisatt->attcacheoff = off;
+			if (step->attlen == -1)
+				off = att_align_pointer(off, step->attalign, -1, tp + off);
 			else
 			{
-				off = att_align_pointer(off, thisatt->attalign, -1,
-										tp + off);
-				slow = true;
+				/* not varlena, so safe to use att_align_nominal */
+				off = att_align_nominal(off, step->attalign);
 			}
+
+			/* a new run starts here, where the padding is good again */
+			if (step->attrealign)
+				slow = false;
 		}
 		else
-		{
-			/* not varlena, so safe to use att_align_nominal */
-			off = att_align_nominal(off, thisatt->attalign);
+			off += step->attpad;
 
-			if (!slow)
-				thisatt->attcacheoff = off;
-		}
+		values[attnum] = fetch_att(tp + off, step->attbyval, step->attlen);
 
-		values[attnum] = fetchatt(thisatt, tp + off);
+		off = att_addlength_pointer(off, step->attlen, tp + off);
+	}
 
-		off = att_addlength_pointer(off, thisatt->attlen, tp + off);
+	*offp = off;
+	*slowp = slow;
 
-		if (thisatt->attlen <= 0)
-			slow = true;		/* can't use attcacheoff anymore */
-	}
+	return attnum;
+}
+
+/*
+ * heap_deform_tuple
+ *		Given a tuple, extract data into values/isnull arrays; this is
+ *		the inverse of heap_form_tuple.
+ *
+ *		Storage for the values/isnull arrays is provided by the caller;
+ *		it should be sized according to tupleDesc->natts not
+ *		HeapTupleHeaderGetNatts(tuple->t_data).
+ *
+ *		Note that for pass-by-reference datatypes, the pointer placed
+ *		in the Datum will point into the given tuple.
+ *
+ *		When all or most of a tuple's fields need to be extracted,
+ *		this routine will be significantly quicker than a loop around
+ *		heap_getattr; the loop will become O(N^2) as soon as any
+ *		noncacheable attribute offsets are involved.
+ */
+void
+heap_deform_tuple(HeapTuple tuple, TupleDesc tupleDesc,
+				  Datum *values, bool *isnull)
+{
+	HeapTupleHeader tup = tuple->t_data;
+	int			tdesc_natts = tupleDesc->natts;
+	int			natts;			/* number of atts to extract */
+	int			attnum;
+	long		off = 0;
+	bool		slow = false;
+
+	natts = HeapTupleHeaderGetNatts(tup);
+
+	/*
+	 * In inheritance situations, it is possible that the given tuple actually
+	 * has more fields than the caller is expecting.  Don't run off the end of
+	 * the caller's arrays.
+	 */
+	natts = Min(natts, tdesc_natts);
+
+	if (tupleDesc->tdnfixed < 0)
+		build_deform_steps(tupleDesc);
+
+	deform_tuple_data(tupleDesc, tup, HeapTupleHasNulls(tuple), 0, natts,
+					  values, isnull, &off, &slow);
 
 	/*
 	 * If tuple doesn't have all the atts indicated by tupleDesc, read the
 	 * rest as null
 	 */
-	for (; attnum < tdesc_natts; attnum++)
+	for (attnum = natts; attnum < tdesc_natts; attnum++)
 	{
 		values[attnum] = (Datum) 0;
 		isnull[attnum] = true;
@@ -1033,18 +1173,11 @@ heap_deform_tuple(HeapTuple tuple, TupleDesc tupleDesc,
 static void
 slot_deform_tuple(TupleTableSlot *slot, int natts)
 {
-	HeapTuple	tuple = slot->tts_tuple;
 	TupleDesc	tupleDesc = slot->tts_tupleDescriptor;
-	Datum	   *values = slot->tts_values;
-	bool	   *isnull = slot->tts_isnull;
-	HeapTupleHeader tup = tuple->t_data;
-	bool		hasnulls = HeapTupleHasNulls(tuple);
-	Form_pg_attribute *att = tupleDesc->attrs;
+	HeapTuple	tuple = slot->tts_tuple;
 	int			attnum;
-	char	   *tp;				/* ptr to tuple data */
 	long		off;			/* offset in tuple data */
-	bits8	   *bp = tup->t_bits;	/* ptr to null bitmap in tuple */
-	bool		slow;			/* can we use/set attcacheoff? */
+	bool		slow;			/* can we use the precomputed padding? */
 
 	/*
 	 * Check whether the first call for this tuple, and initialize or restore
@@ -1064,58 +1197,13 @@ slot_deform_tuple(TupleTableSlot *slot, int natts)
 		slow = slot->tts_slow;
 	}
 
-	tp = (char *) tup + tup->t_hoff;
-
-	for (; attnum < natts; attnum++)
-	{
-		Form_pg_attribute thisatt = att[attnum];
-
-		if (hasnulls && att_isnull(attnum, bp))
-		{
-			values[attnum] = (Datum) 0;
-			isnull[attnum] = true;
-			slow = true;		/* can't use attcacheoff anymore */
-			continue;
-		}
-
-		isnull[attnum] = false;
+	if (tupleDesc->tdnfixed < 0)
+		build_deform_steps(tupleDesc);
 
-		if (!slow && thisatt->attcacheoff >= 0)
-			off = thisatt->attcacheoff;
-		else if (thisatt->attlen == -1)
-		{
-			/*
-			 * We can only cache the offset for a varlena attribute if the
-			 * offset is already suitably aligned, so that there would be no
-			 * pad bytes in any case: then the offset will be valid for either
-			 * an aligned or unaligned value.
-			 */
-			if (!slow &&
-				off == att_align_nominal(off, thisatt->attalign))
-				thisatt->attcacheoff = off;
-			else
-			{
-				off = att_align_pointer(off, thisatt->attalign, -1,
-										tp + off);
-				slow = true;
-			}
-		}
-		else
-		{
-			/* not varlena, so safe to use att_align_nominal */
-			off = att_align_nominal(off, thisatt->attalign);
-
-			if (!slow)
-				thisatt->attcacheoff = off;
-		}
-
-		values[attnum] = fetchatt(thisatt, tp + off);
-
-		off = att_addlength_pointer(off, thisatt->attlen, tp + off);
-
-		if (thisatt->attlen <= 0)
-			slow = true;		/* can't use attcacheoff anymore */
-	}
+	attnum = deform_tuple_data(tupleDesc, tuple->t_data,
+							   HeapTupleHasNulls(tuple), attnum, natts,
+							   slot->tts_values, slot->tts_isnull,
+							   &off, &slow);
 
 	/*
 	 * Save state for next execution
@@ -29,14 +29,35 @@
 /* ----------------
  *		index_form_tuple
  *
- *		This shouldn't leak any memory; otherwise, callers such as
- *		tuplesort_putindextuplevalues() will be very unhappy.
+ *		As index_form_tuple_context, but allocates the returned tuple in the
+ *		CurrentMemoryContext.
  * ----------------
  */
 IndexTuple
 index_form_tuple(TupleDesc tupleDescriptor,
 				 Datum *values,
 				 bool *isnull)
+{
+	return index_form_tuple_context(tupleDescriptor, values, isnull,
+									CurrentMemoryContext);
+}
+
+/* ----------------
+ *		index_form_tuple_context
+ *
+ *		This shouldn't leak any memory; otherwise, callers such as
+ *		tuplesort_putindextuplevalues() will be very unhappy.
+ *
+ *		The returned tuple is allocated in 'context'.  Any temporary
+ *		allocations are made in CurrentMemoryContext and freed before
+ *		returning, so 'context' may be one that doesn't support pfree.
+ * ----------------
+ */
+IndexTuple
+index_form_tuple_context(TupleDesc tupleDescriptor,
+						 Datum *values,
+						 bool *isnull,
+						 MemoryContext context)
 {
 	char	   *tp;				/* tuple pointer */
 	IndexTuple	tuple;			/* return tuple */
@@ -129,7 +150,7 @@ index_form_tuple(TupleDesc tupleDescriptor,
 	size = hoff + data_size;
 	size = MAXALIGN(size);		/* be conservative */
 
-	tp = (char *) palloc0(size);
+	tp = (char *) MemoryContextAllocZero(context, size);
 	tuple = (IndexTuple) tp;
 
 	heap_fill_tuple(tupleDescriptor,
@@ -19,6 +19,9 @@
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
 #include "tcop/pquery.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
+#include "utils/int8.h"
 #include "utils/lsyscache.h"
 #include "utils/memdebug.h"
 #include "utils/memutils.h"
@@ -38,11 +41,18 @@ static void printtup_destroy(DestReceiver *self);
  * ----------------------------------------------------------------
  */
 
+/*
+ * A routine that appends a value's text output, with its length word, to a
+ * DataRow message, in place of calling the type's output function.
+ */
+typedef void (*PrinttupFastOut) (StringInfo buf, Datum value);
+
 /* ----------------
  *		Private state for a printtup destination object
  *
  * NOTE: finfo is the lookup info for either typoutput or typsend, whichever
- * we are using for this column.
+ * we are using for this column.  fastout is set for text output of some
+ * common built-in types; see printtup_fastout_for().
  * ----------------
  */
 typedef struct
@@ -52,6 +62,7 @@ typedef struct
 	bool		typisvarlena;	/* is it varlena (ie possibly toastable)? */
 	int16		format;			/* format code for this column */
 	FmgrInfo	finfo;			/* Precomputed call info for output fn */
+	PrinttupFastOut fastout;	/* direct text output routine, or NULL */
 } PrinttupAttrInfo;
 
 typedef struct
@@ -242,6 +253,105 @@ SendRowDescriptionMessage(TupleDesc typeinfo, List *targetlist, int16 *formats)
 	pq_endmessage(&buf);
 }
 
+/* ----------------
+ *		Direct text output of common built-in types
+ *
+ * These produce exactly what the types' output functions would, but write
+ * it straight into the message buffer, skipping the function call manager
+ * and the palloc'd intermediate string.  Integers and booleans come out as
+ * plain ASCII, which needs no conversion to any client encoding.  Text-like
+ * values are sent from the (detoasted) datum itself, converted to the client
+ * encoding only if that differs from the server's.
+ * ----------------
+ */
+static inline void
+printtup_send_ascii(StringInfo buf, const char *str)
+{
+	int			len = strlen(str);
+
+	pq_sendint(buf, len, 4);
+	appendBinaryStringInfo(buf, str, len);
+}
+
+static void
+printtup_int2_out(StringInfo buf, Datum value)
+{
+	char		str[7];			/* sign, 5 digits, '\0' */
+
+	pg_itoa(DatumGetInt16(value), str);
+	printtup_send_ascii(buf, str);
+}
+
+static void
+printtup_int4_out(StringInfo buf, Datum value)
+{
+	char		str[12];		/* sign, 10 digits, '\0' */
+
+	pg_ltoa(DatumGetInt32(value), str);
+	printtup_send_ascii(buf, str);
+}
+
+static void
+printtup_int8_out(StringInfo buf, Datum value)
+{
+	char		str[MAXINT8LEN + 1];
+
+	pg_lltoa(DatumGetInt64(value), str);
+	printtup_send_ascii(buf, str);
+}
+
+static void
+printtup_oid_out(StringInfo buf, Datum value)
+{
+	char		str[12];
+
+	snprintf(str, sizeof(str), "%u", DatumGetObjectId(value));
+	printtup_send_ascii(buf, str);
+}
+
+static void
+printtup_bool_out(StringInfo buf, Datum value)
+{
+	printtup_send_ascii(buf, DatumGetBool(value) ? "t" : "f");
+}
+
+static void
+printtup_text_out(StringInfo buf, Datum value)
+{
+	text	   *txt = DatumGetTextPP(value);
+
+	pq_sendcountedtext(buf, VARDATA_ANY(txt), VARSIZE_ANY_EXHDR(txt), false);
+}
+
+/*
+ * Choose a direct text output routine for a column, given its type's output
+ * function, or return NULL if there isn't one.  Going by the output function
+ * rather than the type lets domains over these types use them, too.
+ */
+static PrinttupFastOut
+printtup_fastout_for(Oid typoutput)
+{
+	switch (typoutput)
+	{
+		case F_INT2OUT:
+			return printtup_int2_out;
+		case F_INT4OUT:
+			return printtup_int4_out;
+		case F_INT8OUT:
+			return printtup_int8_out;
+		case F_OIDOUT:
+			return printtup_oid_out;
+		case F_BOOLOUT:
+			return printtup_bool_out;
+		case F_TEXTOUT:
+		case F_VARCHAROUT:
+		case F_BPCHAROUT:
+			return printtup_text_out;
+		default:
+			return NULL;
+	}
+}
+
 /*
  * Get the lookup info that printtup() needs
  */
@@ -276,6 +386,7 @@ printtup_prepare_info(DR_printtup *myState, TupleDesc typeinfo, int numAttrs)
 							  &thisState->typoutput,
 							  &thisState->typisvarlena);
 			fmgr_info(thisState->typoutput, &thisState->finfo);
+			thisState->fastout = printtup_fastout_for(thisState->typoutput);
 		}
 		else if (format == 1)
 		{
@@ -347,7 +458,12 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 			VALGRIND_CHECK_MEM_IS_DEFINED(DatumGetPointer(attr),
 										  VARSIZE_ANY(attr));
 
-		if (thisState->format == 0)
+		if (thisState->fastout != NULL)
+		{
+			/* Text output, without calling the output function */
+			thisState->fastout(&buf, attr);
+		}
+		else if (thisState->format == 0)
 		{
 			/* Text output */
 			char	   *outputstr;
@@ -61,10 +61,13 @@ CreateTemplateTupleDesc(int natts, bool hasoid)
 	 * Note: Only the fixed part of pg_attribute rows is included in tuple
 	 * descriptors, so we only need ATTRIBUTE_FIXED_PART_SIZE space per attr.
 	 * That might need alignment padding, however.
+	 *
+	 * The deforming steps go after the attribute rows.
 	 */
 	attroffset = sizeof(struct tupleDesc) + natts * sizeof(Form_pg_attribute);
 	attroffset = MAXALIGN(attroffset);
-	stg = palloc(attroffset + natts * MAXALIGN(ATTRIBUTE_FIXED_PART_SIZE));
+	stg = palloc(attroffset + natts * MAXALIGN(ATTRIBUTE_FIXED_PART_SIZE) +
+				 natts * sizeof(TupleDeformStep));
 	desc = (TupleDesc) stg;
 
 	if (natts > 0)
@@ -80,9 +83,13 @@ CreateTemplateTupleDesc(int natts, bool hasoid)
 			attrs[i] = (Form_pg_attribute) stg;
 			stg += MAXALIGN(ATTRIBUTE_FIXED_PART_SIZE);
 		}
+		desc->tddeform = (TupleDeformStep *) stg;
 	}
 	else
+	{
 		desc->attrs = NULL;
+		desc->tddeform = NULL;
+	}
 
 	/*
 	 * Initialize other fields of the tupdesc.
@@ -93,6 +100,7 @@ CreateTemplateTupleDesc(int natts, bool hasoid)
 	desc->tdtypmod = -1;
 	desc->tdhasoid = hasoid;
 	desc->tdrefcount = -1;		/* assume not reference-counted */
+	desc->tdnfixed = -1;
 
 	return desc;
 }
@@ -118,7 +126,9 @@ CreateTupleDesc(int natts, bool hasoid, Form_pg_attribute *attrs)
 	 */
 	AssertArg(natts >= 0);
 
-	desc = (TupleDesc) palloc(sizeof(struct tupleDesc));
+	/* the deforming steps go after the struct, which is suitably aligned */
+	desc = (TupleDesc) palloc(sizeof(struct tupleDesc) +
+							  natts * sizeof(TupleDeformStep));
 	desc->attrs = attrs;
 	desc->natts = natts;
 	desc->constr = NULL;
@@ -126,6 +136,9 @@ CreateTupleDesc(int natts, bool hasoid, Form_pg_attribute *attrs)
 	desc->tdtypmod = -1;
 	desc->tdhasoid = hasoid;
 	desc->tdrefcount = -1;		/* assume not reference-counted */
+	desc->tdnfixed = -1;
+	desc->tddeform = (natts > 0) ?
+		(TupleDeformStep *) ((char *) desc + sizeof(struct tupleDesc)) : NULL;
 
 	return desc;
 }
@@ -254,6 +267,7 @@ TupleDescCopyEntry(TupleDesc dst, AttrNumber dstAttno,
 	 */
 	dst->attrs[dstAttno - 1]->attnum = dstAttno;
 	dst->attrs[dstAttno - 1]->attcacheoff = -1;
+	dst->tdnfixed = -1;
 
 	/* since we're not copying constraints or defaults, clear these */
 	dst->attrs[dstAttno - 1]->attnotnull = false;
@@ -532,6 +546,7 @@ TupleDescInitEntry(TupleDesc desc,
 	att->attstattarget = -1;
 	att->attcacheoff = -1;
 	att->atttypmod = typmod;
+	desc->tdnfixed = -1;
 
 	att->attnum = attributeNumber;
 	att->attndims = attdim;
@@ -590,6 +605,7 @@ TupleDescInitBuiltinEntry(TupleDesc desc,
 	att->attstattarget = -1;
 	att->attcacheoff = -1;
 	att->atttypmod = typmod;
+	desc->tdnfixed = -1;
 
 	att->attnum = attributeNumber;
 	att->attndims = attdim;
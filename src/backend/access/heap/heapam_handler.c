@@ -0,0 +1,229 @@
+/*-------------------------------------------------------------------------
+ *
+ * heapam_handler.c
+ *	  heap table access method code
+ *
+ * These are thin wrappers that expose the heap functions in heapam.c and
+ * vacuumlazy.c through the table AM API, for code that works on any table.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/heap/heapam_handler.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/heapam.h"
+#include "access/htup_details.h"
+#include "access/relscan.h"
+#include "access/tableam.h"
+#include "commands/vacuum.h"
+#include "storage/bufmgr.h"
+#include "utils/builtins.h"
+#include "utils/tqual.h"
+
+
+/* ------------------------------------------------------------------------
+ * Scan callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static TableScanDesc
+heapam_scan_begin(Relation rel, Snapshot snapshot, int nkeys, ScanKey key)
+{
+	return (TableScanDesc) heap_beginscan(rel, snapshot, nkeys, key);
+}
+
+static void
+heapam_scan_rescan(TableScanDesc scan, ScanKey key)
+{
+	heap_rescan((HeapScanDesc) scan, key);
+}
+
+static void
+heapam_scan_end(TableScanDesc scan)
+{
+	heap_endscan((HeapScanDesc) scan);
+}
+
+static bool
+heapam_scan_getnextslot(TableScanDesc sscan, ScanDirection direction,
+						TupleTableSlot *slot)
+{
+	HeapScanDesc scan = (HeapScanDesc) sscan;
+	HeapTuple	tuple;
+
+	tuple = heap_getnext(scan, direction);
+	if (tuple == NULL)
+	{
+		ExecClearTuple(slot);
+		return false;
+	}
+
+	/*
+	 * The tuple points into the scan's current buffer, which the slot keeps
+	 * a pin on until it is cleared; see SeqNext.  But the header is the
+	 * scan's rs_ctup, which the next heap_getnext overwrites, so the slot
+	 * needs its own copy of that.
+	 */
+	slot->tts_bufhdr = *tuple;
+	ExecStoreTuple(&slot->tts_bufhdr, slot, scan->rs_cbuf, false);
+
+	return true;
+}
+
+/* ------------------------------------------------------------------------
+ * Callbacks for fetching and modifying individual tuples
+ * ------------------------------------------------------------------------
+ */
+
+static bool
+heapam_fetch_row_version(Relation rel, ItemPointer tid, Snapshot snapshot,
+						 TupleTableSlot *slot)
+{
+	HeapTupleData tuple;
+	Buffer		buffer;
+
+	tuple.t_self = *tid;
+	if (!heap_fetch(rel, snapshot, &tuple, &buffer, false, NULL))
+		return false;
+
+	/*
+	 * The slot would keep a pointer to our local HeapTupleData, so store a
+	 * copy of the tuple instead, and let go of the buffer.
+	 */
+	ExecStoreTuple(heap_copytuple(&tuple), slot, InvalidBuffer, true);
+	ReleaseBuffer(buffer);
+
+	return true;
+}
+
+static bool
+heapam_tuple_satisfies_snapshot(Relation rel, TupleTableSlot *slot,
+								Snapshot snapshot)
+{
+	HeapTuple	tuple = slot->tts_tuple;
+	HeapTupleData pagetup;
+	Buffer		buffer;
+	Page		page;
+	OffsetNumber offnum;
+	ItemId		lp;
+	bool		res;
+
+	Assert(tuple != NULL);
+
+	/*
+	 * A tuple from a scan is still in the buffer the slot keeps pinned, and
+	 * we just need to lock that to check it.
+	 */
+	if (BufferIsValid(slot->tts_buffer))
+	{
+		LockBuffer(slot->tts_buffer, BUFFER_LOCK_SHARE);
+		res = HeapTupleSatisfiesVisibility(tuple, snapshot, slot->tts_buffer);
+		LockBuffer(slot->tts_buffer, BUFFER_LOCK_UNLOCK);
+		return res;
+	}
+
+	/*
+	 * But heapam_fetch_row_version stores a copy, whose hint bits may be out
+	 * of date, and setting them would only change the copy.  Check the
+	 * version on the page instead.  If it has been pruned away since, and
+	 * maybe the line pointer reused for some other tuple, it can't be
+	 * visible to anyone anymore.
+	 */
+	buffer = ReadBuffer(rel, ItemPointerGetBlockNumber(&tuple->t_self));
+	LockBuffer(buffer, BUFFER_LOCK_SHARE);
+	page = BufferGetPage(buffer);
+	offnum = ItemPointerGetOffsetNumber(&tuple->t_self);
+	lp = PageGetItemId(page, offnum);
+
+	if (offnum > PageGetMaxOffsetNumber(page) || !ItemIdIsNormal(lp))
+		res = false;
+	else
+	{
+		pagetup.t_data = (HeapTupleHeader) PageGetItem(page, lp);
+		pagetup.t_len = ItemIdGetLength(lp);
+		pagetup.t_self = tuple->t_self;
+		pagetup.t_tableOid = RelationGetRelid(rel);
+		if (HeapTupleHeaderGetRawXmin(pagetup.t_data) !=
+			HeapTupleHeaderGetRawXmin(tuple->t_data))
+			res = false;
+		else
+			res = HeapTupleSatisfiesVisibility(&pagetup, snapshot, buffer);
+	}
+
+	UnlockReleaseBuffer(buffer);
+
+	return res;
+}
+
+static Oid
+heapam_tuple_insert(Relation rel, HeapTuple tup, CommandId cid, int options,
+					BulkInsertState bistate)
+{
+	return heap_insert(rel, tup, cid, options, bistate);
+}
+
+static HTSU_Result
+heapam_tuple_delete(Relation rel, ItemPointer tid, CommandId cid,
+					Snapshot crosscheck, bool wait,
+					HeapUpdateFailureData *hufd)
+{
+	return heap_delete(rel, tid, cid, crosscheck, wait, hufd);
+}
+
+static HTSU_Result
+heapam_tuple_update(Relation rel, ItemPointer otid, HeapTuple newtup,
+					CommandId cid, Snapshot crosscheck, bool wait,
+					HeapUpdateFailureData *hufd, LockTupleMode *lockmode)
+{
+	return heap_update(rel, otid, newtup, cid, crosscheck, wait, hufd,
+					   lockmode);
+}
+
+/* ------------------------------------------------------------------------
+ * Definition of the heap table access method
+ * ------------------------------------------------------------------------
+ */
+
+static const TableAmRoutine heapam_methods = {
+	T_TableAmRoutine,
+
+	heapam_scan_begin,
+	heapam_scan_rescan,
+	heapam_scan_end,
+	heapam_scan_getnextslot,
+
+	heapam_fetch_row_version,
+
+	heapam_tuple_satisfies_snapshot,
+
+	heapam_tuple_insert,
+	heapam_tuple_delete,
+	heapam_tuple_update,
+
+	lazy_vacuum_rel
+};
+
+/*
+ * GetHeapamTableAmRoutine - get the heap AM's API struct without a catalog
+ * lookup, for use by relcache.c and for recognizing heap relations.
+ */
+const TableAmRoutine *
+GetHeapamTableAmRoutine(void)
+{
+	return &heapam_methods;
+}
+
+/*
+ * heap_tableam_handler - handler function for the heap table AM
+ */
+Datum
+heap_tableam_handler(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(&heapam_methods);
+}
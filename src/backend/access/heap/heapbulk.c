@@ -0,0 +1,309 @@
+/*-------------------------------------------------------------------------
+ *
+ * heapbulk.c
+ *	  Bulk loading of tuples into a heap with new storage
+ *
+ * When a heap's relfilenode was created in the current transaction, as for
+ * CREATE TABLE AS, REFRESH MATERIALIZED VIEW, or COPY into a table created
+ * or truncated in the same transaction, nobody else can be inserting into
+ * it.  We can then build its new pages in local memory, like
+ * rewriteheap.c does for CLUSTER, instead of going through shared buffers
+ * and taking a buffer lock for every page.  Finished pages are collected
+ * into batches, which are WAL-logged as full-page images in a few large
+ * WAL records and then appended to the relation with smgrextend().  This
+ * saves lock and WAL traffic, and keeps a big load from pushing everything
+ * else out of shared_buffers.
+ *
+ * INTERFACE
+ *
+ * The caller must check heap_can_bulk_write() first, and must make sure
+ * that nothing else inserts into the relation between
+ * begin_heap_bulk_write() and end_heap_bulk_write(), including through
+ * triggers or functions it runs.  Also, the tuples are not on disk until
+ * they have been written out, so the caller must not look them up by TID
+ * in the meantime; in particular, it can't insert them into indexes.
+ *
+ * To use the facility:
+ *
+ * begin_heap_bulk_write
+ * while (there are tuples)
+ *	   heap_bulk_write_tuples
+ * end_heap_bulk_write
+ *
+ * heap_bulk_write_tuples works like heap_multi_insert, setting t_self of
+ * each tuple to its TID.  If the options include HEAP_INSERT_SKIP_WAL, the
+ * caller must heap_sync() the relation afterwards, as usual.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/heap/heapbulk.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "miscadmin.h"
+
+#include "access/heapam.h"
+#include "access/heapbulk.h"
+#include "access/htup_details.h"
+#include "access/tableam.h"
+#include "access/xact.h"
+#include "access/xloginsert.h"
+#include "catalog/catalog.h"
+#include "pgstat.h"
+#include "storage/bufmgr.h"
+#include "storage/predicate.h"
+#include "storage/smgr.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+/*
+ * Number of pages to collect before writing them out.  The full-page images
+ * are logged XLR_MAX_BLOCK_ID pages to a record.
+ */
+#define HEAP_BULK_WRITE_PAGES	128
+
+/*
+ * State associated with a bulk write operation.  This is opaque to the
+ * caller.
+ */
+typedef struct HeapBulkWriteStateData
+{
+	Relation	hb_rel;			/* target heap */
+	CommandId	hb_cid;			/* command ID to insert with */
+	int			hb_options;		/* heap_insert options */
+	bool		hb_use_wal;		/* must we WAL-log the new pages? */
+	bool		hb_wrote_pages; /* have we written any pages yet? */
+	Size		hb_save_free_space; /* space to leave free per fillfactor */
+	BlockNumber hb_blockno;		/* block number of hb_pages[0] */
+	int			hb_npages;		/* # of pages in use; the last one is the
+								 * one being filled */
+	BlockNumber hb_blknos[HEAP_BULK_WRITE_PAGES];	/* for log_newpages */
+	Page		hb_pages[HEAP_BULK_WRITE_PAGES];	/* pages being built */
+	MemoryContext hb_cxt;		/* for the state and the pages */
+} HeapBulkWriteStateData;
+
+static void heap_bulk_write_flush(HeapBulkWriteState state);
+
+
+/*
+ * Can the relation be loaded with the bulk write facility?
+ *
+ * Its storage must have been created in the current transaction, so that no
+ * other backend can insert into it, and a rollback throws it away.  Also, as
+ * logical decoding can't decode full-page images, the relation mustn't need
+ * its inserts logged for that.  And of course it must be a heap.
+ */
+bool
+heap_can_bulk_write(Relation rel)
+{
+	if (rel->rd_createSubid == InvalidSubTransactionId &&
+		rel->rd_newRelfilenodeSubid == InvalidSubTransactionId)
+		return false;
+
+	if (IsCatalogRelation(rel) || RelationIsLogicallyLogged(rel))
+		return false;
+
+	/* the pages are built in the heap's format */
+	if (rel->rd_tableam != GetHeapamTableAmRoutine())
+		return false;
+
+	return true;
+}
+
+/*
+ * Begin a bulk write into the given heap.
+ *
+ * cid and options are as for heap_insert.
+ */
+HeapBulkWriteState
+begin_heap_bulk_write(Relation rel, CommandId cid, int options)
+{
+	HeapBulkWriteState state;
+	MemoryContext hb_cxt;
+	MemoryContext old_cxt;
+	int			i;
+
+	Assert(heap_can_bulk_write(rel));
+
+	hb_cxt = AllocSetContextCreate(CurrentMemoryContext,
+								   "Heap bulk write",
+								   ALLOCSET_DEFAULT_SIZES);
+	old_cxt = MemoryContextSwitchTo(hb_cxt);
+
+	state = palloc0(sizeof(HeapBulkWriteStateData));
+	state->hb_rel = rel;
+	state->hb_cid = cid;
+	state->hb_options = options;
+	state->hb_use_wal = !(options & HEAP_INSERT_SKIP_WAL) &&
+		RelationNeedsWAL(rel);
+	state->hb_save_free_space =
+		RelationGetTargetPageFreeSpace(rel, HEAP_DEFAULT_FILLFACTOR);
+	state->hb_blockno = RelationGetNumberOfBlocks(rel);
+	state->hb_npages = 0;
+	for (i = 0; i < HEAP_BULK_WRITE_PAGES; i++)
+		state->hb_pages[i] = (Page) palloc(BLCKSZ);
+	state->hb_cxt = hb_cxt;
+
+	MemoryContextSwitchTo(old_cxt);
+
+	return state;
+}
+
+/*
+ * Insert tuples into the heap.  This has to track heap_multi_insert!
+ *
+ * t_self of each tuple is set to its new TID.
+ */
+void
+heap_bulk_write_tuples(HeapBulkWriteState state, HeapTuple *tuples,
+					   int ntuples)
+{
+	Relation	rel = state->hb_rel;
+	TransactionId xid = GetCurrentTransactionId();
+	int			i;
+
+	/* See the comments in heap_multi_insert */
+	CheckForSerializableConflictIn(rel, NULL, InvalidBuffer);
+
+	for (i = 0; i < ntuples; i++)
+	{
+		HeapTuple	heaptup;
+		Page		page;
+		Size		len;
+		OffsetNumber offnum;
+		HeapTupleHeader item;
+
+		heaptup = heap_prepare_insert(rel, tuples[i], xid, state->hb_cid,
+									  state->hb_options);
+
+		len = MAXALIGN(heaptup->t_len); /* be conservative */
+
+		/*
+		 * If we're gonna fail for oversize tuple, do it right away
+		 */
+		if (len > MaxHeapTupleSize)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+					 errmsg("row is too big: size %zu, maximum size %zu",
+							len, MaxHeapTupleSize)));
+
+		/*
+		 * Start a new page if the current one doesn't have room to spare.
+		 * Any tuple fits on an empty page, whatever the fillfactor.
+		 */
+		page = (state->hb_npages > 0) ?
+			state->hb_pages[state->hb_npages - 1] : NULL;
+		if (page == NULL ||
+			(!PageIsEmpty(page) &&
+			 len + state->hb_save_free_space > PageGetHeapFreeSpace(page)))
+		{
+			if (state->hb_npages == HEAP_BULK_WRITE_PAGES)
+				heap_bulk_write_flush(state);
+			page = state->hb_pages[state->hb_npages++];
+			PageInit(page, BLCKSZ, 0);
+		}
+
+		offnum = PageAddItem(page, (Item) heaptup->t_data, heaptup->t_len,
+							 InvalidOffsetNumber, false, true);
+		if (offnum == InvalidOffsetNumber)
+			elog(ERROR, "failed to add tuple to page");
+
+		/* Update t_self to the actual position where it was stored */
+		ItemPointerSet(&(heaptup->t_self),
+					   state->hb_blockno + state->hb_npages - 1, offnum);
+
+		/* Insert the correct position into CTID of the stored tuple, too */
+		item = (HeapTupleHeader) PageGetItem(page, PageGetItemId(page, offnum));
+		item->t_ctid = heaptup->t_self;
+
+		/* Copy t_self back to the caller's tuple, and free any toasted copy */
+		if (heaptup != tuples[i])
+		{
+			tuples[i]->t_self = heaptup->t_self;
+			heap_freetuple(heaptup);
+		}
+	}
+
+	pgstat_count_heap_insert(rel, ntuples);
+}
+
+/*
+ * Finish a bulk write, writing out the remaining pages.
+ */
+void
+end_heap_bulk_write(HeapBulkWriteState state)
+{
+	Relation	rel = state->hb_rel;
+
+	heap_bulk_write_flush(state);
+
+	/*
+	 * Must fsync before commit, unless the caller skipped WAL and syncs the
+	 * whole heap itself.  This is needed even if we WAL-logged the pages:
+	 * we're writing data that's not in shared buffers, so a checkpoint
+	 * occurring meanwhile won't have fsync'd the pages written before it,
+	 * even though it moves the redo pointer past the WAL records for them.
+	 * Temporary relations don't need to survive a crash anyway.
+	 */
+	if (state->hb_wrote_pages &&
+		!(state->hb_options & HEAP_INSERT_SKIP_WAL) &&
+		!RelationUsesLocalBuffers(rel))
+	{
+		RelationOpenSmgr(rel);
+		smgrimmedsync(rel->rd_smgr, MAIN_FORKNUM);
+	}
+
+	MemoryContextDelete(state->hb_cxt);
+}
+
+/*
+ * Write out all the pages built so far, and start over with an empty set.
+ */
+static void
+heap_bulk_write_flush(HeapBulkWriteState state)
+{
+	Relation	rel = state->hb_rel;
+	int			i;
+
+	if (state->hb_npages == 0)
+		return;
+
+	/* the relcache might have closed the smgr relation since last time */
+	RelationOpenSmgr(rel);
+
+	/*
+	 * The pages are appended to the relation, so it must not have been
+	 * extended behind our back.
+	 */
+	if (smgrnblocks(rel->rd_smgr, MAIN_FORKNUM) != state->hb_blockno)
+		elog(ERROR, "relation \"%s\" was extended during bulk write",
+			 RelationGetRelationName(rel));
+
+	for (i = 0; i < state->hb_npages; i++)
+		state->hb_blknos[i] = state->hb_blockno + i;
+
+	/* XLOG stuff */
+	if (state->hb_use_wal)
+		log_newpages(&rel->rd_node, MAIN_FORKNUM, state->hb_npages,
+					 state->hb_blknos, state->hb_pages, true);
+
+	/*
+	 * Now write the pages.  We say skipFsync = true, because there's no need
+	 * for smgr to schedule an fsync for these writes; we'll do it ourselves
+	 * in end_heap_bulk_write, or the caller will.
+	 */
+	for (i = 0; i < state->hb_npages; i++)
+	{
+		PageSetChecksumInplace(state->hb_pages[i], state->hb_blknos[i]);
+		smgrextend(rel->rd_smgr, MAIN_FORKNUM, state->hb_blknos[i],
+				   (char *) state->hb_pages[i], true);
+	}
+
+	state->hb_blockno += state->hb_npages;
+	state->hb_npages = 0;
+	state->hb_wrote_pages = true;
+}
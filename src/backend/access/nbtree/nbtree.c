@@ -35,22 +35,6 @@
 #include "utils/memutils.h"
 
 
-/* Working state for btbuild and its callback */
-typedef struct
-{
-	bool		isUnique;
-	bool		haveDead;
-	Relation	heapRel;
-	BTSpool    *spool;
-
-	/*
-	 * spool2 is needed only when the index is a unique index. Dead tuples are
-	 * put into spool2 instead of spool in order to avoid uniqueness check.
-	 */
-	BTSpool    *spool2;
-	double		indtuples;
-} BTBuildState;
-
 /* Working state needed by btvacuumpage */
 typedef struct
 {
@@ -104,12 +88,6 @@ typedef struct BTParallelScanDescData
 typedef struct BTParallelScanDescData *BTParallelScanDesc;
 
 
-static void btbuildCallback(Relation index,
-				HeapTuple htup,
-				Datum *values,
-				bool *isnull,
-				bool tupleIsAlive,
-				void *state);
 static void btvacuumscan(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
 			 IndexBulkDeleteCallback callback, void *callback_state,
 			 BTCycleId cycleid);
@@ -166,115 +144,6 @@ bthandler(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(amroutine);
 }
 
-/*
- *	btbuild() -- build a new btree index.
- */
-IndexBuildResult *
-btbuild(Relation heap, Relation index, IndexInfo *indexInfo)
-{
-	IndexBuildResult *result;
-	double		reltuples;
-	BTBuildState buildstate;
-
-	buildstate.isUnique = indexInfo->ii_Unique;
-	buildstate.haveDead = false;
-	buildstate.heapRel = heap;
-	buildstate.spool = NULL;
-	buildstate.spool2 = NULL;
-	buildstate.indtuples = 0;
-
-#ifdef BTREE_BUILD_STATS
-	if (log_btree_build_stats)
-		ResetUsage();
-#endif							/* BTREE_BUILD_STATS */
-
-	/*
-	 * We expect to be called exactly once for any index relation. If that's
-	 * not the case, big trouble's what we have.
-	 */
-	if (RelationGetNumberOfBlocks(index) != 0)
-		elog(ERROR, "index \"%s\" already contains data",
-			 RelationGetRelationName(index));
-
-	buildstate.spool = _bt_spoolinit(heap, index, indexInfo->ii_Unique, false);
-
-	/*
-	 * If building a unique index, put dead tuples in a second spool to keep
-	 * them out of the uniqueness check.
-	 */
-	if (indexInfo->ii_Unique)
-		buildstate.spool2 = _bt_spoolinit(heap, index, false, true);
-
-	/* do the heap scan */
-	reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
-								   btbuildCallback, (void *) &buildstate);
-
-	/* okay, all heap tuples are indexed */
-	if (buildstate.spool2 && !buildstate.haveDead)
-	{
-		/* spool2 turns out to be unnecessary */
-		_bt_spooldestroy(buildstate.spool2);
-		buildstate.spool2 = NULL;
-	}
-
-	/*
-	 * Finish the build by (1) completing the sort of the spool file, (2)
-	 * inserting the sorted tuples into btree pages and (3) building the upper
-	 * levels.
-	 */
-	_bt_leafbuild(buildstate.spool, buildstate.spool2);
-	_bt_spooldestroy(buildstate.spool);
-	if (buildstate.spool2)
-		_bt_spooldestroy(buildstate.spool2);
-
-#ifdef BTREE_BUILD_STATS
-	if (log_btree_build_stats)
-	{
-		ShowUsage("BTREE BUILD STATS");
-		ResetUsage();
-	}
-#endif							/* BTREE_BUILD_STATS */
-
-	/*
-	 * Return statistics
-	 */
-	result = (IndexBuildResult *) palloc(sizeof(IndexBuildResult));
-
-	result->heap_tuples = reltuples;
-	result->index_tuples = buildstate.indtuples;
-
-	return result;
-}
-
-/*
- * Per-tuple callback from IndexBuildHeapScan
- */
-static void
-btbuildCallback(Relation index,
-				HeapTuple htup,
-				Datum *values,
-				bool *isnull,
-				bool tupleIsAlive,
-				void *state)
-{
-	BTBuildState *buildstate = (BTBuildState *) state;
-
-	/*
-	 * insert the index tuple into the appropriate spool file for subsequent
-	 * processing
-	 */
-	if (tupleIsAlive || buildstate->spool2 == NULL)
-		_bt_spool(buildstate->spool, &htup->t_self, values, isnull);
-	else
-	{
-		/* dead tuples are put into spool2 */
-		buildstate->haveDead = true;
-		_bt_spool(buildstate->spool2, &htup->t_self, values, isnull);
-	}
-
-	buildstate->indtuples += 1;
-}
-
 /*
  *	btbuildempty() -- build an empty btree index in the initialization fork
  */
@@ -360,7 +229,18 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 		_bt_start_array_keys(scan, dir);
 	}
 
-	/* This loop handles advancing to the next array elements, if any */
+	/* Likewise, a skip scan has to find its first leading-column value */
+	if (so->skipState != BTSKIP_NONE && !BTScanPosIsValid(so->currPos))
+	{
+		/* punt if the index is empty */
+		if (!_bt_start_skip_scan(scan, dir))
+			return false;
+	}
+
+	/*
+	 * This loop handles advancing to the next array elements, or the next
+	 * leading-column value of a skip scan, if any
+	 */
 	do
 	{
 		/*
@@ -403,7 +283,8 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 		if (res)
 			break;
 		/* ... otherwise see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, dir));
+	} while ((so->numArrayKeys && _bt_advance_array_keys(scan, dir)) ||
+			 (so->skipState != BTSKIP_NONE && _bt_skip_advance(scan, dir)));
 
 	return res;
 }
@@ -430,7 +311,18 @@ btgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 		_bt_start_array_keys(scan, ForwardScanDirection);
 	}
 
-	/* This loop handles advancing to the next array elements, if any */
+	/* Likewise, find the first leading-column value of a skip scan */
+	if (so->skipState != BTSKIP_NONE)
+	{
+		/* punt if the index is empty */
+		if (!_bt_start_skip_scan(scan, ForwardScanDirection))
+			return ntids;
+	}
+
+	/*
+	 * This loop handles advancing to the next array elements, or the next
+	 * leading-column value of a skip scan, if any
+	 */
 	do
 	{
 		/* Fetch the first page & tuple */
@@ -461,7 +353,10 @@ btgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 			}
 		}
 		/* Now see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, ForwardScanDirection));
+	} while ((so->numArrayKeys &&
+			  _bt_advance_array_keys(scan, ForwardScanDirection)) ||
+			 (so->skipState != BTSKIP_NONE &&
+			  _bt_skip_advance(scan, ForwardScanDirection)));
 
 	return ntids;
 }
@@ -485,8 +380,9 @@ btbeginscan(Relation rel, int nkeys, int norderbys)
 	so = (BTScanOpaque) palloc(sizeof(BTScanOpaqueData));
 	BTScanPosInvalidate(so->currPos);
 	BTScanPosInvalidate(so->markPos);
+	/* leave room for the extra key of a skip scan */
 	if (scan->numberOfKeys > 0)
-		so->keyData = (ScanKey) palloc(scan->numberOfKeys * sizeof(ScanKeyData));
+		so->keyData = (ScanKey) palloc((scan->numberOfKeys + 1) * sizeof(ScanKeyData));
 	else
 		so->keyData = NULL;
 
@@ -495,6 +391,17 @@ btbeginscan(Relation rel, int nkeys, int norderbys)
 	so->arrayKeys = NULL;
 	so->arrayContext = NULL;
 
+	so->skipState = BTSKIP_NONE;	/* nor a skip scan */
+	so->skipKeyData = NULL;
+	so->skipPrefix = (Datum) 0;
+	so->skipPrefixIsNull = true;
+	so->skipPrefixPage = InvalidBlockNumber;
+	so->skipNearCount = 0;
+	so->markSkipState = BTSKIP_NONE;
+	so->markSkipPrefix = (Datum) 0;
+	so->markSkipPrefixIsNull = true;
+	so->skipContext = NULL;
+
 	so->killedItems = NULL;		/* until needed */
 	so->numKilled = 0;
 
@@ -570,6 +477,9 @@ btrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 
 	/* If any keys are SK_SEARCHARRAY type, set up array-key info */
 	_bt_preprocess_array_keys(scan);
+
+	/* See if we should skip through the values of the first column */
+	_bt_preprocess_skip_scan(scan);
 }
 
 /*
@@ -600,6 +510,9 @@ btendscan(IndexScanDesc scan)
 	/* so->arrayKeyData and so->arrayKeys are in arrayContext */
 	if (so->arrayContext != NULL)
 		MemoryContextDelete(so->arrayContext);
+	/* so->skipKeyData and the prefix values are in skipContext */
+	if (so->skipContext != NULL)
+		MemoryContextDelete(so->skipContext);
 	if (so->killedItems != NULL)
 		pfree(so->killedItems);
 	if (so->currTuples != NULL)
@@ -636,6 +549,10 @@ btmarkpos(IndexScanDesc scan)
 	/* Also record the current positions of any array keys */
 	if (so->numArrayKeys)
 		_bt_mark_array_keys(scan);
+
+	/* ... or the leading-column value of a skip scan */
+	if (so->skipState != BTSKIP_NONE)
+		_bt_mark_skip_scan(scan);
 }
 
 /*
@@ -650,6 +567,10 @@ btrestrpos(IndexScanDesc scan)
 	if (so->numArrayKeys)
 		_bt_restore_array_keys(scan);
 
+	/* ... or the marked leading-column value of a skip scan */
+	if (so->skipState != BTSKIP_NONE)
+		_bt_restore_skip_scan(scan);
+
 	if (so->markItemIndex >= 0)
 	{
 		/*
@@ -34,6 +34,10 @@ static bool _bt_readnextpage(IndexScanDesc scan, BlockNumber blkno, ScanDirectio
 static bool _bt_parallel_readpage(IndexScanDesc scan, BlockNumber blkno,
 					  ScanDirection dir);
 static Buffer _bt_walk_left(Relation rel, Buffer buf, Snapshot snapshot);
+static Buffer _bt_skip_find_prefix(IndexScanDesc scan, ScanDirection dir,
+					 bool first, OffsetNumber *offnum);
+static void _bt_skip_set_prefix_from(IndexScanDesc scan, BTSkipState state,
+						 Buffer buf, OffsetNumber offnum);
 static bool _bt_endpoint(IndexScanDesc scan, ScanDirection dir);
 static void _bt_drop_lock_and_maybe_pin(IndexScanDesc scan, BTScanPos sp);
 static inline void _bt_initialize_more_data(BTScanOpaque so, ScanDirection dir);
@@ -546,6 +550,7 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 	ScanKey		startKeys[INDEX_MAX_KEYS];
 	ScanKeyData scankeys[INDEX_MAX_KEYS];
 	ScanKeyData notnullkeys[INDEX_MAX_KEYS];
+	ScanKeyData skipkey;
 	int			keysCount = 0;
 	int			i;
 	bool		status = true;
@@ -767,6 +772,29 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 		}
 	}
 
+	/*
+	 * A skip scan that has given up skipping has no keys on the first index
+	 * column, but still starts at the entries for the first-column value it
+	 * would have skipped to next, and scans on from there.  The preceding
+	 * entries have been dealt with already.
+	 */
+	if (so->skipState == BTSKIP_RANGE)
+	{
+		Assert(keysCount == 0);
+		ScanKeyEntryInitialize(&skipkey,
+							   ((rel->rd_indoption[0] << SK_BT_INDOPTION_SHIFT) |
+								(so->skipPrefixIsNull ? SK_ISNULL : 0)),
+							   1,
+							   InvalidStrategy,
+							   InvalidOid,
+							   rel->rd_indcollation[0],
+							   InvalidOid,
+							   so->skipPrefix);
+		startKeys[keysCount++] = &skipkey;
+		strat_total = ScanDirectionIsForward(dir) ?
+			BTGreaterEqualStrategyNumber : BTLessEqualStrategyNumber;
+	}
+
 	/*
 	 * If we found no usable boundary keys, we have to start from one end of
 	 * the tree.  Walk down that edge to the first or last key, and scan from
@@ -1752,6 +1780,228 @@ _bt_walk_left(Relation rel, Buffer buf, Snapshot snapshot)
 	return InvalidBuffer;
 }
 
+/*
+ * Number of consecutive skips to a first-column value on the same leaf page
+ * after which a skip scan stops skipping.
+ */
+#define BT_SKIP_MAX_NEAR	8
+
+/*
+ * _bt_start_skip_scan() -- Find the first leading-column value of a skip scan
+ *
+ * This is the value of the first index entry in the given direction.
+ * Returns false if the index is empty.
+ */
+bool
+_bt_start_skip_scan(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Buffer		buf;
+	OffsetNumber offnum;
+
+	Assert(so->skipState != BTSKIP_NONE);
+
+	/*
+	 * We don't visit the index pages we skip over, so a predicate lock on
+	 * the pages we do read wouldn't cover insertions into the gaps.  Lock
+	 * the whole relation instead.
+	 */
+	PredicateLockRelation(scan->indexRelation, scan->xs_snapshot);
+
+	so->skipNearCount = 0;
+
+	buf = _bt_skip_find_prefix(scan, dir, true, &offnum);
+	if (!BufferIsValid(buf))
+		return false;
+
+	_bt_skip_set_prefix_from(scan, BTSKIP_PREFIX, buf, offnum);
+	_bt_relbuf(scan->indexRelation, buf);
+
+	return true;
+}
+
+/*
+ * _bt_skip_advance() -- Advance a skip scan to its next leading-column value
+ *
+ * Called when the primitive index scan for the current value of the first
+ * index column has run out of matches in the given direction.  We find the
+ * value of the next index entry after all those with the current value, by
+ * descending the tree again, and set up the scan keys for it.  Returns false
+ * if there is no such value.
+ *
+ * Skipping only pays off when the entries for each value span several leaf
+ * pages.  If we keep finding the next value on the page where we found the
+ * current one, we give up on skipping and scan the rest of the index in
+ * full, starting at the next value.
+ */
+bool
+_bt_skip_advance(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Buffer		buf;
+	OffsetNumber offnum;
+	BTSkipState state;
+
+	/* A scan that has stopped skipping has covered everything already */
+	if (so->skipState != BTSKIP_PREFIX)
+		return false;
+
+	buf = _bt_skip_find_prefix(scan, dir, false, &offnum);
+	if (!BufferIsValid(buf))
+		return false;
+
+	if (BufferGetBlockNumber(buf) == so->skipPrefixPage)
+		so->skipNearCount++;
+	else
+		so->skipNearCount = 0;
+
+	if (so->skipNearCount >= BT_SKIP_MAX_NEAR)
+		state = BTSKIP_RANGE;
+	else
+		state = BTSKIP_PREFIX;
+
+	_bt_skip_set_prefix_from(scan, state, buf, offnum);
+	_bt_relbuf(scan->indexRelation, buf);
+
+	return true;
+}
+
+/*
+ * _bt_skip_find_prefix() -- Find the entry a skip scan continues with
+ *
+ * If first is true, this is the first entry of the index in the given
+ * direction; otherwise it is the first entry after all those whose first
+ * column equals the scan's current value.  Returns the leaf page holding
+ * the entry, pinned and read-locked, and sets *offnum to its offset; or
+ * InvalidBuffer if there is no such entry.
+ *
+ * The entry needn't be live.  At worst, its first-column value leads to a
+ * primitive index scan that finds nothing.
+ */
+static Buffer
+_bt_skip_find_prefix(IndexScanDesc scan, ScanDirection dir, bool first,
+					 OffsetNumber *offnum)
+{
+	Relation	rel = scan->indexRelation;
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Buffer		buf;
+	Page		page;
+	BTPageOpaque opaque;
+	OffsetNumber off;
+
+	if (first)
+	{
+		buf = _bt_get_endpoint(rel, 0, ScanDirectionIsBackward(dir),
+							   scan->xs_snapshot);
+		if (!BufferIsValid(buf))
+			return InvalidBuffer;
+		page = BufferGetPage(buf);
+		opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+		if (ScanDirectionIsForward(dir))
+			off = P_FIRSTDATAKEY(opaque);
+		else
+			off = PageGetMaxOffsetNumber(page);
+	}
+	else
+	{
+		ScanKeyData skey;
+		BTStack		stack;
+		bool		nextkey;
+
+		/* Build an insertion scankey for the current first-column value */
+		ScanKeyEntryInitializeWithInfo(&skey,
+									   ((rel->rd_indoption[0] << SK_BT_INDOPTION_SHIFT) |
+										(so->skipPrefixIsNull ? SK_ISNULL : 0)),
+									   1,
+									   InvalidStrategy,
+									   InvalidOid,
+									   rel->rd_indcollation[0],
+									   index_getprocinfo(rel, 1, BTORDER_PROC),
+									   so->skipPrefix);
+
+		/*
+		 * For a forward scan, find the first entry > the value.  For a
+		 * backward scan, find the first entry >= the value, and then back up
+		 * one to arrive at the last entry < the value.
+		 */
+		nextkey = ScanDirectionIsForward(dir);
+		stack = _bt_search(rel, 1, &skey, nextkey, &buf, BT_READ,
+						   scan->xs_snapshot);
+		_bt_freestack(stack);
+		if (!BufferIsValid(buf))
+			return InvalidBuffer;
+
+		off = _bt_binsrch(rel, buf, 1, &skey, nextkey);
+		if (ScanDirectionIsBackward(dir))
+			off = OffsetNumberPrev(off);
+		page = BufferGetPage(buf);
+		opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+	}
+
+	/*
+	 * If that took us off the end of the page, move on to the first or last
+	 * entry of the adjacent non-empty page, stepping over dead pages as
+	 * _bt_readnextpage does.
+	 */
+	for (;;)
+	{
+		if (!P_IGNORE(opaque) &&
+			off >= P_FIRSTDATAKEY(opaque) &&
+			off <= PageGetMaxOffsetNumber(page))
+			break;
+
+		if (ScanDirectionIsForward(dir))
+		{
+			if (P_RIGHTMOST(opaque))
+			{
+				_bt_relbuf(rel, buf);
+				return InvalidBuffer;
+			}
+			buf = _bt_relandgetbuf(rel, buf, opaque->btpo_next, BT_READ);
+			page = BufferGetPage(buf);
+			TestForOldSnapshot(scan->xs_snapshot, rel, page);
+			opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+			off = P_FIRSTDATAKEY(opaque);
+		}
+		else
+		{
+			buf = _bt_walk_left(rel, buf, scan->xs_snapshot);
+			if (!BufferIsValid(buf))
+				return InvalidBuffer;
+			page = BufferGetPage(buf);
+			opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+			off = PageGetMaxOffsetNumber(page);
+		}
+	}
+
+	*offnum = off;
+	return buf;
+}
+
+/*
+ * _bt_skip_set_prefix_from() -- Make the first-column value of an index
+ *		entry the current value of a skip scan
+ *
+ * buf must be pinned and read-locked; it stays that way.
+ */
+static void
+_bt_skip_set_prefix_from(IndexScanDesc scan, BTSkipState state,
+						 Buffer buf, OffsetNumber offnum)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Page		page = BufferGetPage(buf);
+	IndexTuple	itup;
+	Datum		prefix;
+	bool		isnull;
+
+	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
+	prefix = index_getattr(itup, 1, RelationGetDescr(scan->indexRelation),
+						   &isnull);
+
+	_bt_set_skip_prefix(scan, state, prefix, isnull);
+	so->skipPrefixPage = BufferGetBlockNumber(buf);
+}
+
 /*
  * _bt_get_endpoint() -- Find the first or last page on a given tree level
  *
@@ -22,6 +22,7 @@
 #include "access/relscan.h"
 #include "miscadmin.h"
 #include "utils/array.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
@@ -657,13 +658,206 @@ _bt_restore_array_keys(IndexScanDesc scan)
 }
 
 
+/*
+ * _bt_preprocess_skip_scan() -- Decide whether to do a skip scan
+ *
+ * Without any scan keys on the first index column, keys on the later columns
+ * can't limit the range of the scan: _bt_first has to start at one end of the
+ * index, and _bt_checkkeys can never stop the scan early.  But if there are
+ * keys on the second column, we can instead scan the entries for each
+ * distinct value of the first column in turn, as if there were an "=" key
+ * for that value.  That makes the keys on the second column usable for
+ * positioning and stopping each of those primitive scans.  When the first
+ * column has few distinct values, this reads much less of the index.
+ *
+ * Array keys already drive a series of primitive index scans of their own, so
+ * we don't try to combine the two.  Nor do we skip in parallel scans.
+ */
+void
+_bt_preprocess_skip_scan(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	int			numberOfKeys = scan->numberOfKeys;
+	int			i;
+
+	so->skipState = BTSKIP_NONE;
+	so->markSkipState = BTSKIP_NONE;
+
+	if (numberOfKeys < 1 ||
+		RelationGetNumberOfAttributes(rel) < 2 ||
+		so->numArrayKeys != 0 ||
+		scan->parallel_scan != NULL)
+		return;
+
+	/* Keys are ordered by attribute, so this also checks the first column */
+	if (scan->keyData[0].sk_attno != 2)
+		return;
+
+	/* Don't bother if some key can never be satisfied */
+	for (i = 0; i < numberOfKeys; i++)
+	{
+		ScanKey		cur = &scan->keyData[i];
+
+		if ((cur->sk_flags & SK_ISNULL) &&
+			!(cur->sk_flags & (SK_SEARCHNULL | SK_SEARCHNOTNULL)))
+			return;
+	}
+
+	/*
+	 * Set up the equality function for the first column's key, if we didn't
+	 * already in a previous rescan cycle.
+	 */
+	if (so->skipContext == NULL)
+	{
+		Oid			eq_op;
+
+		eq_op = get_opfamily_member(rel->rd_opfamily[0],
+									rel->rd_opcintype[0],
+									rel->rd_opcintype[0],
+									BTEqualStrategyNumber);
+		if (!OidIsValid(eq_op))
+			return;
+
+		so->skipContext = AllocSetContextCreate(CurrentMemoryContext,
+												"BTree skip scan context",
+												ALLOCSET_SMALL_SIZES);
+		fmgr_info_cxt(get_opcode(eq_op), &so->skipEqProc, so->skipContext);
+		so->skipKeyData = (ScanKey)
+			MemoryContextAlloc(so->skipContext,
+							   (numberOfKeys + 1) * sizeof(ScanKeyData));
+	}
+
+	/* The first column's key goes in front of a copy of the scan keys */
+	memcpy(so->skipKeyData + 1,
+		   scan->keyData,
+		   numberOfKeys * sizeof(ScanKeyData));
+
+	so->skipState = BTSKIP_PREFIX;
+}
+
+/*
+ * Replace a skip scan's copy of a first-column value with a copy of another.
+ */
+static void
+_bt_copy_skip_prefix(IndexScanDesc scan, Datum *dest, bool *destIsNull,
+					 Datum value, bool isnull)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Form_pg_attribute attr = RelationGetDescr(scan->indexRelation)->attrs[0];
+	MemoryContext oldContext;
+
+	if (!attr->attbyval && !*destIsNull)
+		pfree(DatumGetPointer(*dest));
+
+	*destIsNull = isnull;
+	if (isnull)
+		*dest = (Datum) 0;
+	else
+	{
+		oldContext = MemoryContextSwitchTo(so->skipContext);
+		*dest = datumCopy(value, attr->attbyval, attr->attlen);
+		MemoryContextSwitchTo(oldContext);
+	}
+}
+
+/*
+ * _bt_set_skip_prefix() -- Move a skip scan to a new first-column value
+ *
+ * In state BTSKIP_PREFIX, the next primitive index scan covers just the
+ * entries with the given value, which may be NULL.  In state BTSKIP_RANGE,
+ * it starts at them and goes on to the end of the index.  The caller must
+ * make sure the scan keys are preprocessed again before they are used.
+ */
+void
+_bt_set_skip_prefix(IndexScanDesc scan, BTSkipState state,
+					Datum prefix, bool isnull)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	ScanKey		skey = &so->skipKeyData[0];
+
+	Assert(so->skipState != BTSKIP_NONE && state != BTSKIP_NONE);
+
+	so->skipState = state;
+	_bt_copy_skip_prefix(scan, &so->skipPrefix, &so->skipPrefixIsNull,
+						 prefix, isnull);
+
+	/* Only a BTSKIP_PREFIX scan uses the key; see _bt_first for the other */
+	if (isnull)
+		ScanKeyEntryInitialize(skey,
+							   SK_ISNULL | SK_SEARCHNULL,
+							   1,
+							   InvalidStrategy,
+							   InvalidOid,
+							   InvalidOid,
+							   InvalidOid,
+							   (Datum) 0);
+	else
+		ScanKeyEntryInitializeWithInfo(skey,
+									   0,
+									   1,
+									   BTEqualStrategyNumber,
+									   InvalidOid,
+									   rel->rd_indcollation[0],
+									   &so->skipEqProc,
+									   so->skipPrefix);
+}
+
+/*
+ * _bt_mark_skip_scan() -- Handle a skip scan during btmarkpos
+ *
+ * Save the current first-column value and state as the "mark" position.
+ */
+void
+_bt_mark_skip_scan(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+
+	so->markSkipState = so->skipState;
+	_bt_copy_skip_prefix(scan, &so->markSkipPrefix, &so->markSkipPrefixIsNull,
+						 so->skipPrefix, so->skipPrefixIsNull);
+}
+
+/*
+ * _bt_restore_skip_scan() -- Handle a skip scan during btrestrpos
+ *
+ * Restore the first-column value and state to what they were when the mark
+ * was set.
+ */
+void
+_bt_restore_skip_scan(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Form_pg_attribute attr = RelationGetDescr(scan->indexRelation)->attrs[0];
+
+	/* Nothing to do if there's no mark, or it's still current */
+	if (so->markSkipState == BTSKIP_NONE)
+		return;
+	if (so->markSkipState == so->skipState &&
+		so->markSkipPrefixIsNull == so->skipPrefixIsNull &&
+		(so->skipPrefixIsNull ||
+		 datumIsEqual(so->markSkipPrefix, so->skipPrefix,
+					  attr->attbyval, attr->attlen)))
+		return;
+
+	_bt_set_skip_prefix(scan, so->markSkipState,
+						so->markSkipPrefix, so->markSkipPrefixIsNull);
+
+	/* As in _bt_restore_array_keys, redo the preprocessing */
+	_bt_preprocess_keys(scan);
+	Assert(so->qual_ok);
+}
+
+
 /*
  *	_bt_preprocess_keys() -- Preprocess scan keys
  *
- * The given search-type keys (in scan->keyData[] or so->arrayKeyData[])
- * are copied to so->keyData[] with possible transformation.
- * scan->numberOfKeys is the number of input keys, so->numberOfKeys gets
- * the number of output keys (possibly less, never greater).
+ * The given search-type keys (in scan->keyData[], so->arrayKeyData[] or
+ * so->skipKeyData[]) are copied to so->keyData[] with possible
+ * transformation.  scan->numberOfKeys is the number of input keys (plus one
+ * for so->skipKeyData[]), so->numberOfKeys gets the number of output keys
+ * (possibly less, never greater).
  *
  * The output keys are marked with additional sk_flag bits beyond the
  * system-standard bits supplied by the caller.  The DESC and NULLS_FIRST
@@ -766,9 +960,16 @@ _bt_preprocess_keys(IndexScanDesc scan)
 		return;					/* done if qual-less scan */
 
 	/*
-	 * Read so->arrayKeyData if array keys are present, else scan->keyData
+	 * Read so->skipKeyData, with its extra first-column key, while a skip
+	 * scan covers a single first-column value; else so->arrayKeyData if array
+	 * keys are present, else scan->keyData
 	 */
-	if (so->arrayKeyData != NULL)
+	if (so->skipState == BTSKIP_PREFIX)
+	{
+		inkeys = so->skipKeyData;
+		numberOfKeys++;
+	}
+	else if (so->arrayKeyData != NULL)
 		inkeys = so->arrayKeyData;
 	else
 		inkeys = scan->keyData;
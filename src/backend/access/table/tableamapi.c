@@ -0,0 +1,94 @@
+/*-------------------------------------------------------------------------
+ *
+ * tableamapi.c
+ *	  Support routines for API for Postgres table access methods.
+ *
+ * Copyright (c) 2017, PostgreSQL Global Development Group
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/table/tableamapi.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/tableam.h"
+#include "catalog/pg_am.h"
+#include "utils/syscache.h"
+
+
+/*
+ * GetTableAmRoutine - call the specified access method handler routine to get
+ * its TableAmRoutine struct.
+ *
+ * Unlike index AM handlers, a table AM handler returns a pointer to a struct
+ * that it keeps for the life of the backend, so the result can be cached
+ * without copying it.
+ */
+const TableAmRoutine *
+GetTableAmRoutine(Oid amhandler)
+{
+	Datum		datum;
+	const TableAmRoutine *routine;
+
+	datum = OidFunctionCall0(amhandler);
+	routine = (const TableAmRoutine *) DatumGetPointer(datum);
+
+	if (routine == NULL || !IsA(routine, TableAmRoutine))
+		elog(ERROR, "table access method handler function %u did not return a TableAmRoutine struct",
+			 amhandler);
+
+	/* All the callbacks are required */
+	if (routine->scan_begin == NULL || routine->scan_rescan == NULL ||
+		routine->scan_end == NULL || routine->scan_getnextslot == NULL ||
+		routine->tuple_fetch_row_version == NULL ||
+		routine->tuple_satisfies_snapshot == NULL ||
+		routine->tuple_insert == NULL || routine->tuple_delete == NULL ||
+		routine->tuple_update == NULL || routine->relation_vacuum == NULL)
+		elog(ERROR, "table access method handler function %u returned an incomplete TableAmRoutine struct",
+			 amhandler);
+
+	return routine;
+}
+
+/*
+ * GetTableAmRoutineByAmId - look up the handler of the table access method
+ * with the given OID, and get its TableAmRoutine struct.
+ */
+const TableAmRoutine *
+GetTableAmRoutineByAmId(Oid amoid)
+{
+	HeapTuple	tuple;
+	Form_pg_am	amform;
+	regproc		amhandler;
+
+	/* Get handler function OID for the access method */
+	tuple = SearchSysCache1(AMOID, ObjectIdGetDatum(amoid));
+	if (!HeapTupleIsValid(tuple))
+		elog(ERROR, "cache lookup failed for access method %u",
+			 amoid);
+	amform = (Form_pg_am) GETSTRUCT(tuple);
+
+	/* Check if it's a table access method as opposed to some other AM */
+	if (amform->amtype != AMTYPE_TABLE)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("access method \"%s\" is not of type %s",
+						NameStr(amform->amname), "TABLE")));
+
+	amhandler = amform->amhandler;
+
+	/* Complain if handler OID is invalid */
+	if (!RegProcedureIsValid(amhandler))
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("table access method \"%s\" does not have a handler",
+						NameStr(amform->amname))));
+
+	ReleaseSysCache(tuple);
+
+	/* And finally, call the handler function to get the API struct. */
+	return GetTableAmRoutine(amhandler);
+}
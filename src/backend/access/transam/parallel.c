@@ -14,11 +14,13 @@
 
 #include "postgres.h"
 
+#include "access/nbtree.h"
 #include "access/parallel.h"
 #include "access/xact.h"
 #include "access/xlog.h"
 #include "catalog/namespace.h"
 #include "commands/async.h"
+#include "commands/copy.h"
 #include "executor/execParallel.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
@@ -36,6 +38,7 @@
 #include "utils/memutils.h"
 #include "utils/resowner.h"
 #include "utils/snapmgr.h"
+#include "utils/typcache.h"
 
 
 /*
@@ -77,6 +80,7 @@ typedef struct FixedParallelState
 	PGPROC	   *parallel_master_pgproc;
 	pid_t		parallel_master_pid;
 	BackendId	parallel_master_backend_id;
+	dsm_handle	record_typmod_registry;
 
 	/* Mutex protects remaining fields. */
 	slock_t		mutex;
@@ -118,6 +122,12 @@ static const struct
 {
 	{
 		"ParallelQueryMain", ParallelQueryMain
+	},
+	{
+		"ParallelCopyMain", ParallelCopyMain
+	},
+	{
+		"_bt_parallel_build_main", _bt_parallel_build_main
 	}
 };
 
@@ -197,6 +207,7 @@ InitializeParallelDSM(ParallelContext *pcxt)
 	Size		segsize = 0;
 	int			i;
 	FixedParallelState *fps;
+	dsm_handle	record_typmod_registry = DSM_HANDLE_INVALID;
 	Snapshot	transaction_snapshot = GetTransactionSnapshot();
 	Snapshot	active_snapshot = GetActiveSnapshot();
 
@@ -253,11 +264,17 @@ InitializeParallelDSM(ParallelContext *pcxt)
 	 * maximum number of segments have already been created, then fall back to
 	 * backend-private memory, and plan not to use any workers.  We hope this
 	 * won't happen very often, but it's better to abandon the use of
-	 * parallelism than to fail outright.
+	 * parallelism than to fail outright.  The same goes for the segment
+	 * holding the shared record type registry, which the workers need so
+	 * that they can exchange tuples with us without translating typmods.
 	 */
 	segsize = shm_toc_estimate(&pcxt->estimator);
 	if (pcxt->nworkers > 0)
-		pcxt->seg = dsm_create(segsize, DSM_CREATE_NULL_IF_MAXSEGMENTS);
+	{
+		record_typmod_registry = GetSharedRecordTypmodRegistry();
+		if (record_typmod_registry != DSM_HANDLE_INVALID)
+			pcxt->seg = dsm_create(segsize, DSM_CREATE_NULL_IF_MAXSEGMENTS);
+	}
 	if (pcxt->seg != NULL)
 		pcxt->toc = shm_toc_create(PARALLEL_MAGIC,
 								   dsm_segment_address(pcxt->seg),
@@ -281,6 +298,7 @@ InitializeParallelDSM(ParallelContext *pcxt)
 	fps->parallel_master_pgproc = MyProc;
 	fps->parallel_master_pid = MyProcPid;
 	fps->parallel_master_backend_id = MyBackendId;
+	fps->record_typmod_registry = record_typmod_registry;
 	SpinLockInit(&fps->mutex);
 	fps->last_xlog_end = 0;
 	shm_toc_insert(pcxt->toc, PARALLEL_KEY_FIXED, fps);
@@ -1089,6 +1107,9 @@ ParallelWorkerMain(Datum main_arg)
 	/* Set ParallelMasterBackendId so we know how to address temp relations. */
 	ParallelMasterBackendId = fps->parallel_master_backend_id;
 
+	/* Share the leader's record typmods. */
+	AttachSharedRecordTypmodRegistry(fps->record_typmod_registry);
+
 	/*
 	 * We've initialized all of our state now; nothing should change
 	 * hereafter.
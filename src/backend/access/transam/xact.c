@@ -691,16 +691,28 @@ GetCurrentCommandId(bool used)
 	{
 		/*
 		 * Forbid setting currentCommandIdUsed in parallel mode, because we
-		 * have no provision for communicating this back to the master.  We
-		 * could relax this restriction when currentCommandIdUsed was already
-		 * true at the start of the parallel operation.
+		 * have no provision for communicating this back to the master.  It's
+		 * OK if it was already true at the start of the parallel operation,
+		 * though, since then there is nothing to communicate.
 		 */
-		Assert(CurrentTransactionState->parallelModeLevel == 0);
+		Assert(CurrentTransactionState->parallelModeLevel == 0 ||
+			   currentCommandIdUsed);
 		currentCommandIdUsed = true;
 	}
 	return currentCommandId;
 }
 
+/*
+ *	IsCurrentCommandIdUsed
+ *
+ * Has the current command ID been used to mark tuples yet?
+ */
+bool
+IsCurrentCommandIdUsed(void)
+{
+	return currentCommandIdUsed;
+}
+
 /*
  *	GetCurrentTransactionStartTimestamp
  */
@@ -4840,8 +4852,9 @@ Size
 EstimateTransactionStateSpace(void)
 {
 	TransactionState s;
-	Size		nxids = 6;		/* iso level, deferrable, top & current XID,
-								 * command counter, XID count */
+	Size		nxids = 7;		/* iso level, deferrable, top & current XID,
+								 * command counter, command counter used flag,
+								 * XID count */
 
 	for (s = CurrentTransactionState; s != NULL; s = s->parent)
 	{
@@ -4861,10 +4874,11 @@ EstimateTransactionStateSpace(void)
  *
  * We need to save and restore XactDeferrable, XactIsoLevel, and the XIDs
  * associated with this transaction.  The first eight bytes of the result
- * contain XactDeferrable and XactIsoLevel; the next twelve bytes contain the
+ * contain XactDeferrable and XactIsoLevel; the next sixteen bytes contain the
  * XID of the top-level transaction, the XID of the current transaction
- * (or, in each case, InvalidTransactionId if none), and the current command
- * counter.  After that, the next 4 bytes contain a count of how many
+ * (or, in each case, InvalidTransactionId if none), the current command
+ * counter, and whether it has been used.  After that, the next 4 bytes
+ * contain a count of how many
  * additional XIDs follow; this is followed by all of those XIDs one after
  * another.  We emit the XIDs in sorted order for the convenience of the
  * receiving process.
@@ -4884,6 +4898,7 @@ SerializeTransactionState(Size maxsize, char *start_address)
 	result[c++] = XactTopTransactionId;
 	result[c++] = CurrentTransactionState->transactionId;
 	result[c++] = (TransactionId) currentCommandId;
+	result[c++] = (TransactionId) currentCommandIdUsed;
 	Assert(maxsize >= c * sizeof(TransactionId));
 
 	/*
@@ -4950,8 +4965,9 @@ StartParallelWorkerTransaction(char *tstatespace)
 	XactTopTransactionId = tstate[2];
 	CurrentTransactionState->transactionId = tstate[3];
 	currentCommandId = tstate[4];
-	nParallelCurrentXids = (int) tstate[5];
-	ParallelCurrentXids = &tstate[6];
+	currentCommandIdUsed = (bool) tstate[5];
+	nParallelCurrentXids = (int) tstate[6];
+	ParallelCurrentXids = &tstate[7];
 
 	CurrentTransactionState->blockState = TBLOCK_PARALLEL_INPROGRESS;
 }
@@ -248,6 +248,7 @@ Boot_CreateStmt:
 													  NIL,
 													  RELKIND_RELATION,
 													  RELPERSISTENCE_PERMANENT,
+													  InvalidOid,
 													  shared_relation,
 													  mapped_relation,
 													  true,
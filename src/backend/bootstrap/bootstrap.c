@@ -351,9 +351,15 @@ AuxiliaryProcessMain(int argc, char *argv[])
 	SetProcessingMode(BootstrapProcessing);
 	IgnoreSystemIndexes = true;
 
-	/* Initialize MaxBackends (if under postmaster, was done already) */
+	/*
+	 * Initialize MaxBackends and the fast-path lock array size (if under
+	 * postmaster, was done already)
+	 */
 	if (!IsUnderPostmaster)
+	{
 		InitializeMaxBackends();
+		InitializeFastPathLocks();
+	}
 
 	BaseInit();
 
@@ -1124,7 +1130,7 @@ build_indices(void)
 		heap = heap_open(ILHead->il_heap, NoLock);
 		ind = index_open(ILHead->il_ind, NoLock);
 
-		index_build(heap, ind, ILHead->il_info, false, false);
+		index_build(heap, ind, ILHead->il_info, false, false, false);
 
 		index_close(ind, NoLock);
 		heap_close(heap, NoLock);
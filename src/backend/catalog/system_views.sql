@@ -253,6 +253,36 @@ CREATE VIEW pg_stats WITH (security_barrier) AS
 
 REVOKE ALL on pg_statistic FROM public;
 
+CREATE VIEW pg_stats_ext WITH (security_barrier) AS
+    SELECT
+        cn.nspname AS schemaname,
+        c.relname AS tablename,
+        sn.nspname AS statistics_schemaname,
+        s.stxname AS statistics_name,
+        pg_get_userbyid(s.stxowner) AS statistics_owner,
+        ARRAY(SELECT a.attname FROM pg_attribute a
+              WHERE a.attrelid = s.stxrelid AND a.attnum = ANY (s.stxkeys)
+              ORDER BY a.attnum) AS attnames,
+        s.stxkind AS kinds,
+        s.stxndistinct AS n_distinct,
+        s.stxdependencies AS dependencies,
+        s.stxmcv AS mcv_list
+    FROM pg_statistic_ext s JOIN pg_class c ON (c.oid = s.stxrelid)
+         LEFT JOIN pg_namespace cn ON (cn.oid = c.relnamespace)
+         LEFT JOIN pg_namespace sn ON (sn.oid = s.stxnamespace)
+    WHERE NOT EXISTS (SELECT 1 FROM pg_attribute a
+                      WHERE a.attrelid = s.stxrelid
+                      AND a.attnum = ANY (s.stxkeys)
+                      AND NOT has_column_privilege(c.oid, a.attnum, 'select'))
+    AND (c.relrowsecurity = false OR NOT row_security_active(c.oid));
+
+-- All columns of pg_statistic_ext except stxmcv are readable; the MCV list
+-- contains actual column values, so it is only exposed through pg_stats_ext.
+REVOKE ALL ON pg_statistic_ext FROM public;
+GRANT SELECT (tableoid, oid, stxrelid, stxname, stxnamespace, stxowner,
+              stxkeys, stxkind, stxndistinct, stxdependencies)
+    ON pg_statistic_ext TO public;
+
 CREATE VIEW pg_publication_tables AS
     SELECT
         P.pubname AS pubname,
@@ -18,6 +18,7 @@
 
 #include "access/multixact.h"
 #include "access/sysattr.h"
+#include "access/tableam.h"
 #include "access/transam.h"
 #include "access/tupconvert.h"
 #include "access/tuptoaster.h"
@@ -209,6 +210,16 @@ analyze_rel(Oid relid, RangeVar *relation, int options,
 	if (onerel->rd_rel->relkind == RELKIND_RELATION ||
 		onerel->rd_rel->relkind == RELKIND_MATVIEW)
 	{
+		/* acquire_sample_rows reads heap pages directly */
+		if (onerel->rd_tableam != GetHeapamTableAmRoutine())
+		{
+			ereport(WARNING,
+					(errmsg("skipping \"%s\" --- cannot analyze tables that do not use the heap table access method",
+							RelationGetRelationName(onerel))));
+			relation_close(onerel, ShareUpdateExclusiveLock);
+			return;
+		}
+
 		/* Regular table, so we'll use the regular row acquisition function */
 		acquirefunc = acquire_sample_rows;
 		/* Also get regular table's size */
@@ -1337,6 +1348,14 @@ acquire_inherited_sample_rows(Relation onerel, int elevel,
 		if (childrel->rd_rel->relkind == RELKIND_RELATION ||
 			childrel->rd_rel->relkind == RELKIND_MATVIEW)
 		{
+			/* We can only sample heaps; ignore others, as for foreign tables */
+			if (childrel->rd_tableam != GetHeapamTableAmRoutine())
+			{
+				Assert(childrel != onerel);
+				heap_close(childrel, AccessShareLock);
+				continue;
+			}
+
 			/* Regular table, so use the regular row acquisition function */
 			acquirefunc = acquire_sample_rows;
 			relpages = RelationGetNumberOfBlocks(childrel);
@@ -20,11 +20,15 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
+#include "access/genam.h"
 #include "access/heapam.h"
+#include "access/heapbulk.h"
 #include "access/htup_details.h"
+#include "access/parallel.h"
 #include "access/sysattr.h"
 #include "access/xact.h"
 #include "access/xlog.h"
+#include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "commands/copy.h"
 #include "commands/defrem.h"
@@ -38,16 +42,23 @@
 #include "optimizer/planner.h"
 #include "nodes/makefuncs.h"
 #include "parser/parse_relation.h"
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "port/simd.h"
+#include "postmaster/bgworker_internals.h"
 #include "rewrite/rewriteHandler.h"
 #include "storage/fd.h"
+#include "storage/shm_mq.h"
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/portal.h"
 #include "utils/rel.h"
 #include "utils/rls.h"
 #include "utils/snapmgr.h"
+#include "utils/typcache.h"
 
 
 #define ISOCTAL(c) (((c) >= '0') && ((c) <= '7'))
@@ -133,6 +144,7 @@ typedef struct CopyStateData
 	bool		convert_selectively;	/* do selective binary conversion? */
 	List	   *convert_select; /* list of column names (can be NIL) */
 	bool	   *convert_select_flags;	/* per-column CSV/TEXT CS flags */
+	int			parallel_workers;	/* # of workers to request for COPY FROM */
 
 	/* these are just for error messages, see CopyFromErrorCallback */
 	const char *cur_relname;	/* table name for error messages */
@@ -165,6 +177,17 @@ typedef struct CopyStateData
 	bool		volatile_defexprs;	/* is any of defexprs volatile? */
 	List	   *range_table;
 
+	/*
+	 * In a parallel COPY worker, lines come from the leader through
+	 * line_queue rather than from the data source; see ParallelCopyMain.
+	 * chunk_data holds the last message received, which consists of any
+	 * number of lines, and chunk_pos is the offset of the next one.
+	 */
+	shm_mq_handle *line_queue;
+	char	   *chunk_data;
+	Size		chunk_len;
+	Size		chunk_pos;
+
 	PartitionDispatch *partition_dispatch_info;
 	int			num_dispatch;	/* Number of entries in the above array */
 	int			num_partitions; /* Number of members in the following arrays */
@@ -202,9 +225,10 @@ typedef struct CopyStateData
 
 	/*
 	 * Finally, raw_buf holds raw data read from the data source (file or
-	 * client connection).  CopyReadLine parses this data sufficiently to
-	 * locate line boundaries, then transfers the data to line_buf and
-	 * converts it.  Note: we guarantee that there is a \0 at
+	 * client connection).  In text mode, CopyReadLine parses this data
+	 * sufficiently to locate line boundaries, then transfers the data to
+	 * line_buf and converts it.  In binary mode, fields are read out of it
+	 * directly.  Note: we guarantee that there is a \0 at
 	 * raw_buf[raw_buf_len].
 	 */
 #define RAW_BUF_SIZE 65536		/* we palloc RAW_BUF_SIZE+1 bytes */
@@ -213,6 +237,9 @@ typedef struct CopyStateData
 	int			raw_buf_len;	/* total # of bytes stored */
 } CopyStateData;
 
+/* Number of unprocessed bytes in raw_buf */
+#define RAW_BUF_BYTES(cstate) ((cstate)->raw_buf_len - (cstate)->raw_buf_index)
+
 /* DestReceiver for COPY (query) TO */
 typedef struct
 {
@@ -221,6 +248,63 @@ typedef struct
 	uint64		processed;		/* # of tuples processed */
 } DR_copy;
 
+/*
+ * Tuples waiting to be inserted into one relation by heap_multi_insert().
+ * CopyFrom keeps one of these for the target table, or, if it's partitioned,
+ * for each of up to MAX_PARTITION_BUFFERS partitions that rows have recently
+ * been routed to.  All of them are flushed together once MAX_BUFFERED_TUPLES
+ * tuples or MAX_BUFFERED_BYTES bytes are buffered in total, so that the
+ * per-tuple memory context holding the tuples can be reset.
+ *
+ * If the target table's storage is new in this transaction and it has no
+ * indexes, the buffer writes its tuples with the heap bulk write facility
+ * instead, which builds whole pages locally.  We can't do that if there are
+ * indexes, because inserting the index entries needs the tuples to be in the
+ * heap already.
+ */
+#define MAX_BUFFERED_TUPLES		1000
+#define MAX_BUFFERED_BYTES		65535
+#define MAX_PARTITION_BUFFERS	32
+
+typedef struct CopyMultiInsertBuffer
+{
+	ResultRelInfo *resultRelInfo;	/* relation to insert into */
+	TupleTableSlot *slot;		/* slot for index inserts */
+	BulkInsertState bistate;	/* bulk insert state for the relation */
+	HeapBulkWriteState bulkwrite;	/* bulk write state, or NULL */
+	int			nused;			/* # of tuples in the buffer */
+	HeapTuple	tuples[MAX_BUFFERED_TUPLES];
+	int			linenos[MAX_BUFFERED_TUPLES];	/* line number of each tuple */
+} CopyMultiInsertBuffer;
+
+/*
+ * Parallel COPY FROM.  The leader sends lines to each worker in messages of
+ * about PARALLEL_COPY_CHUNK_SIZE bytes, through a queue of
+ * PARALLEL_COPY_QUEUE_SIZE bytes per worker.  Each line is sent as its line
+ * number and length (both ints) followed by the line itself.
+ */
+#define PARALLEL_COPY_KEY_SHARED		UINT64CONST(0xC000000000000001)
+#define PARALLEL_COPY_KEY_ARGS			UINT64CONST(0xC000000000000002)
+#define PARALLEL_COPY_KEY_QUEUES		UINT64CONST(0xC000000000000003)
+
+#define PARALLEL_COPY_CHUNK_SIZE		65536
+#define PARALLEL_COPY_QUEUE_SIZE		(4 * PARALLEL_COPY_CHUNK_SIZE)
+
+/* State shared between the leader and the workers of a parallel COPY */
+typedef struct ParallelCopyShared
+{
+	Oid			relid;			/* target table */
+	pg_atomic_uint64 processed; /* # of tuples inserted by all workers */
+} ParallelCopyShared;
+
+/* Leader-side state for the queue to one parallel COPY worker */
+typedef struct ParallelCopyQueue
+{
+	shm_mq_handle *mqh;
+	StringInfoData buf;			/* lines not yet sent */
+	bool		sending;		/* buf is partially sent; can't add to it */
+} ParallelCopyQueue;
+
 
 /*
  * These macros centralize code used to process line_buf and raw_buf buffers.
@@ -304,16 +388,28 @@ static uint64 DoCopyTo(CopyState cstate);
 static uint64 CopyTo(CopyState cstate);
 static void CopyOneRowTo(CopyState cstate, Oid tupleOid,
 			 Datum *values, bool *nulls);
+static bool CopyFromIsParallelSafe(CopyState cstate);
+static uint64 ParallelCopyFrom(CopyState cstate, List *attnamelist,
+				 List *options);
+static int ParallelCopyNextQueue(ParallelCopyQueue *queues, int nqueues,
+					  int start);
+static void ParallelCopySend(ParallelCopyQueue *queue);
+static int	ParallelCopyNoData(void *outbuf, int minread, int maxread);
+static CopyMultiInsertBuffer *CopyMultiInsertBufferInit(ResultRelInfo *resultRelInfo);
+static void CopyMultiInsertBufferFree(CopyMultiInsertBuffer *buffer);
+static void CopyFromFlushBuffers(CopyState cstate, EState *estate,
+					 CommandId mycid, int hi_options,
+					 CopyMultiInsertBuffer **buffers, int nbuffers);
 static void CopyFromInsertBatch(CopyState cstate, EState *estate,
 					CommandId mycid, int hi_options,
-					ResultRelInfo *resultRelInfo, TupleTableSlot *myslot,
-					BulkInsertState bistate,
-					int nBufferedTuples, HeapTuple *bufferedTuples,
-					int firstBufferedLineNo);
+					CopyMultiInsertBuffer *buffer);
 static bool CopyReadLine(CopyState cstate);
+static bool CopyReadParallelLine(CopyState cstate);
 static bool CopyReadLineText(CopyState cstate);
 static int	CopyReadAttributesText(CopyState cstate);
 static int	CopyReadAttributesCSV(CopyState cstate);
+static bool CopyReadBinaryFixed(CopyState cstate, Oid recvfn, int32 fld_size,
+					Datum *result);
 static Datum CopyReadBinaryAttribute(CopyState cstate,
 						int column_no, FmgrInfo *flinfo,
 						Oid typioparam, int32 typmod,
@@ -339,6 +435,7 @@ static void CopySendInt32(CopyState cstate, int32 val);
 static bool CopyGetInt32(CopyState cstate, int32 *val);
 static void CopySendInt16(CopyState cstate, int16 val);
 static bool CopyGetInt16(CopyState cstate, int16 *val);
+static int	CopyReadBinaryData(CopyState cstate, char *dest, int nbytes);
 
 
 /*
@@ -685,7 +782,7 @@ CopyGetInt32(CopyState cstate, int32 *val)
 {
 	uint32		buf;
 
-	if (CopyGetData(cstate, &buf, sizeof(buf), sizeof(buf)) != sizeof(buf))
+	if (CopyReadBinaryData(cstate, (char *) &buf, sizeof(buf)) != sizeof(buf))
 	{
 		*val = 0;				/* suppress compiler warning */
 		return false;
@@ -714,7 +811,7 @@ CopyGetInt16(CopyState cstate, int16 *val)
 {
 	uint16		buf;
 
-	if (CopyGetData(cstate, &buf, sizeof(buf), sizeof(buf)) != sizeof(buf))
+	if (CopyReadBinaryData(cstate, (char *) &buf, sizeof(buf)) != sizeof(buf))
 	{
 		*val = 0;				/* suppress compiler warning */
 		return false;
@@ -759,6 +856,55 @@ CopyLoadRawBuf(CopyState cstate)
 	return (inbytes > 0);
 }
 
+/*
+ * CopyReadBinaryData
+ *
+ * Reads up to 'nbytes' bytes of binary COPY data into 'dest', going through
+ * raw_buf so that the data source is read in RAW_BUF_SIZE chunks rather than
+ * a few bytes at a time.  Returns the number of bytes read, which is less
+ * than 'nbytes' only at EOF.
+ */
+static int
+CopyReadBinaryData(CopyState cstate, char *dest, int nbytes)
+{
+	int			copied = 0;
+
+	if (RAW_BUF_BYTES(cstate) >= nbytes)
+	{
+		/* Enough bytes are present in the buffer. */
+		memcpy(dest, cstate->raw_buf + cstate->raw_buf_index, nbytes);
+		cstate->raw_buf_index += nbytes;
+		copied = nbytes;
+	}
+	else
+	{
+		/*
+		 * Not enough bytes in the buffer, so must read from the source.  Need
+		 * to loop since 'nbytes' could be larger than the buffer size.
+		 */
+		do
+		{
+			int			copy_bytes;
+
+			/* Load more data if buffer is empty. */
+			if (RAW_BUF_BYTES(cstate) == 0)
+			{
+				if (!CopyLoadRawBuf(cstate))
+					break;		/* EOF */
+			}
+
+			/* Transfer some bytes. */
+			copy_bytes = Min(nbytes - copied, RAW_BUF_BYTES(cstate));
+			memcpy(dest, cstate->raw_buf + cstate->raw_buf_index, copy_bytes);
+			cstate->raw_buf_index += copy_bytes;
+			dest += copy_bytes;
+			copied += copy_bytes;
+		} while (copied < nbytes);
+	}
+
+	return copied;
+}
+
 
 /*
  *	 DoCopy executes the SQL COPY statement
@@ -974,7 +1120,11 @@ DoCopy(ParseState *pstate, const CopyStmt *stmt,
 
 		cstate = BeginCopyFrom(pstate, rel, stmt->filename, stmt->is_program,
 							   NULL, stmt->attlist, stmt->options);
-		*processed = CopyFrom(cstate);	/* copy from file to database */
+		if (cstate->parallel_workers > 0 && CopyFromIsParallelSafe(cstate))
+			*processed = ParallelCopyFrom(cstate, stmt->attlist,
+										  stmt->options);
+		else
+			*processed = CopyFrom(cstate);	/* copy from file to database */
 		EndCopyFrom(cstate);
 	}
 	else
@@ -1019,6 +1169,7 @@ ProcessCopyOptions(ParseState *pstate,
 				   List *options)
 {
 	bool		format_specified = false;
+	bool		parallel_specified = false;
 	ListCell   *option;
 
 	/* Support external use for option sanity checking */
@@ -1188,6 +1339,23 @@ ProcessCopyOptions(ParseState *pstate,
 								defel->defname),
 						 parser_errposition(pstate, defel->location)));
 		}
+		else if (strcmp(defel->defname, "parallel") == 0)
+		{
+			if (parallel_specified)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options"),
+						 parser_errposition(pstate, defel->location)));
+			parallel_specified = true;
+			cstate->parallel_workers = defGetInt32(defel);
+			if (cstate->parallel_workers < 0 ||
+				cstate->parallel_workers > MAX_PARALLEL_WORKER_LIMIT)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("argument to option \"%s\" must be between %d and %d",
+								defel->defname, 0, MAX_PARALLEL_WORKER_LIMIT),
+						 parser_errposition(pstate, defel->location)));
+		}
 		else if (strcmp(defel->defname, "encoding") == 0)
 		{
 			if (cstate->file_encoding >= 0)
@@ -1341,6 +1509,12 @@ ProcessCopyOptions(ParseState *pstate,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("COPY force null only available using COPY FROM")));
 
+	/* Check parallel */
+	if (parallel_specified && !is_from)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY parallel only available using COPY FROM")));
+
 	/* Don't allow the delimiter to appear in the null string. */
 	if (strchr(cstate->null_print, cstate->delim[0]) != NULL)
 		ereport(ERROR,
@@ -2286,13 +2460,12 @@ CopyFrom(CopyState cstate)
 	BulkInsertState bistate;
 	uint64		processed = 0;
 	bool		useHeapMultiInsert;
+	CopyMultiInsertBuffer *buffers[MAX_PARTITION_BUFFERS];
+	CopyMultiInsertBuffer **partition_buffers = NULL;
+	int			nbuffers = 0;
 	int			nBufferedTuples = 0;
-	int			prev_leaf_part_index = -1;
-
-#define MAX_BUFFERED_TUPLES 1000
-	HeapTuple  *bufferedTuples = NULL;	/* initialize to silence warning */
 	Size		bufferedTuplesSize = 0;
-	int			firstBufferedLineNo = 0;
+	int			prev_leaf_part_index = -1;
 
 	Assert(cstate->rel);
 
@@ -2493,13 +2666,20 @@ CopyFrom(CopyState cstate)
 	 * BEFORE/INSTEAD OF triggers, or we need to evaluate volatile default
 	 * expressions. Such triggers or expressions might query the table we're
 	 * inserting to, and act differently if the tuples that have already been
-	 * processed and prepared for insertion are not there.  We also can't do
-	 * it if the table is partitioned.
+	 * processed and prepared for insertion are not there.
+	 *
+	 * If the table is partitioned, we keep a buffer for each partition that
+	 * rows are routed to, but rows for a partition that has BEFORE/INSTEAD
+	 * OF triggers of its own are inserted one at a time.  We don't buffer
+	 * at all if we need to capture transition tuples for the partitioned
+	 * table, since the AFTER ROW triggers fired when flushing a buffer would
+	 * not know the original tuple that was routed to the partition.
 	 */
 	if ((resultRelInfo->ri_TrigDesc != NULL &&
 		 (resultRelInfo->ri_TrigDesc->trig_insert_before_row ||
 		  resultRelInfo->ri_TrigDesc->trig_insert_instead_row)) ||
-		cstate->partition_dispatch_info != NULL ||
+		(cstate->partition_dispatch_info != NULL &&
+		 cstate->transition_capture != NULL) ||
 		cstate->volatile_defexprs)
 	{
 		useHeapMultiInsert = false;
@@ -2507,7 +2687,18 @@ CopyFrom(CopyState cstate)
 	else
 	{
 		useHeapMultiInsert = true;
-		bufferedTuples = palloc(MAX_BUFFERED_TUPLES * sizeof(HeapTuple));
+		if (cstate->partition_dispatch_info != NULL)
+			partition_buffers = (CopyMultiInsertBuffer **)
+				palloc0(cstate->num_partitions * sizeof(CopyMultiInsertBuffer *));
+		else
+		{
+			buffers[nbuffers] = CopyMultiInsertBufferInit(resultRelInfo);
+			if (resultRelInfo->ri_NumIndices == 0 &&
+				heap_can_bulk_write(cstate->rel))
+				buffers[nbuffers]->bulkwrite =
+					begin_heap_bulk_write(cstate->rel, mycid, hi_options);
+			nbuffers++;
+		}
 	}
 
 	/* Prepare to catch AFTER triggers. */
@@ -2536,6 +2727,7 @@ CopyFrom(CopyState cstate)
 	for (;;)
 	{
 		TupleTableSlot *slot;
+		CopyMultiInsertBuffer *buffer;
 		bool		skip_tuple;
 		Oid			loaded_oid = InvalidOid;
 
@@ -2576,6 +2768,12 @@ CopyFrom(CopyState cstate)
 		slot = myslot;
 		ExecStoreTuple(tuple, slot, InvalidBuffer, false);
 
+		/* Unless it's routed to a partition, buffer the tuple for the table */
+		if (useHeapMultiInsert && cstate->partition_dispatch_info == NULL)
+			buffer = buffers[0];
+		else
+			buffer = NULL;
+
 		/* Determine the partition to heap_insert the tuple into */
 		if (cstate->partition_dispatch_info)
 		{
@@ -2665,7 +2863,13 @@ CopyFrom(CopyState cstate)
 			{
 				Relation	partrel = resultRelInfo->ri_RelationDesc;
 
+				/*
+				 * The converted tuple might be buffered, so it must live as
+				 * long as the input tuple does.
+				 */
+				MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
 				tuple = do_convert_tuple(tuple, map);
+				MemoryContextSwitchTo(oldcontext);
 
 				/*
 				 * We must use the partition's tuple descriptor from this
@@ -2675,10 +2879,63 @@ CopyFrom(CopyState cstate)
 				slot = cstate->partition_tuple_slot;
 				Assert(slot != NULL);
 				ExecSetSlotDescriptor(slot, RelationGetDescr(partrel));
-				ExecStoreTuple(tuple, slot, InvalidBuffer, true);
+				ExecStoreTuple(tuple, slot, InvalidBuffer, false);
 			}
 
 			tuple->t_tableOid = RelationGetRelid(resultRelInfo->ri_RelationDesc);
+
+			/*
+			 * Find the partition's multi-insert buffer, making one if
+			 * needed.  If there are already too many, flush them all and
+			 * start over, rather than keep an unbounded number of
+			 * partitions' worth of tuples and bulk insert buffer pins.
+			 */
+			if (useHeapMultiInsert)
+			{
+				if (resultRelInfo->ri_TrigDesc &&
+					(resultRelInfo->ri_TrigDesc->trig_insert_before_row ||
+					 resultRelInfo->ri_TrigDesc->trig_insert_instead_row))
+				{
+					/*
+					 * This row is inserted directly, but its triggers should
+					 * see the rows that came before it.
+					 */
+					if (nBufferedTuples > 0)
+					{
+						CopyFromFlushBuffers(cstate, estate, mycid,
+											 hi_options, buffers, nbuffers);
+						nBufferedTuples = 0;
+						bufferedTuplesSize = 0;
+					}
+				}
+				else
+				{
+					buffer = partition_buffers[leaf_part_index];
+					if (buffer == NULL)
+					{
+						if (nbuffers == MAX_PARTITION_BUFFERS)
+						{
+							int			i;
+
+							CopyFromFlushBuffers(cstate, estate, mycid,
+												 hi_options, buffers,
+												 nbuffers);
+							nBufferedTuples = 0;
+							bufferedTuplesSize = 0;
+
+							for (i = 0; i < nbuffers; i++)
+								CopyMultiInsertBufferFree(buffers[i]);
+							nbuffers = 0;
+							MemSet(partition_buffers, 0,
+								   cstate->num_partitions * sizeof(CopyMultiInsertBuffer *));
+						}
+
+						buffer = CopyMultiInsertBufferInit(resultRelInfo);
+						partition_buffers[leaf_part_index] = buffer;
+						buffers[nbuffers++] = buffer;
+					}
+				}
+			}
 		}
 
 		skip_tuple = false;
@@ -2725,27 +2982,25 @@ CopyFrom(CopyState cstate)
 				if (cstate->rel->rd_att->constr || check_partition_constr)
 					ExecConstraints(resultRelInfo, slot, estate);
 
-				if (useHeapMultiInsert)
+				if (buffer != NULL)
 				{
 					/* Add this tuple to the tuple buffer */
-					if (nBufferedTuples == 0)
-						firstBufferedLineNo = cstate->cur_lineno;
-					bufferedTuples[nBufferedTuples++] = tuple;
+					buffer->linenos[buffer->nused] = cstate->cur_lineno;
+					buffer->tuples[buffer->nused++] = tuple;
+					nBufferedTuples++;
 					bufferedTuplesSize += tuple->t_len;
 
 					/*
-					 * If the buffer filled up, flush it.  Also flush if the
-					 * total size of all the tuples in the buffer becomes
+					 * If the buffers filled up, flush them.  Also flush if
+					 * the total size of all the tuples in the buffers becomes
 					 * large, to avoid using large amounts of memory for the
-					 * buffer when the tuples are exceptionally wide.
+					 * buffers when the tuples are exceptionally wide.
 					 */
 					if (nBufferedTuples == MAX_BUFFERED_TUPLES ||
-						bufferedTuplesSize > 65535)
+						bufferedTuplesSize > MAX_BUFFERED_BYTES)
 					{
-						CopyFromInsertBatch(cstate, estate, mycid, hi_options,
-											resultRelInfo, myslot, bistate,
-											nBufferedTuples, bufferedTuples,
-											firstBufferedLineNo);
+						CopyFromFlushBuffers(cstate, estate, mycid,
+											 hi_options, buffers, nbuffers);
 						nBufferedTuples = 0;
 						bufferedTuplesSize = 0;
 					}
@@ -2791,15 +3046,15 @@ CopyFrom(CopyState cstate)
 
 	/* Flush any remaining buffered tuples */
 	if (nBufferedTuples > 0)
-		CopyFromInsertBatch(cstate, estate, mycid, hi_options,
-							resultRelInfo, myslot, bistate,
-							nBufferedTuples, bufferedTuples,
-							firstBufferedLineNo);
+		CopyFromFlushBuffers(cstate, estate, mycid, hi_options,
+							 buffers, nbuffers);
 
 	/* Done, clean up */
 	error_context_stack = errcallback.previous;
 
 	FreeBulkInsertState(bistate);
+	while (nbuffers > 0)
+		CopyMultiInsertBufferFree(buffers[--nbuffers]);
 
 	MemoryContextSwitchTo(oldcontext);
 
@@ -2869,17 +3124,75 @@ CopyFrom(CopyState cstate)
 }
 
 /*
- * A subroutine of CopyFrom, to write the current batch of buffered heap
- * tuples to the heap. Also updates indexes and runs AFTER ROW INSERT
- * triggers.
+ * Set up a multi-insert buffer for the given relation.
+ *
+ * The buffer has a slot of its own, since it may be flushed while CopyFrom
+ * is still using its slots for the current row.
+ */
+static CopyMultiInsertBuffer *
+CopyMultiInsertBufferInit(ResultRelInfo *resultRelInfo)
+{
+	CopyMultiInsertBuffer *buffer;
+
+	buffer = (CopyMultiInsertBuffer *) palloc(sizeof(CopyMultiInsertBuffer));
+	buffer->resultRelInfo = resultRelInfo;
+	buffer->slot =
+		MakeSingleTupleTableSlot(RelationGetDescr(resultRelInfo->ri_RelationDesc));
+	buffer->bistate = GetBulkInsertState();
+	buffer->bulkwrite = NULL;
+	buffer->nused = 0;
+
+	return buffer;
+}
+
+/*
+ * Release a multi-insert buffer, which must have been flushed.  This also
+ * finishes its bulk write, if any, so it must be done before AFTER ROW
+ * triggers are fired.
+ */
+static void
+CopyMultiInsertBufferFree(CopyMultiInsertBuffer *buffer)
+{
+	Assert(buffer->nused == 0);
+
+	if (buffer->bulkwrite)
+		end_heap_bulk_write(buffer->bulkwrite);
+	ExecDropSingleTupleTableSlot(buffer->slot);
+	FreeBulkInsertState(buffer->bistate);
+	pfree(buffer);
+}
+
+/*
+ * A subroutine of CopyFrom, to write out the tuples in all the given
+ * multi-insert buffers.
+ */
+static void
+CopyFromFlushBuffers(CopyState cstate, EState *estate, CommandId mycid,
+					 int hi_options, CopyMultiInsertBuffer **buffers,
+					 int nbuffers)
+{
+	int			i;
+
+	for (i = 0; i < nbuffers; i++)
+	{
+		if (buffers[i]->nused > 0)
+			CopyFromInsertBatch(cstate, estate, mycid, hi_options, buffers[i]);
+	}
+}
+
+/*
+ * A subroutine of CopyFrom, to write the batch of heap tuples in a
+ * multi-insert buffer to its relation. Also updates indexes and runs AFTER
+ * ROW INSERT triggers, and leaves the buffer empty.
  */
 static void
 CopyFromInsertBatch(CopyState cstate, EState *estate, CommandId mycid,
-					int hi_options, ResultRelInfo *resultRelInfo,
-					TupleTableSlot *myslot, BulkInsertState bistate,
-					int nBufferedTuples, HeapTuple *bufferedTuples,
-					int firstBufferedLineNo)
+					int hi_options, CopyMultiInsertBuffer *buffer)
 {
+	ResultRelInfo *resultRelInfo = buffer->resultRelInfo;
+	Relation	rel = resultRelInfo->ri_RelationDesc;
+	ResultRelInfo *saved_resultRelInfo = estate->es_result_relation_info;
+	TupleTableSlot *slot = buffer->slot;
 	MemoryContext oldcontext;
 	int			i;
 	int			save_cur_lineno;
@@ -2896,31 +3209,39 @@ CopyFromInsertBatch(CopyState cstate, EState *estate, CommandId mycid,
 	 * before calling it.
 	 */
 	oldcontext = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
-	heap_multi_insert(cstate->rel,
-					  bufferedTuples,
-					  nBufferedTuples,
-					  mycid,
-					  hi_options,
-					  bistate);
+	if (buffer->bulkwrite)
+		heap_bulk_write_tuples(buffer->bulkwrite,
+							   buffer->tuples,
+							   buffer->nused);
+	else
+		heap_multi_insert(rel,
+						  buffer->tuples,
+						  buffer->nused,
+						  mycid,
+						  hi_options,
+						  buffer->bistate);
 	MemoryContextSwitchTo(oldcontext);
 
+	/* For ExecInsertIndexTuples() to work on the relation's indexes */
+	estate->es_result_relation_info = resultRelInfo;
+
 	/*
 	 * If there are any indexes, update them for all the inserted tuples, and
 	 * run AFTER ROW INSERT triggers.
 	 */
 	if (resultRelInfo->ri_NumIndices > 0)
 	{
-		for (i = 0; i < nBufferedTuples; i++)
+		for (i = 0; i < buffer->nused; i++)
 		{
 			List	   *recheckIndexes;
 
-			cstate->cur_lineno = firstBufferedLineNo + i;
-			ExecStoreTuple(bufferedTuples[i], myslot, InvalidBuffer, false);
+			cstate->cur_lineno = buffer->linenos[i];
+			ExecStoreTuple(buffer->tuples[i], slot, InvalidBuffer, false);
 			recheckIndexes =
-				ExecInsertIndexTuples(myslot, &(bufferedTuples[i]->t_self),
+				ExecInsertIndexTuples(slot, &(buffer->tuples[i]->t_self),
 									  estate, false, NULL, NIL);
 			ExecARInsertTriggers(estate, resultRelInfo,
-								 bufferedTuples[i],
+								 buffer->tuples[i],
 								 recheckIndexes, cstate->transition_capture);
 			list_free(recheckIndexes);
 		}
@@ -2934,17 +3255,418 @@ CopyFromInsertBatch(CopyState cstate, EState *estate, CommandId mycid,
 			 (resultRelInfo->ri_TrigDesc->trig_insert_after_row ||
 			  resultRelInfo->ri_TrigDesc->trig_insert_new_table))
 	{
-		for (i = 0; i < nBufferedTuples; i++)
+		for (i = 0; i < buffer->nused; i++)
 		{
-			cstate->cur_lineno = firstBufferedLineNo + i;
+			cstate->cur_lineno = buffer->linenos[i];
 			ExecARInsertTriggers(estate, resultRelInfo,
-								 bufferedTuples[i],
+								 buffer->tuples[i],
 								 NIL, cstate->transition_capture);
 		}
 	}
 
-	/* reset cur_lineno to where we were */
+	buffer->nused = 0;
+
+	/* reset cur_lineno and result relation to where we were */
 	cstate->cur_lineno = save_cur_lineno;
+	estate->es_result_relation_info = saved_resultRelInfo;
+}
+
+/*
+ * Can this COPY FROM be done by parallel workers?
+ *
+ * The workers insert the rows in no particular order, each with executor
+ * state of its own, so nothing may observe that order or need to run in the
+ * leader: no triggers (which also rules out foreign keys and deferrable
+ * unique constraints), no partition routing, no temporary tables, and no
+ * expressions or input functions that aren't parallel safe.  If any of that
+ * doesn't hold, we do a serial copy instead; the PARALLEL option is a
+ * request, not a promise.
+ */
+static bool
+CopyFromIsParallelSafe(CopyState cstate)
+{
+	Relation	rel = cstate->rel;
+	TupleDesc	tupDesc = RelationGetDescr(rel);
+	TupleConstr *constr = tupDesc->constr;
+	List	   *indexoidlist;
+	ListCell   *lc;
+	int			i;
+
+	/* Binary input has no line boundaries to split it at */
+	if (cstate->binary)
+		return false;
+
+	/* The old protocol's end-of-copy handling is done in CopyFrom */
+	if (cstate->copy_dest == COPY_OLD_FE)
+		return false;
+
+	/*
+	 * FREEZE, and skipping WAL for a table created or truncated in this
+	 * transaction, depend on relcache state that workers don't have.  A
+	 * serial copy can use those optimizations instead.
+	 */
+	if (cstate->freeze ||
+		rel->rd_createSubid != InvalidSubTransactionId ||
+		rel->rd_newRelfilenodeSubid != InvalidSubTransactionId)
+		return false;
+
+	if (rel->rd_rel->relkind != RELKIND_RELATION || rel->trigdesc != NULL)
+		return false;
+
+	/* Workers can't access our local buffers */
+	if (RelationUsesLocalBuffers(rel))
+		return false;
+
+	/*
+	 * As with multi-insert, a volatile default might look at the table
+	 * being loaded; and any default has to be safe to run in a worker.
+	 */
+	if (cstate->volatile_defexprs)
+		return false;
+	for (i = 0; i < cstate->num_defaults; i++)
+	{
+		if (!is_parallel_safe_expr((Node *) cstate->defexprs[i]->expr))
+			return false;
+	}
+
+	/* Input functions, including any domain constraints they check */
+	for (i = 0; i < tupDesc->natts; i++)
+	{
+		Form_pg_attribute att = tupDesc->attrs[i];
+
+		if (att->attisdropped)
+			continue;
+		if (func_parallel(cstate->in_functions[i].fn_oid) != PROPARALLEL_SAFE ||
+			DomainHasConstraints(att->atttypid))
+			return false;
+	}
+
+	/* CHECK constraints */
+	if (constr != NULL)
+	{
+		for (i = 0; i < constr->num_check; i++)
+		{
+			if (!is_parallel_safe_expr(stringToNode(constr->check[i].ccbin)))
+				return false;
+		}
+	}
+
+	/* Index expressions and predicates */
+	indexoidlist = RelationGetIndexList(rel);
+	foreach(lc, indexoidlist)
+	{
+		Relation	indexDesc = index_open(lfirst_oid(lc), RowExclusiveLock);
+		bool		safe;
+
+		safe = is_parallel_safe_expr((Node *) RelationGetIndexExpressions(indexDesc)) &&
+			is_parallel_safe_expr((Node *) RelationGetIndexPredicate(indexDesc));
+		index_close(indexDesc, NoLock);
+
+		if (!safe)
+		{
+			list_free(indexoidlist);
+			return false;
+		}
+	}
+	list_free(indexoidlist);
+
+	return true;
+}
+
+/*
+ * Copy FROM file to relation, using parallel workers.
+ *
+ * The leader reads the input and splits it into lines exactly as a serial
+ * copy would, including encoding conversion, and hands the lines to the
+ * workers in chunks.  Each worker runs an ordinary CopyFrom() on the lines
+ * it receives (see ParallelCopyMain), so converting the fields, checking
+ * constraints, and inserting into the heap and indexes all happen in
+ * parallel.  Finding line boundaries can't be parallelized in general,
+ * since a CSV quoted field may contain newlines, but it is much cheaper
+ * than the rest.
+ */
+static uint64
+ParallelCopyFrom(CopyState cstate, List *attnamelist, List *options)
+{
+	ParallelContext *pcxt;
+	ParallelCopyShared *shared;
+	char	   *args;
+	char	   *argsspace;
+	char	   *mqspace;
+	ParallelCopyQueue *queues;
+	int			nworkers;
+	int			cur = 0;
+	uint64		processed;
+	ErrorContextCallback errcallback;
+	int			i;
+
+	/*
+	 * The workers insert with our XID and command ID, but can't assign the
+	 * one or mark the other as used themselves, so do both now.
+	 */
+	(void) GetCurrentTransactionId();
+	(void) GetCurrentCommandId(true);
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext("postgres", "ParallelCopyMain",
+								 cstate->parallel_workers);
+
+	/* Workers set up their CopyState from the same arguments as ours */
+	args = nodeToString(list_make3(cstate->range_table, attnamelist, options));
+
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(ParallelCopyShared));
+	shm_toc_estimate_chunk(&pcxt->estimator, strlen(args) + 1);
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(PARALLEL_COPY_QUEUE_SIZE, pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 3);
+
+	InitializeParallelDSM(pcxt);
+
+	shared = shm_toc_allocate(pcxt->toc, sizeof(ParallelCopyShared));
+	shared->relid = RelationGetRelid(cstate->rel);
+	pg_atomic_init_u64(&shared->processed, 0);
+	shm_toc_insert(pcxt->toc, PARALLEL_COPY_KEY_SHARED, shared);
+
+	argsspace = shm_toc_allocate(pcxt->toc, strlen(args) + 1);
+	strcpy(argsspace, args);
+	shm_toc_insert(pcxt->toc, PARALLEL_COPY_KEY_ARGS, argsspace);
+
+	mqspace = shm_toc_allocate(pcxt->toc,
+							   mul_size(PARALLEL_COPY_QUEUE_SIZE, pcxt->nworkers));
+	shm_toc_insert(pcxt->toc, PARALLEL_COPY_KEY_QUEUES, mqspace);
+
+	queues = (ParallelCopyQueue *)
+		palloc0(pcxt->nworkers * sizeof(ParallelCopyQueue));
+	for (i = 0; i < pcxt->nworkers; i++)
+	{
+		shm_mq	   *mq;
+
+		mq = shm_mq_create(mqspace + i * PARALLEL_COPY_QUEUE_SIZE,
+						   PARALLEL_COPY_QUEUE_SIZE);
+		shm_mq_set_sender(mq, MyProc);
+		queues[i].mqh = shm_mq_attach(mq, pcxt->seg, NULL);
+		initStringInfo(&queues[i].buf);
+	}
+
+	LaunchParallelWorkers(pcxt);
+	nworkers = pcxt->nworkers_launched;
+
+	if (nworkers == 0)
+	{
+		/* No workers to be had, so do it ourselves */
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return CopyFrom(cstate);
+	}
+
+	/* Let shm_mq notice if a worker dies before attaching to its queue */
+	for (i = 0; i < nworkers; i++)
+		shm_mq_set_handle(queues[i].mqh, pcxt->worker[i].bgwhandle);
+
+	/*
+	 * Set up callback to identify error line number.  Errors thrown by the
+	 * workers have their own context, established in their CopyFrom().
+	 */
+	errcallback.callback = CopyFromErrorCallback;
+	errcallback.arg = (void *) cstate;
+	errcallback.previous = error_context_stack;
+	error_context_stack = &errcallback;
+
+	for (;;)
+	{
+		ParallelCopyQueue *queue;
+		bool		done;
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* on input just throw the header line away */
+		if (cstate->cur_lineno == 0 && cstate->header_line)
+		{
+			cstate->cur_lineno++;
+			if (CopyReadLine(cstate))
+				break;			/* done */
+		}
+
+		cstate->cur_lineno++;
+		done = CopyReadLine(cstate);
+
+		/* see NextCopyFromRawFields */
+		if (done && cstate->line_buf.len == 0)
+			break;
+
+		cur = ParallelCopyNextQueue(queues, nworkers, cur);
+		queue = &queues[cur];
+
+		appendBinaryStringInfo(&queue->buf, (char *) &cstate->cur_lineno,
+							   sizeof(int));
+		appendBinaryStringInfo(&queue->buf, (char *) &cstate->line_buf.len,
+							   sizeof(int));
+		appendBinaryStringInfo(&queue->buf, cstate->line_buf.data,
+							   cstate->line_buf.len);
+
+		/* Once the chunk is big enough, send it and move on to the next */
+		if (queue->buf.len >= PARALLEL_COPY_CHUNK_SIZE)
+		{
+			queue->sending = true;
+			ParallelCopySend(queue);
+			cur = (cur + 1) % nworkers;
+		}
+
+		if (done)
+			break;
+	}
+
+	error_context_stack = errcallback.previous;
+
+	/* Send whatever is left */
+	for (i = 0; i < nworkers; i++)
+	{
+		if (queues[i].buf.len > 0 && !queues[i].sending)
+		{
+			queues[i].sending = true;
+			ParallelCopySend(&queues[i]);
+		}
+	}
+	for (;;)
+	{
+		bool		busy = false;
+
+		for (i = 0; i < nworkers; i++)
+		{
+			if (queues[i].sending)
+				ParallelCopySend(&queues[i]);
+			busy |= queues[i].sending;
+		}
+		if (!busy)
+			break;
+
+		WaitLatch(MyLatch, WL_LATCH_SET, 0, WAIT_EVENT_MQ_SEND);
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	/* Detaching tells the workers that there are no more lines */
+	for (i = 0; i < pcxt->nworkers; i++)
+		shm_mq_detach(shm_mq_get_queue(queues[i].mqh));
+
+	WaitForParallelWorkersToFinish(pcxt);
+	processed = pg_atomic_read_u64(&shared->processed);
+
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+
+	return processed;
+}
+
+/*
+ * Pick the worker whose chunk the next line goes into, starting the search
+ * at 'start'.  Chunks still being sent are retried as we go, and if all of
+ * them are, we wait for a worker to make room in its queue.
+ */
+static int
+ParallelCopyNextQueue(ParallelCopyQueue *queues, int nqueues, int start)
+{
+	for (;;)
+	{
+		int			i;
+
+		for (i = 0; i < nqueues; i++)
+		{
+			int			n = (start + i) % nqueues;
+
+			if (queues[n].sending)
+				ParallelCopySend(&queues[n]);
+			if (!queues[n].sending)
+				return n;
+		}
+
+		WaitLatch(MyLatch, WL_LATCH_SET, 0, WAIT_EVENT_MQ_SEND);
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
+/*
+ * Try to send a worker its chunk of lines, without waiting.
+ *
+ * If the queue is full, the chunk stays marked as being sent, and must be
+ * retried later with the same contents: shm_mq_send() may already have
+ * transferred part of it.
+ */
+static void
+ParallelCopySend(ParallelCopyQueue *queue)
+{
+	shm_mq_result res;
+
+	Assert(queue->sending);
+
+	res = shm_mq_send(queue->mqh, queue->buf.len, queue->buf.data, true,
+					  true);
+	if (res == SHM_MQ_WOULD_BLOCK)
+		return;
+	if (res == SHM_MQ_DETACHED)
+	{
+		/* If the worker failed, report its error rather than ours */
+		CHECK_FOR_INTERRUPTS();
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("lost connection to parallel worker")));
+	}
+
+	resetStringInfo(&queue->buf);
+	queue->sending = false;
+}
+
+/*
+ * Data source callback for parallel COPY workers, which get their input
+ * from the leader instead.
+ */
+static int
+ParallelCopyNoData(void *outbuf, int minread, int maxread)
+{
+	elog(ERROR, "parallel COPY worker cannot read input data");
+	return 0;					/* keep compiler quiet */
+}
+
+/*
+ * Main entry point for parallel COPY FROM workers.
+ */
+void
+ParallelCopyMain(dsm_segment *seg, shm_toc *toc)
+{
+	ParallelCopyShared *shared;
+	List	   *args;
+	char	   *mqspace;
+	shm_mq	   *mq;
+	Relation	rel;
+	CopyState	cstate;
+	uint64		processed;
+
+	shared = shm_toc_lookup(toc, PARALLEL_COPY_KEY_SHARED, false);
+	args = (List *) stringToNode(shm_toc_lookup(toc, PARALLEL_COPY_KEY_ARGS,
+												false));
+	mqspace = shm_toc_lookup(toc, PARALLEL_COPY_KEY_QUEUES, false);
+
+	mq = (shm_mq *) (mqspace + ParallelWorkerNumber * PARALLEL_COPY_QUEUE_SIZE);
+	shm_mq_set_receiver(mq, MyProc);
+
+	/* The leader already holds the same lock */
+	rel = heap_open(shared->relid, RowExclusiveLock);
+
+	cstate = BeginCopyFrom(NULL, rel, NULL, false, ParallelCopyNoData,
+						   (List *) lsecond(args), (List *) lthird(args));
+	cstate->range_table = (List *) linitial(args);
+	cstate->line_queue = shm_mq_attach(mq, seg, NULL);
+
+	/* The leader has already skipped the header and converted the lines */
+	cstate->header_line = false;
+	cstate->need_transcoding = false;
+
+	processed = CopyFrom(cstate);
+	(void) pg_atomic_fetch_add_u64(&shared->processed, processed);
+
+	EndCopyFrom(cstate);
+	heap_close(rel, NoLock);
 }
 
 /*
@@ -3151,7 +3873,7 @@ BeginCopyFrom(ParseState *pstate,
 		int32		tmp;
 
 		/* Signature */
-		if (CopyGetData(cstate, readSig, 11, 11) != 11 ||
+		if (CopyReadBinaryData(cstate, readSig, 11) != 11 ||
 			memcmp(readSig, BinarySignature, 11) != 0)
 			ereport(ERROR,
 					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
@@ -3176,7 +3898,7 @@ BeginCopyFrom(ParseState *pstate,
 		/* Skip extension header, if present */
 		while (tmp-- > 0)
 		{
-			if (CopyGetData(cstate, readSig, 1, 1) != 1)
+			if (CopyReadBinaryData(cstate, readSig, 1) != 1)
 				ereport(ERROR,
 						(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
 						 errmsg("invalid COPY file header (wrong length)")));
@@ -3236,7 +3958,10 @@ NextCopyFromRawFields(CopyState cstate, char ***fields, int *nfields)
 	cstate->cur_lineno++;
 
 	/* Actually read the line into memory here */
-	done = CopyReadLine(cstate);
+	if (cstate->line_queue)
+		done = CopyReadParallelLine(cstate);
+	else
+		done = CopyReadLine(cstate);
 
 	/*
 	 * EOF at start of line means we're done.  If we see EOF after some
@@ -3433,7 +4158,7 @@ NextCopyFrom(CopyState cstate, ExprContext *econtext,
 			char		dummy;
 
 			if (cstate->copy_dest != COPY_OLD_FE &&
-				CopyGetData(cstate, &dummy, 1, 1) > 0)
+				CopyReadBinaryData(cstate, &dummy, 1) > 0)
 				ereport(ERROR,
 						(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
 						 errmsg("received copy data after EOF marker")));
@@ -3611,6 +4336,96 @@ CopyReadLine(CopyState cstate)
 	return result;
 }
 
+/*
+ * In a parallel COPY worker, fetch the next line sent by the leader into
+ * line_buf, in place of CopyReadLine.  The line has already been converted
+ * to server encoding, and cur_lineno is set to its position in the input.
+ *
+ * Result is true if there are no more lines.
+ */
+static bool
+CopyReadParallelLine(CopyState cstate)
+{
+	int			lineno;
+	int			len;
+
+	resetStringInfo(&cstate->line_buf);
+	cstate->line_buf_valid = false;
+
+	if (cstate->chunk_pos >= cstate->chunk_len)
+	{
+		shm_mq_result res;
+		Size		nbytes;
+		void	   *data;
+
+		res = shm_mq_receive(cstate->line_queue, &nbytes, &data, false);
+		if (res == SHM_MQ_DETACHED)
+			return true;		/* the leader has sent everything */
+		Assert(res == SHM_MQ_SUCCESS);
+
+		cstate->chunk_data = (char *) data;
+		cstate->chunk_len = nbytes;
+		cstate->chunk_pos = 0;
+	}
+
+	Assert(cstate->chunk_pos + 2 * sizeof(int) <= cstate->chunk_len);
+	memcpy(&lineno, cstate->chunk_data + cstate->chunk_pos, sizeof(int));
+	cstate->chunk_pos += sizeof(int);
+	memcpy(&len, cstate->chunk_data + cstate->chunk_pos, sizeof(int));
+	cstate->chunk_pos += sizeof(int);
+
+	Assert(cstate->chunk_pos + len <= cstate->chunk_len);
+	appendBinaryStringInfo(&cstate->line_buf,
+						   cstate->chunk_data + cstate->chunk_pos, len);
+	cstate->chunk_pos += len;
+
+	cstate->cur_lineno = lineno;
+	cstate->line_buf_valid = true;
+	cstate->line_buf_converted = true;
+
+	return false;
+}
+
+/*
+ * Count how many bytes at the start of s, which is len bytes long, need no
+ * special handling by the COPY scanning loops: that is, are none of the
+ * nspecials characters in specials[], nor, if stop_at_highbit is true, have
+ * the high bit set.
+ *
+ * This works a whole vector at a time, stopping at the first vector that
+ * contains a special byte.  The result may therefore fall short of the
+ * first special byte by up to sizeof(Vector8) - 1 bytes, which the caller
+ * must then examine one at a time as usual.
+ */
+static inline int
+CopySkipPlainChars(const char *s, int len, const char *specials,
+				   int nspecials, bool stop_at_highbit)
+{
+	Vector8		special_vecs[5];
+	int			i;
+	int			j;
+
+	Assert(nspecials <= lengthof(special_vecs));
+
+	for (j = 0; j < nspecials; j++)
+		special_vecs[j] = vector8_broadcast((uint8) specials[j]);
+
+	for (i = 0; i + (int) sizeof(Vector8) <= len; i += sizeof(Vector8))
+	{
+		Vector8		chunk;
+		Vector8		found;
+
+		vector8_load(&chunk, (const uint8 *) s + i);
+		found = stop_at_highbit ? chunk : vector8_broadcast(0);
+		for (j = 0; j < nspecials; j++)
+			found = vector8_or(found, vector8_eq(chunk, special_vecs[j]));
+		if (vector8_is_highbit_set(found))
+			break;
+	}
+
+	return i;
+}
+
 /*
  * CopyReadLineText - inner loop of CopyReadLine for text mode
  */
@@ -3620,10 +4435,13 @@ CopyReadLineText(CopyState cstate)
 	char	   *copy_raw_buf;
 	int			raw_buf_ptr;
 	int			copy_buf_len;
+	int			scalar_end = 0;
 	bool		need_data = false;
 	bool		hit_eof = false;
 	bool		result = false;
 	char		mblen_str[2];
+	char		specials[5];
+	int			nspecials = 0;
 
 	/* CSV variables */
 	bool		first_char_in_line = true;
@@ -3643,6 +4461,22 @@ CopyReadLineText(CopyState cstate)
 
 	mblen_str[1] = '\0';
 
+	/*
+	 * Bytes that the loop below must look at individually.  When the
+	 * encoding embeds ASCII in multibyte characters, bytes with the high bit
+	 * set must be too, so as not to mistake part of a character for one of
+	 * these.
+	 */
+	specials[nspecials++] = '\n';
+	specials[nspecials++] = '\r';
+	specials[nspecials++] = '\\';
+	if (cstate->csv_mode)
+	{
+		specials[nspecials++] = quotec;
+		if (escapec != '\0')
+			specials[nspecials++] = escapec;
+	}
+
 	/*
 	 * The objective of this loop is to transfer the entire next input line
 	 * into line_buf.  Hence, we only care for detecting newlines (\r and/or
@@ -3694,6 +4528,7 @@ CopyReadLineText(CopyState cstate)
 			if (!CopyLoadRawBuf(cstate))
 				hit_eof = true;
 			raw_buf_ptr = 0;
+			scalar_end = 0;
 			copy_buf_len = cstate->raw_buf_len;
 
 			/*
@@ -3708,6 +4543,32 @@ CopyReadLineText(CopyState cstate)
 			need_data = false;
 		}
 
+		/*
+		 * Skip quickly over any run of bytes that need no special handling,
+		 * many at a time.  Such bytes don't change the CSV state, except
+		 * that they are neither the first character in the line nor an
+		 * escape.  Once the vector scan has stopped short of a special byte,
+		 * don't retry it until we're past the vector that contains it.
+		 */
+		if (raw_buf_ptr >= scalar_end)
+		{
+			int			nplain;
+
+			nplain = CopySkipPlainChars(copy_raw_buf + raw_buf_ptr,
+										copy_buf_len - raw_buf_ptr,
+										specials, nspecials,
+										cstate->encoding_embeds_ascii);
+			raw_buf_ptr += nplain;
+			scalar_end = raw_buf_ptr + sizeof(Vector8);
+			if (nplain > 0)
+			{
+				first_char_in_line = false;
+				last_was_esc = false;
+				if (raw_buf_ptr >= copy_buf_len)
+					continue;
+			}
+		}
+
 		/* OK to fetch a character */
 		prev_raw_ptr = raw_buf_ptr;
 		c = copy_raw_buf[raw_buf_ptr++];
@@ -4005,6 +4866,7 @@ static int
 CopyReadAttributesText(CopyState cstate)
 {
 	char		delimc = cstate->delim[0];
+	char		specials[2];
 	int			fieldno;
 	char	   *output_ptr;
 	char	   *cur_ptr;
@@ -4040,6 +4902,10 @@ CopyReadAttributesText(CopyState cstate)
 	cur_ptr = cstate->line_buf.data;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
 
+	/* bytes that end a run of field data needing no de-escaping */
+	specials[0] = delimc;
+	specials[1] = '\\';
+
 	/* Outer loop iterates over fields */
 	fieldno = 0;
 	for (;;)
@@ -4048,6 +4914,7 @@ CopyReadAttributesText(CopyState cstate)
 		char	   *start_ptr;
 		char	   *end_ptr;
 		int			input_len;
+		int			nplain;
 		bool		saw_non_ascii = false;
 
 		/* Make sure there is enough space for the next value */
@@ -4062,6 +4929,13 @@ CopyReadAttributesText(CopyState cstate)
 		start_ptr = cur_ptr;
 		cstate->raw_fields[fieldno] = output_ptr;
 
+		/* Copy over any long prefix of the field that has no escapes */
+		nplain = CopySkipPlainChars(cur_ptr, line_end_ptr - cur_ptr,
+									specials, lengthof(specials), false);
+		memcpy(output_ptr, cur_ptr, nplain);
+		output_ptr += nplain;
+		cur_ptr += nplain;
+
 		/*
 		 * Scan data for field.
 		 *
@@ -4235,6 +5109,8 @@ CopyReadAttributesCSV(CopyState cstate)
 	char		delimc = cstate->delim[0];
 	char		quotec = cstate->quote[0];
 	char		escapec = cstate->escape[0];
+	char		unquoted_specials[2];
+	char		quoted_specials[2];
 	int			fieldno;
 	char	   *output_ptr;
 	char	   *cur_ptr;
@@ -4270,6 +5146,12 @@ CopyReadAttributesCSV(CopyState cstate)
 	cur_ptr = cstate->line_buf.data;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
 
+	/* bytes that end a run of data to be copied verbatim, in each mode */
+	unquoted_specials[0] = delimc;
+	unquoted_specials[1] = quotec;
+	quoted_specials[0] = quotec;
+	quoted_specials[1] = escapec;
+
 	/* Outer loop iterates over fields */
 	fieldno = 0;
 	for (;;)
@@ -4302,8 +5184,15 @@ CopyReadAttributesCSV(CopyState cstate)
 		for (;;)
 		{
 			char		c;
+			int			nplain;
 
 			/* Not in quote */
+			nplain = CopySkipPlainChars(cur_ptr, line_end_ptr - cur_ptr,
+										unquoted_specials,
+										lengthof(unquoted_specials), false);
+			memcpy(output_ptr, cur_ptr, nplain);
+			output_ptr += nplain;
+			cur_ptr += nplain;
 			for (;;)
 			{
 				end_ptr = cur_ptr;
@@ -4327,6 +5216,12 @@ CopyReadAttributesCSV(CopyState cstate)
 			}
 
 			/* In quote */
+			nplain = CopySkipPlainChars(cur_ptr, line_end_ptr - cur_ptr,
+										quoted_specials,
+										lengthof(quoted_specials), false);
+			memcpy(output_ptr, cur_ptr, nplain);
+			output_ptr += nplain;
+			cur_ptr += nplain;
 			for (;;)
 			{
 				end_ptr = cur_ptr;
@@ -4395,6 +5290,123 @@ endfield:
 }
 
 
+/*
+ * Try to decode a binary field of a common fixed-width type in place
+ *
+ * For types whose receive function just converts a fixed number of bytes
+ * from network byte order, it's much cheaper to do that directly out of
+ * raw_buf than to copy the field into attribute_buf and call the receive
+ * function through fmgr.  The conversions here must match those functions
+ * exactly.
+ *
+ * Returns false, consuming nothing, if the type isn't handled here or the
+ * field doesn't have the expected size; the caller then takes the regular
+ * path, which also takes care of reporting malformed input.
+ */
+static bool
+CopyReadBinaryFixed(CopyState cstate, Oid recvfn, int32 fld_size,
+					Datum *result)
+{
+	int32		expected;
+	const char *data;
+	uint16		u16;
+	uint32		u32;
+	uint32		h32;
+	uint32		l32;
+
+	switch (recvfn)
+	{
+		case F_BOOLRECV:
+			expected = 1;
+			break;
+		case F_INT2RECV:
+			expected = sizeof(int16);
+			break;
+		case F_INT4RECV:
+		case F_OIDRECV:
+		case F_FLOAT4RECV:
+			expected = sizeof(int32);
+			break;
+		case F_INT8RECV:
+		case F_FLOAT8RECV:
+			expected = sizeof(int64);
+			break;
+		default:
+			return false;
+	}
+
+	if (fld_size != expected)
+		return false;
+
+	/* Make sure the whole field is in raw_buf, contiguously */
+	while (RAW_BUF_BYTES(cstate) < fld_size)
+	{
+		if (!CopyLoadRawBuf(cstate))
+			return false;		/* EOF; let the regular path complain */
+	}
+
+	data = cstate->raw_buf + cstate->raw_buf_index;
+
+	switch (recvfn)
+	{
+		case F_BOOLRECV:
+			*result = BoolGetDatum(*data != 0);
+			break;
+		case F_INT2RECV:
+			memcpy(&u16, data, sizeof(u16));
+			*result = Int16GetDatum((int16) ntohs(u16));
+			break;
+		case F_INT4RECV:
+			memcpy(&u32, data, sizeof(u32));
+			*result = Int32GetDatum((int32) ntohl(u32));
+			break;
+		case F_OIDRECV:
+			memcpy(&u32, data, sizeof(u32));
+			*result = ObjectIdGetDatum((Oid) ntohl(u32));
+			break;
+		case F_FLOAT4RECV:
+			{
+				union
+				{
+					float4		f;
+					uint32		i;
+				}			swap;
+
+				memcpy(&u32, data, sizeof(u32));
+				swap.i = ntohl(u32);
+				*result = Float4GetDatum(swap.f);
+			}
+			break;
+		case F_INT8RECV:
+		case F_FLOAT8RECV:
+			{
+				union
+				{
+					float8		f;
+					int64		i;
+				}			swap;
+
+				memcpy(&h32, data, sizeof(h32));
+				memcpy(&l32, data + sizeof(h32), sizeof(l32));
+				swap.i = ntohl(h32);
+				swap.i <<= 32;
+				swap.i |= ntohl(l32);
+				if (recvfn == F_INT8RECV)
+					*result = Int64GetDatum(swap.i);
+				else
+					*result = Float8GetDatum(swap.f);
+			}
+			break;
+		default:
+			/* can't happen, the first switch rejected anything else */
+			elog(ERROR, "unexpected receive function %u", recvfn);
+			break;
+	}
+
+	cstate->raw_buf_index += fld_size;
+	return true;
+}
+
 /*
  * Read a binary attribute
  */
@@ -4421,12 +5433,19 @@ CopyReadBinaryAttribute(CopyState cstate,
 				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
 				 errmsg("invalid field size")));
 
+	/* Common fixed-width types can be decoded in place */
+	if (CopyReadBinaryFixed(cstate, flinfo->fn_oid, fld_size, &result))
+	{
+		*isnull = false;
+		return result;
+	}
+
 	/* reset attribute_buf to empty, and load raw data in it */
 	resetStringInfo(&cstate->attribute_buf);
 
 	enlargeStringInfo(&cstate->attribute_buf, fld_size);
-	if (CopyGetData(cstate, cstate->attribute_buf.data,
-					fld_size, fld_size) != fld_size)
+	if (CopyReadBinaryData(cstate, cstate->attribute_buf.data,
+						   fld_size) != fld_size)
 		ereport(ERROR,
 				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
 				 errmsg("unexpected EOF in COPY data")));
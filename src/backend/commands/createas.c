@@ -24,6 +24,7 @@
  */
 #include "postgres.h"
 
+#include "access/heapbulk.h"
 #include "access/reloptions.h"
 #include "access/htup_details.h"
 #include "access/sysattr.h"
@@ -60,6 +61,7 @@ typedef struct
 	CommandId	output_cid;		/* cmin to insert in output tuples */
 	int			hi_options;		/* heap_insert performance options */
 	BulkInsertState bistate;	/* bulk insert state */
+	HeapBulkWriteState bulkwrite;	/* bulk write state, if using that */
 } DR_intorel;
 
 /* utility functions for CTAS definition creation */
@@ -326,8 +328,8 @@ ExecCreateTableAs(CreateTableAsStmt *stmt, const char *queryString,
 		query = linitial_node(Query, rewritten);
 		Assert(query->commandType == CMD_SELECT);
 
-		/* plan the query --- note we disallow parallelism */
-		plan = pg_plan_query(query, 0, params);
+		/* plan the query */
+		plan = pg_plan_query(query, CURSOR_OPT_PARALLEL_OK, params);
 
 		/*
 		 * Use a snapshot with an updated command ID to ensure this query sees
@@ -569,7 +571,23 @@ intorel_startup(DestReceiver *self, int operation, TupleDesc typeinfo)
 	 */
 	myState->hi_options = HEAP_INSERT_SKIP_FSM |
 		(XLogIsNeeded() ? 0 : HEAP_INSERT_SKIP_WAL);
-	myState->bistate = GetBulkInsertState();
+
+	/*
+	 * Nobody else can be inserting into the new relation, so we can usually
+	 * build its pages locally and bypass shared buffers.
+	 */
+	if (heap_can_bulk_write(intoRelationDesc))
+	{
+		myState->bistate = NULL;
+		myState->bulkwrite = begin_heap_bulk_write(intoRelationDesc,
+												   myState->output_cid,
+												   myState->hi_options);
+	}
+	else
+	{
+		myState->bistate = GetBulkInsertState();
+		myState->bulkwrite = NULL;
+	}
 
 	/* Not using WAL requires smgr_targblock be initially invalid */
 	Assert(RelationGetTargetBlock(intoRelationDesc) == InvalidBlockNumber);
@@ -596,11 +614,14 @@ intorel_receive(TupleTableSlot *slot, DestReceiver *self)
 	if (myState->rel->rd_rel->relhasoids)
 		HeapTupleSetOid(tuple, InvalidOid);
 
-	heap_insert(myState->rel,
-				tuple,
-				myState->output_cid,
-				myState->hi_options,
-				myState->bistate);
+	if (myState->bulkwrite)
+		heap_bulk_write_tuples(myState->bulkwrite, &tuple, 1);
+	else
+		heap_insert(myState->rel,
+					tuple,
+					myState->output_cid,
+					myState->hi_options,
+					myState->bistate);
 
 	/* We know this is a newly created relation, so there are no indexes */
 
@@ -615,7 +636,10 @@ intorel_shutdown(DestReceiver *self)
 {
 	DR_intorel *myState = (DR_intorel *) self;
 
-	FreeBulkInsertState(myState->bistate);
+	if (myState->bulkwrite)
+		end_heap_bulk_write(myState->bulkwrite);
+	else
+		FreeBulkInsertState(myState->bistate);
 
 	/* If we skipped using WAL, must heap_sync before commit */
 	if (myState->hi_options & HEAP_INSERT_SKIP_WAL)
@@ -102,6 +102,8 @@ static void show_tablesample(TableSampleClause *tsc, PlanState *planstate,
 				 List *ancestors, ExplainState *es);
 static void show_sort_info(SortState *sortstate, ExplainState *es);
 static void show_hash_info(HashState *hashstate, ExplainState *es);
+static void show_resultcache_info(ResultCacheState *rcstate, List *ancestors,
+					  ExplainState *es);
 static void show_tidbitmap_info(BitmapHeapScanState *planstate,
 					ExplainState *es);
 static void show_instrumentation_count(const char *qlabel, int which,
@@ -400,8 +402,6 @@ ExplainOneUtility(Node *utilityStmt, IntoClause *into, ExplainState *es,
 		 * We have to rewrite the contained SELECT and then pass it back to
 		 * ExplainOneQuery.  It's probably not really necessary to copy the
 		 * contained parsetree another time, but let's be safe.
-		 *
-		 * Like ExecCreateTableAs, disallow parallelism in the plan.
 		 */
 		CreateTableAsStmt *ctas = (CreateTableAsStmt *) utilityStmt;
 		List	   *rewritten;
@@ -409,7 +409,7 @@ ExplainOneUtility(Node *utilityStmt, IntoClause *into, ExplainState *es,
 		rewritten = QueryRewrite(castNode(Query, copyObject(ctas->query)));
 		Assert(list_length(rewritten) == 1);
 		ExplainOneQuery(linitial_node(Query, rewritten),
-						0, ctas->into, es,
+						CURSOR_OPT_PARALLEL_OK, ctas->into, es,
 						queryString, params, queryEnv);
 	}
 	else if (IsA(utilityStmt, DeclareCursorStmt))
@@ -1013,6 +1013,9 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Material:
 			pname = sname = "Materialize";
 			break;
+		case T_ResultCache:
+			pname = sname = "Result Cache";
+			break;
 		case T_Sort:
 			pname = sname = "Sort";
 			break;
@@ -1625,6 +1628,10 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Hash:
 			show_hash_info(castNode(HashState, planstate), es);
 			break;
+		case T_ResultCache:
+			show_resultcache_info(castNode(ResultCacheState, planstate),
+								  ancestors, es);
+			break;
 		default:
 			break;
 	}
@@ -2364,6 +2371,80 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 	}
 }
 
+/*
+ * Show the cache keys of a ResultCache node, and for EXPLAIN ANALYZE, how
+ * well the cache worked.
+ */
+static void
+show_resultcache_info(ResultCacheState *rcstate, List *ancestors,
+					  ExplainState *es)
+{
+	ResultCache *plan = (ResultCache *) rcstate->ss.ps.plan;
+	List	   *context;
+	StringInfoData keystr;
+	const char *separator = "";
+	bool		useprefix;
+	ListCell   *lc;
+
+	/* Set up deparsing context */
+	context = set_deparse_context_planstate(es->deparse_cxt,
+											(Node *) rcstate,
+											ancestors);
+	useprefix = (list_length(es->rtable) > 1 || es->verbose);
+
+	initStringInfo(&keystr);
+	foreach(lc, plan->param_exprs)
+	{
+		Node	   *expr = (Node *) lfirst(lc);
+
+		appendStringInfoString(&keystr, separator);
+		appendStringInfoString(&keystr,
+							   deparse_expression(expr, context,
+												  useprefix, false));
+		separator = ", ";
+	}
+	ExplainPropertyText("Cache Key", keystr.data, es);
+	pfree(keystr.data);
+
+	if (!es->analyze)
+		return;
+
+	/* Nothing to show if the node was never run */
+	if (rcstate->stats.cache_hits > 0 || rcstate->stats.cache_misses > 0)
+	{
+		uint64		memPeak = Max(rcstate->stats.mem_peak,
+								  rcstate->mem_used);
+		long		memPeakKb = (memPeak + 1023) / 1024;
+
+		if (es->format != EXPLAIN_FORMAT_TEXT)
+		{
+			ExplainPropertyLong("Cache Hits",
+								(long) rcstate->stats.cache_hits, es);
+			ExplainPropertyLong("Cache Misses",
+								(long) rcstate->stats.cache_misses, es);
+			ExplainPropertyLong("Cache Evictions",
+								(long) rcstate->stats.cache_evictions, es);
+			ExplainPropertyLong("Cache Overflows",
+								(long) rcstate->stats.cache_overflows, es);
+			ExplainPropertyLong("Peak Memory Usage", memPeakKb, es);
+		}
+		else
+		{
+			appendStringInfoSpaces(es->str, es->indent * 2);
+			appendStringInfo(es->str,
+							 "Hits: " UINT64_FORMAT "  Misses: " UINT64_FORMAT
+							 "  Evictions: " UINT64_FORMAT
+							 "  Overflows: " UINT64_FORMAT
+							 "  Memory Usage: %ldkB\n",
+							 rcstate->stats.cache_hits,
+							 rcstate->stats.cache_misses,
+							 rcstate->stats.cache_evictions,
+							 rcstate->stats.cache_overflows,
+							 memPeakKb);
+		}
+	}
+}
+
 /*
  * If it's EXPLAIN ANALYZE, show exact/lossy pages for a BitmapHeapScan node
  */
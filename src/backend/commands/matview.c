@@ -14,6 +14,7 @@
  */
 #include "postgres.h"
 
+#include "access/heapbulk.h"
 #include "access/htup_details.h"
 #include "access/multixact.h"
 #include "access/xact.h"
@@ -52,6 +53,7 @@ typedef struct
 	CommandId	output_cid;		/* cmin to insert in output tuples */
 	int			hi_options;		/* heap_insert performance options */
 	BulkInsertState bistate;	/* bulk insert state */
+	HeapBulkWriteState bulkwrite;	/* bulk write state, if using that */
 } DR_transientrel;
 
 static int	matview_maintenance_depth = 0;
@@ -404,7 +406,7 @@ refresh_matview_datafill(DestReceiver *dest, Query *query,
 	CHECK_FOR_INTERRUPTS();
 
 	/* Plan the query which will generate data for the refresh. */
-	plan = pg_plan_query(query, 0, NULL);
+	plan = pg_plan_query(query, CURSOR_OPT_PARALLEL_OK, NULL);
 
 	/*
 	 * Use a snapshot with an updated command ID to ensure this query sees
@@ -478,7 +480,23 @@ transientrel_startup(DestReceiver *self, int operation, TupleDesc typeinfo)
 	myState->hi_options = HEAP_INSERT_SKIP_FSM | HEAP_INSERT_FROZEN;
 	if (!XLogIsNeeded())
 		myState->hi_options |= HEAP_INSERT_SKIP_WAL;
-	myState->bistate = GetBulkInsertState();
+
+	/*
+	 * Nobody else can be inserting into the new heap, so we can usually build
+	 * its pages locally and bypass shared buffers.
+	 */
+	if (heap_can_bulk_write(transientrel))
+	{
+		myState->bistate = NULL;
+		myState->bulkwrite = begin_heap_bulk_write(transientrel,
+												   myState->output_cid,
+												   myState->hi_options);
+	}
+	else
+	{
+		myState->bistate = GetBulkInsertState();
+		myState->bulkwrite = NULL;
+	}
 
 	/* Not using WAL requires smgr_targblock be initially invalid */
 	Assert(RelationGetTargetBlock(transientrel) == InvalidBlockNumber);
@@ -499,11 +517,14 @@ transientrel_receive(TupleTableSlot *slot, DestReceiver *self)
 	 */
 	tuple = ExecMaterializeSlot(slot);
 
-	heap_insert(myState->transientrel,
-				tuple,
-				myState->output_cid,
-				myState->hi_options,
-				myState->bistate);
+	if (myState->bulkwrite)
+		heap_bulk_write_tuples(myState->bulkwrite, &tuple, 1);
+	else
+		heap_insert(myState->transientrel,
+					tuple,
+					myState->output_cid,
+					myState->hi_options,
+					myState->bistate);
 
 	/* We know this is a newly created relation, so there are no indexes */
 
@@ -518,7 +539,10 @@ transientrel_shutdown(DestReceiver *self)
 {
 	DR_transientrel *myState = (DR_transientrel *) self;
 
-	FreeBulkInsertState(myState->bistate);
+	if (myState->bulkwrite)
+		end_heap_bulk_write(myState->bulkwrite);
+	else
+		FreeBulkInsertState(myState->bistate);
 
 	/* If we skipped using WAL, must heap_sync before commit */
 	if (myState->hi_options & HEAP_INSERT_SKIP_WAL)
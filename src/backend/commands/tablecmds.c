@@ -520,6 +520,7 @@ DefineRelation(CreateStmt *stmt, char relkind, Oid ownerId,
 	AttrNumber	attnum;
 	static char *validnsps[] = HEAP_RELOPT_NAMESPACES;
 	Oid			ofTypeId;
+	Oid			accessMethodId = InvalidOid;
 	ObjectAddress address;
 
 	/*
@@ -625,6 +626,21 @@ DefineRelation(CreateStmt *stmt, char relkind, Oid ownerId,
 	else
 		ofTypeId = InvalidOid;
 
+	/*
+	 * Look up the table access method, if one was given.  Without a USING
+	 * clause, the table gets the heap AM.
+	 */
+	if (stmt->accessMethod != NULL)
+	{
+		if (relkind == RELKIND_PARTITIONED_TABLE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("specifying a table access method is not supported on a partitioned table")));
+		Assert(RELKIND_HAS_TABLE_AM(relkind));
+
+		accessMethodId = get_table_am_oid(stmt->accessMethod, false);
+	}
+
 	/*
 	 * Look up inheritance ancestors and generate relation schema, including
 	 * inherited attributes.  (Note that stmt->tableElts is destructively
@@ -739,6 +755,7 @@ DefineRelation(CreateStmt *stmt, char relkind, Oid ownerId,
 													  old_constraints),
 										  relkind,
 										  stmt->relation->relpersistence,
+										  accessMethodId,
 										  false,
 										  false,
 										  localHasOids,
@@ -47,6 +47,12 @@
 #include "utils/typcache.h"
 
 
+/*
+ * Smallest constant array for which "scalar op ANY (array)" is evaluated
+ * with a hash table rather than a linear search.
+ */
+#define MIN_ARRAY_SIZE_FOR_HASHED_SAOP	9
+
 typedef struct LastAttnumInfo
 {
 	AttrNumber	last_inner;
@@ -58,6 +64,7 @@ static void ExecReadyExpr(ExprState *state);
 static void ExecInitExprRec(Expr *node, PlanState *parent, ExprState *state,
 				Datum *resv, bool *resnull);
 static void ExprEvalPushStep(ExprState *es, const ExprEvalStep *s);
+static bool saop_array_is_hashable(ScalarArrayOpExpr *opexpr, Expr *arrayarg);
 static void ExecInitFunc(ExprEvalStep *scratch, Expr *node, List *args,
 			 Oid funcid, Oid inputcollid, PlanState *parent,
 			 ExprState *state);
@@ -907,6 +914,44 @@ ExecInitExprRec(Expr *node, PlanState *parent, ExprState *state,
 				 */
 				ExecInitExprRec(arrayarg, parent, state, resv, resnull);
 
+				/*
+				 * For "scalar op ANY (const array)" with a large array, look
+				 * the scalar up in a hash table of the array's elements,
+				 * instead of comparing it with each element in turn.  That
+				 * needs the operator to be hashable, with the same hash
+				 * function on both sides, and strict, so that a NULL element
+				 * can only make the result NULL.
+				 */
+				if (opexpr->useOr && saop_array_is_hashable(opexpr, arrayarg))
+				{
+					FmgrInfo   *hash_finfo;
+					FunctionCallInfo hash_fcinfo;
+					Oid			lhash_func;
+					Oid			rhash_func;
+
+					if (!get_op_hash_functions(opexpr->opno,
+											   &lhash_func, &rhash_func))
+						elog(ERROR, "could not find hash function for hash operator %u",
+							 opexpr->opno);
+					Assert(lhash_func == rhash_func);
+
+					hash_finfo = palloc0(sizeof(FmgrInfo));
+					hash_fcinfo = palloc0(sizeof(FunctionCallInfoData));
+					fmgr_info(lhash_func, hash_finfo);
+					fmgr_info_set_expr((Node *) node, hash_finfo);
+					InitFunctionCallInfoData(*hash_fcinfo, hash_finfo, 1,
+											 opexpr->inputcollid, NULL, NULL);
+
+					scratch.opcode = EEOP_HASHED_SCALARARRAYOP;
+					scratch.d.hashedscalararrayop.has_nulls = false;
+					scratch.d.hashedscalararrayop.elements_tab = NULL;
+					scratch.d.hashedscalararrayop.finfo = finfo;
+					scratch.d.hashedscalararrayop.fcinfo_data = fcinfo;
+					scratch.d.hashedscalararrayop.hash_fcinfo_data = hash_fcinfo;
+					ExprEvalPushStep(state, &scratch);
+					break;
+				}
+
 				/* And perform the operation */
 				scratch.opcode = EEOP_SCALARARRAYOP;
 				scratch.d.scalararrayop.element_type = InvalidOid;
@@ -2057,6 +2102,42 @@ ExprEvalPushStep(ExprState *es, const ExprEvalStep *s)
 	memcpy(&es->steps[es->steps_len++], s, sizeof(ExprEvalStep));
 }
 
+/*
+ * Should "scalar op ANY (arrayarg)" be evaluated with a hash table?
+ *
+ * The array must be a non-null constant with enough elements for building
+ * the table to pay off, and the operator must be strict and hashable, with
+ * the same hash function for both input types.
+ */
+static bool
+saop_array_is_hashable(ScalarArrayOpExpr *opexpr, Expr *arrayarg)
+{
+	Const	   *arrayconst;
+	ArrayType  *arr;
+	Oid			lhash_func;
+	Oid			rhash_func;
+
+	if (!IsA(arrayarg, Const))
+		return false;
+	arrayconst = (Const *) arrayarg;
+	if (arrayconst->constisnull)
+		return false;
+
+	arr = DatumGetArrayTypeP(arrayconst->constvalue);
+	if (ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr)) <
+		MIN_ARRAY_SIZE_FOR_HASHED_SAOP)
+		return false;
+
+	if (!func_strict(opexpr->opfuncid))
+		return false;
+
+	if (!get_op_hash_functions(opexpr->opno, &lhash_func, &rhash_func) ||
+		lhash_func != rhash_func)
+		return false;
+
+	return true;
+}
+
 /*
  * Perform setup necessary for the evaluation of a function-like expression,
  * appending argument evaluation steps to the steps list in *state, and
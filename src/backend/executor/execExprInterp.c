@@ -357,6 +357,7 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 		&&CASE_EEOP_DOMAIN_CHECK,
 		&&CASE_EEOP_CONVERT_ROWTYPE,
 		&&CASE_EEOP_SCALARARRAYOP,
+		&&CASE_EEOP_HASHED_SCALARARRAYOP,
 		&&CASE_EEOP_XMLEXPR,
 		&&CASE_EEOP_AGGREF,
 		&&CASE_EEOP_GROUPING_FUNC,
@@ -1427,6 +1428,14 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 			EEO_NEXT();
 		}
 
+		EEO_CASE(EEOP_HASHED_SCALARARRAYOP)
+		{
+			/* too complex for an inline implementation */
+			ExecEvalHashedScalarArrayOp(state, op, econtext);
+
+			EEO_NEXT();
+		}
+
 		EEO_CASE(EEOP_DOMAIN_NOTNULL)
 		{
 			/* too complex for an inline implementation */
@@ -3041,6 +3050,202 @@ ExecEvalScalarArrayOp(ExprState *state, ExprEvalStep *op)
 	*op->resnull = resultnull;
 }
 
+/*
+ * Hash table of the elements of the constant array of a hashed
+ * "scalar op ANY (array)" expression.
+ */
+typedef struct ScalarArrayOpExprHashEntry
+{
+	Datum		key;
+	uint32		status;			/* hash status */
+	uint32		hash;			/* hash value (cached) */
+} ScalarArrayOpExprHashEntry;
+
+typedef struct ScalarArrayOpExprHashTable
+{
+	struct saophash_hash *hashtab;	/* underlying hash table */
+	ExprEvalStep *op;			/* the step that owns the table */
+} ScalarArrayOpExprHashTable;
+
+static uint32 saop_element_hash(struct saophash_hash *tb, Datum key);
+static bool saop_hash_element_match(struct saophash_hash *tb, Datum key1,
+						Datum key2);
+
+#define SH_PREFIX saophash
+#define SH_ELEMENT_TYPE ScalarArrayOpExprHashEntry
+#define SH_KEY_TYPE Datum
+#define SH_KEY key
+#define SH_HASH_KEY(tb, key) saop_element_hash(tb, key)
+#define SH_EQUAL(tb, a, b) saop_hash_element_match(tb, a, b)
+#define SH_SCOPE static inline
+#define SH_STORE_HASH
+#define SH_GET_HASH(tb, a) a->hash
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+/*
+ * Hash an array element, or the scalar being looked up, with the hash
+ * function of the operator's hash opfamily.
+ */
+static uint32
+saop_element_hash(struct saophash_hash *tb, Datum key)
+{
+	ScalarArrayOpExprHashTable *elements_tab =
+	(ScalarArrayOpExprHashTable *) tb->private_data;
+	FunctionCallInfo fcinfo = elements_tab->op->d.hashedscalararrayop.hash_fcinfo_data;
+	Datum		hash;
+
+	fcinfo->arg[0] = key;
+	fcinfo->argnull[0] = false;
+	fcinfo->isnull = false;
+
+	hash = FunctionCallInvoke(fcinfo);
+
+	return DatumGetUInt32(hash);
+}
+
+/*
+ * Does the scalar (or array element) key2 match the element key1 that is
+ * already in the table?  The operator is called with the scalar on the left.
+ */
+static bool
+saop_hash_element_match(struct saophash_hash *tb, Datum key1, Datum key2)
+{
+	ScalarArrayOpExprHashTable *elements_tab =
+	(ScalarArrayOpExprHashTable *) tb->private_data;
+	FunctionCallInfo fcinfo = elements_tab->op->d.hashedscalararrayop.fcinfo_data;
+	Datum		result;
+
+	fcinfo->arg[0] = key2;
+	fcinfo->argnull[0] = false;
+	fcinfo->arg[1] = key1;
+	fcinfo->argnull[1] = false;
+	fcinfo->isnull = false;
+
+	result = FunctionCallInvoke(fcinfo);
+
+	return DatumGetBool(result);
+}
+
+/*
+ * Evaluate "scalar op ANY (const array)" by looking the scalar up in a hash
+ * table of the array's elements.
+ *
+ * ExecInitExprRec only uses this for a large, non-null constant array and a
+ * strict, hashable operator.  The hash table is built the first time we get
+ * here, and lasts as long as the expression does.  As for
+ * ExecEvalScalarArrayOp, the array has been evaluated into our result
+ * variable, and the scalar into the operator's first argument.
+ */
+void
+ExecEvalHashedScalarArrayOp(ExprState *state, ExprEvalStep *op,
+							ExprContext *econtext)
+{
+	ScalarArrayOpExprHashTable *elements_tab = op->d.hashedscalararrayop.elements_tab;
+	FunctionCallInfo fcinfo = op->d.hashedscalararrayop.fcinfo_data;
+	Datum		scalar = fcinfo->arg[0];
+	bool		scalar_isnull = fcinfo->argnull[0];
+	bool		hashfound;
+
+	/* We don't hash a NULL array */
+	Assert(!*op->resnull);
+
+	/* The operator is strict, so a NULL scalar yields NULL */
+	if (scalar_isnull)
+	{
+		*op->resnull = true;
+		return;
+	}
+
+	/* Build the hash table on first evaluation */
+	if (elements_tab == NULL)
+	{
+		MemoryContext oldcontext;
+		ArrayType  *arr;
+		int			nitems;
+		int16		typlen;
+		bool		typbyval;
+		char		typalign;
+		bool		has_nulls = false;
+		char	   *s;
+		bits8	   *bitmap;
+		int			bitmask;
+		int			i;
+
+		/*
+		 * The table and any detoasted copy of the array, whose elements the
+		 * table points into, must live as long as the expression.
+		 */
+		oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_query_memory);
+
+		arr = DatumGetArrayTypeP(*op->resvalue);
+		nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+
+		get_typlenbyvalalign(ARR_ELEMTYPE(arr), &typlen, &typbyval, &typalign);
+
+		elements_tab = (ScalarArrayOpExprHashTable *)
+			palloc(sizeof(ScalarArrayOpExprHashTable));
+		op->d.hashedscalararrayop.elements_tab = elements_tab;
+		elements_tab->op = op;
+		elements_tab->hashtab = saophash_create(CurrentMemoryContext, nitems,
+												elements_tab);
+
+		s = (char *) ARR_DATA_PTR(arr);
+		bitmap = ARR_NULLBITMAP(arr);
+		bitmask = 1;
+
+		for (i = 0; i < nitems; i++)
+		{
+			/* Get array element, checking for NULL */
+			if (bitmap && (*bitmap & bitmask) == 0)
+				has_nulls = true;
+			else
+			{
+				Datum		element;
+
+				element = fetch_att(s, typbyval, typlen);
+				s = att_addlength_pointer(s, typlen, s);
+				s = (char *) att_align_nominal(s, typalign);
+
+				saophash_insert(elements_tab->hashtab, element, &hashfound);
+			}
+
+			/* advance bitmap pointer if any */
+			if (bitmap)
+			{
+				bitmask <<= 1;
+				if (bitmask == 0x100)
+				{
+					bitmap++;
+					bitmask = 1;
+				}
+			}
+		}
+
+		op->d.hashedscalararrayop.has_nulls = has_nulls;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	hashfound = (saophash_lookup(elements_tab->hashtab, scalar) != NULL);
+
+	/*
+	 * If there's no match but the array contains NULLs, the strict operator
+	 * would have returned NULL for those, so the result is NULL, not false.
+	 */
+	if (!hashfound && op->d.hashedscalararrayop.has_nulls)
+	{
+		*op->resvalue = (Datum) 0;
+		*op->resnull = true;
+	}
+	else
+	{
+		*op->resvalue = BoolGetDatum(hashfound);
+		*op->resnull = false;
+	}
+}
+
 /*
  * Evaluate a NOT NULL domain constraint.
  */
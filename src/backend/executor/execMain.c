@@ -1689,15 +1689,27 @@ ExecutePlan(EState *estate,
 
 	/*
 	 * If the plan might potentially be executed multiple times, we must force
-	 * it to run without parallelism, because we might exit early.  Also
-	 * disable parallelism when writing into a relation, because no database
-	 * changes are allowed in parallel mode.
+	 * it to run without parallelism, because we might exit early.
 	 */
-	if (!execute_once || dest->mydest == DestIntoRel)
+	if (!execute_once)
 		use_parallel_mode = false;
 
 	if (use_parallel_mode)
+	{
+		/*
+		 * The planner only allows a parallel plan for a query that writes
+		 * into a relation if the leader does all the inserting, which is
+		 * allowed in parallel mode as long as the current command ID has
+		 * already been marked used.  We must also assign a transaction ID
+		 * now, since that can't be done once the workers have started.
+		 */
+		if (operation != CMD_SELECT ||
+			dest->mydest == DestIntoRel ||
+			dest->mydest == DestTransientRel)
+			(void) GetCurrentTransactionId();
+
 		EnterParallelMode();
+	}
 
 	/*
 	 * Loop until we've processed the proper number of tuples from the plan.
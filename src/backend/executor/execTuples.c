@@ -854,6 +854,54 @@ ExecInitExtraTupleSlot(EState *estate)
 	return ExecAllocTableSlot(&estate->es_tupleTable);
 }
 
+/* ----------------
+ *		ExecInitTupleBatch
+ *
+ * Build an empty batch of up to maxslots tuples of the given type.
+ * ----------------
+ */
+TupleBatch *
+ExecInitTupleBatch(EState *estate, TupleDesc tupdesc, int maxslots)
+{
+	TupleBatch *batch = (TupleBatch *) palloc(sizeof(TupleBatch));
+	int			i;
+
+	Assert(maxslots > 0);
+
+	batch->maxslots = maxslots;
+	batch->nslots = 0;
+	batch->next = 0;
+	batch->slots = (TupleTableSlot **)
+		palloc(maxslots * sizeof(TupleTableSlot *));
+	for (i = 0; i < maxslots; i++)
+	{
+		batch->slots[i] = ExecInitExtraTupleSlot(estate);
+		ExecSetSlotDescriptor(batch->slots[i], tupdesc);
+	}
+
+	return batch;
+}
+
+/* ----------------
+ *		ExecClearTupleBatch
+ *
+ * Empty a batch, releasing any buffer pins held by its slots.
+ * ----------------
+ */
+void
+ExecClearTupleBatch(TupleBatch *batch)
+{
+	int			i;
+
+	for (i = 0; i < batch->maxslots; i++)
+	{
+		if (!TupIsNull(batch->slots[i]))
+			ExecClearTuple(batch->slots[i]);
+	}
+	batch->nslots = 0;
+	batch->next = 0;
+}
+
 /* ----------------
  *		ExecInitNullTupleSlot
  *
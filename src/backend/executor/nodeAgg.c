@@ -213,6 +213,7 @@
 #include "catalog/pg_type.h"
 #include "executor/executor.h"
 #include "executor/nodeAgg.h"
+#include "executor/nodeSeqscan.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
@@ -229,6 +230,12 @@
 #include "utils/datum.h"
 
 
+/*
+ * Number of input tuples fetched at a time from a sequential scan below us,
+ * see ExecSeqScanBatch.
+ */
+#define AGG_INPUT_BATCH_SIZE	64
+
 /*
  * AggStatePerTransData - per aggregate state value information
  *
@@ -655,7 +662,7 @@ initialize_phase(AggState *aggstate, int newphase)
 												  sortnode->collations,
 												  sortnode->nullsFirst,
 												  work_mem,
-												  false);
+												  NULL, false);
 	}
 
 	aggstate->current_phase = newphase;
@@ -684,6 +691,16 @@ fetch_input_tuple(AggState *aggstate)
 			return NULL;
 		slot = aggstate->sort_slot;
 	}
+	else if (aggstate->input_batch)
+	{
+		TupleBatch *batch = aggstate->input_batch;
+
+		if (batch->next >= batch->nslots &&
+			ExecSeqScanBatch(castNode(SeqScanState, outerPlanState(aggstate)),
+							 batch) == 0)
+			return NULL;
+		slot = batch->slots[batch->next++];
+	}
 	else
 		slot = ExecProcNode(outerPlanState(aggstate));
 
@@ -729,7 +746,7 @@ initialize_aggregate(AggState *aggstate, AggStatePerTrans pertrans,
 									  pertrans->sortOperators[0],
 									  pertrans->sortCollations[0],
 									  pertrans->sortNullsFirst[0],
-									  work_mem, false);
+									  work_mem, NULL, false);
 		else
 			pertrans->sortstates[aggstate->current_set] =
 				tuplesort_begin_heap(pertrans->sortdesc,
@@ -738,7 +755,7 @@ initialize_aggregate(AggState *aggstate, AggStatePerTrans pertrans,
 									 pertrans->sortOperators,
 									 pertrans->sortCollations,
 									 pertrans->sortNullsFirst,
-									 work_mem, false);
+									 work_mem, NULL, false);
 	}
 
 	/*
@@ -2821,6 +2838,17 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	outerPlan = outerPlan(node);
 	outerPlanState(aggstate) = ExecInitNode(outerPlan, estate, eflags);
 
+	/*
+	 * If the input comes straight from a sequential scan, fetch it in
+	 * batches.  That saves going through ExecProcNode and ExecScan for every
+	 * input tuple, which is a noticeable part of the cost of aggregating a
+	 * big table.
+	 */
+	if (IsA(outerPlanState(aggstate), SeqScanState))
+		aggstate->input_batch =
+			ExecSeqScanInitBatch((SeqScanState *) outerPlanState(aggstate),
+								 AGG_INPUT_BATCH_SIZE);
+
 	/*
 	 * initialize source tuple type.
 	 */
@@ -3883,6 +3911,8 @@ ExecEndAgg(AggState *node)
 
 	/* clean up tuple table */
 	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	if (node->input_batch)
+		ExecClearTupleBatch(node->input_batch);
 
 	outerPlan = outerPlanState(node);
 	ExecEndNode(outerPlan);
@@ -3962,6 +3992,8 @@ ExecReScanAgg(AggState *node)
 		node->grp_firstTuple = NULL;
 	}
 	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	if (node->input_batch)
+		ExecClearTupleBatch(node->input_batch);
 
 	/* Forget current agg values */
 	MemSet(econtext->ecxt_aggvalues, 0, sizeof(Datum) * node->numaggs);
@@ -179,8 +179,7 @@ ExecGather(PlanState *pstate)
 					shm_mq_set_handle(node->pei->tqueue[i],
 									  pcxt->worker[i].bgwhandle);
 					node->reader[node->nreaders++] =
-						CreateTupleQueueReader(node->pei->tqueue[i],
-											   fslot->tts_tupleDescriptor);
+						CreateTupleQueueReader(node->pei->tqueue[i]);
 				}
 			}
 			else
@@ -211,8 +211,7 @@ ExecGatherMerge(PlanState *pstate)
 					shm_mq_set_handle(node->pei->tqueue[i],
 									  pcxt->worker[i].bgwhandle);
 					node->reader[node->nreaders++] =
-						CreateTupleQueueReader(node->pei->tqueue[i],
-											   node->tupDesc);
+						CreateTupleQueueReader(node->pei->tqueue[i]);
 				}
 			}
 			else
@@ -38,6 +38,7 @@
 #include "postgres.h"
 
 #include "access/htup_details.h"
+#include "access/tableam.h"
 #include "access/xact.h"
 #include "commands/trigger.h"
 #include "executor/executor.h"
@@ -217,7 +218,8 @@ ExecCheckHeapTupleVisible(EState *estate,
 }
 
 /*
- * ExecCheckTIDVisible -- convenience variant of ExecCheckHeapTupleVisible()
+ * ExecCheckTIDVisible -- variant of ExecCheckHeapTupleVisible() for a tuple
+ * identified by TID, which goes through the table AM
  */
 static void
 ExecCheckTIDVisible(EState *estate,
@@ -225,18 +227,28 @@ ExecCheckTIDVisible(EState *estate,
 					ItemPointer tid)
 {
 	Relation	rel = relinfo->ri_RelationDesc;
-	Buffer		buffer;
-	HeapTupleData tuple;
+	TupleTableSlot *slot;
 
 	/* Redundantly check isolation level */
 	if (!IsolationUsesXactSnapshot())
 		return;
 
-	tuple.t_self = *tid;
-	if (!heap_fetch(rel, SnapshotAny, &tuple, &buffer, false, NULL))
+	slot = MakeSingleTupleTableSlot(RelationGetDescr(rel));
+	if (!table_fetch_row_version(rel, tid, SnapshotAny, slot))
 		elog(ERROR, "failed to fetch conflicting tuple for ON CONFLICT");
-	ExecCheckHeapTupleVisible(estate, &tuple, buffer);
-	ReleaseBuffer(buffer);
+
+	if (!table_tuple_satisfies_snapshot(rel, slot, estate->es_snapshot))
+	{
+		HeapTuple	tuple = ExecMaterializeSlot(slot);
+
+		/* As above, a tuple inserted by our own transaction is OK. */
+		if (!TransactionIdIsCurrentTransactionId(HeapTupleHeaderGetXmin(tuple->t_data)))
+			ereport(ERROR,
+					(errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
+					 errmsg("could not serialize access due to concurrent update")));
+	}
+
+	ExecDropSingleTupleTableSlot(slot);
 }
 
 /* ----------------------------------------------------------------
@@ -595,12 +607,12 @@ ExecInsert(ModifyTableState *mtstate,
 			/*
 			 * insert the tuple normally.
 			 *
-			 * Note: heap_insert returns the tid (location) of the new tuple
+			 * Note: table_insert returns the tid (location) of the new tuple
 			 * in the t_self field.
 			 */
-			newId = heap_insert(resultRelationDesc, tuple,
-								estate->es_output_cid,
-								0, NULL);
+			newId = table_insert(resultRelationDesc, tuple,
+								 estate->es_output_cid,
+								 0, NULL);
 
 			/* insert index entries for tuple */
 			if (resultRelInfo->ri_NumIndices > 0)
@@ -756,11 +768,11 @@ ExecDelete(ModifyTableState *mtstate,
 		 * mode transactions.
 		 */
 ldelete:;
-		result = heap_delete(resultRelationDesc, tupleid,
-							 estate->es_output_cid,
-							 estate->es_crosscheck_snapshot,
-							 true /* wait for commit */ ,
-							 &hufd);
+		result = table_delete(resultRelationDesc, tupleid,
+							  estate->es_output_cid,
+							  estate->es_crosscheck_snapshot,
+							  true /* wait for commit */ ,
+							  &hufd);
 		switch (result)
 		{
 			case HeapTupleSelfUpdated:
@@ -827,7 +839,7 @@ ldelete:;
 				return NULL;
 
 			default:
-				elog(ERROR, "unrecognized heap_delete status: %u", result);
+				elog(ERROR, "unrecognized table_delete status: %u", result);
 				return NULL;
 		}
 
@@ -856,34 +868,23 @@ ldelete:;
 		 * gotta fetch it.  We can use the trigger tuple slot.
 		 */
 		TupleTableSlot *rslot;
-		HeapTupleData deltuple;
-		Buffer		delbuffer;
 
 		if (resultRelInfo->ri_FdwRoutine)
 		{
 			/* FDW must have provided a slot containing the deleted row */
 			Assert(!TupIsNull(slot));
-			delbuffer = InvalidBuffer;
 		}
 		else
 		{
 			slot = estate->es_trig_tuple_slot;
-			if (oldtuple != NULL)
-			{
-				deltuple = *oldtuple;
-				delbuffer = InvalidBuffer;
-			}
-			else
-			{
-				deltuple.t_self = *tupleid;
-				if (!heap_fetch(resultRelationDesc, SnapshotAny,
-								&deltuple, &delbuffer, false, NULL))
-					elog(ERROR, "failed to fetch deleted tuple for DELETE RETURNING");
-			}
-
 			if (slot->tts_tupleDescriptor != RelationGetDescr(resultRelationDesc))
 				ExecSetSlotDescriptor(slot, RelationGetDescr(resultRelationDesc));
-			ExecStoreTuple(&deltuple, slot, InvalidBuffer, false);
+
+			if (oldtuple != NULL)
+				ExecStoreTuple(oldtuple, slot, InvalidBuffer, false);
+			else if (!table_fetch_row_version(resultRelationDesc, tupleid,
+											  SnapshotAny, slot))
+				elog(ERROR, "failed to fetch deleted tuple for DELETE RETURNING");
 		}
 
 		rslot = ExecProcessReturning(resultRelInfo, slot, planSlot);
@@ -895,8 +896,6 @@ ldelete:;
 		ExecMaterializeSlot(rslot);
 
 		ExecClearTuple(slot);
-		if (BufferIsValid(delbuffer))
-			ReleaseBuffer(delbuffer);
 
 		return rslot;
 	}
@@ -1054,11 +1053,11 @@ lreplace:;
 		 * needed for referential integrity updates in transaction-snapshot
 		 * mode transactions.
 		 */
-		result = heap_update(resultRelationDesc, tupleid, tuple,
-							 estate->es_output_cid,
-							 estate->es_crosscheck_snapshot,
-							 true /* wait for commit */ ,
-							 &hufd, &lockmode);
+		result = table_update(resultRelationDesc, tupleid, tuple,
+							  estate->es_output_cid,
+							  estate->es_crosscheck_snapshot,
+							  true /* wait for commit */ ,
+							  &hufd, &lockmode);
 		switch (result)
 		{
 			case HeapTupleSelfUpdated:
@@ -1126,7 +1125,7 @@ lreplace:;
 				return NULL;
 
 			default:
-				elog(ERROR, "unrecognized heap_update status: %u", result);
+				elog(ERROR, "unrecognized table_update status: %u", result);
 				return NULL;
 		}
 
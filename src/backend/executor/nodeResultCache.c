@@ -0,0 +1,790 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeResultCache.c
+ *	  Routines to handle caching of results from parameterized nodes
+ *
+ * A result cache sits on the inner side of a parameterized nested loop and
+ * remembers the rows its subplan returned for each set of parameter values
+ * (the cache keys).  When it's rescanned with values that were seen before,
+ * the rows are returned from the cache and the subplan isn't run at all.
+ *
+ * The cache is a hash table keyed on the parameter values.  Each entry holds
+ * a list of the cached rows, and a flag saying whether the subplan was run
+ * to completion; an entry whose scan was abandoned partway through can't be
+ * used.  Entries are kept in a least-recently-used list, and when the cache
+ * uses more than work_mem the oldest ones are evicted.  If the rows for a
+ * single set of parameters don't fit in work_mem by themselves, the rest of
+ * that scan just passes the subplan's rows through without caching them.
+ *
+ * Any change to a parameter the subplan uses that isn't one of the cache
+ * keys makes everything in the cache stale, so the whole cache is thrown
+ * away when that happens.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeResultCache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+/*
+ * INTERFACE ROUTINES
+ *		ExecResultCache			- lookup the cache, or run the subplan
+ *		ExecInitResultCache		- initialize node and subnodes
+ *		ExecEndResultCache		- shutdown node and subnodes
+ *		ExecReScanResultCache	- rescan the result cache
+ *		ExecEstimateCacheEntryOverheadBytes - for the planner's costing
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "executor/executor.h"
+#include "executor/nodeResultCache.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "utils/memutils.h"
+
+/* States of the ExecResultCache state machine */
+#define RC_CACHE_LOOKUP				1	/* look up the cache for a new scan */
+#define RC_CACHE_FETCH_NEXT_TUPLE	2	/* return the next cached tuple */
+#define RC_FILLING_CACHE			3	/* read the subplan into the cache */
+#define RC_CACHE_BYPASS_MODE		4	/* read the subplan, without caching */
+#define RC_END_OF_SCAN				5	/* this scan is done */
+
+/* A tuple in a cache entry's list of tuples */
+typedef struct ResultCacheTuple
+{
+	MinimalTuple mintuple;		/* the cached tuple */
+	struct ResultCacheTuple *next;	/* next tuple of the entry, or NULL */
+} ResultCacheTuple;
+
+/* The key of a cache entry; palloc'd, as hash table entries move around */
+typedef struct ResultCacheKey
+{
+	MinimalTuple params;		/* the cache key values */
+	dlist_node	lru_node;		/* position in the LRU list */
+} ResultCacheKey;
+
+/* A hash table entry */
+typedef struct ResultCacheEntry
+{
+	ResultCacheKey *key;		/* hash key; NULL only while probing */
+	ResultCacheTuple *tuplehead;	/* first cached tuple, or NULL */
+	uint32		hash;			/* hash value (cached) */
+	char		status;			/* hash status */
+	bool		complete;		/* did we read the subplan to the end? */
+} ResultCacheEntry;
+
+/* Memory charged for an entry, its key, and for a cached tuple */
+#define EMPTY_ENTRY_MEMORY_BYTES(e)		(sizeof(ResultCacheEntry) + \
+										 sizeof(ResultCacheKey) + \
+										 (e)->key->params->t_len)
+#define CACHE_TUPLE_BYTES(t)			(sizeof(ResultCacheTuple) + \
+										 (t)->mintuple->t_len)
+
+static uint32 ResultCacheHash_hash(struct resultcache_hash *tb,
+					 const ResultCacheKey *key);
+static bool ResultCacheHash_equal(struct resultcache_hash *tb,
+					  const ResultCacheKey *key1,
+					  const ResultCacheKey *key2);
+
+#define SH_PREFIX resultcache
+#define SH_ELEMENT_TYPE ResultCacheEntry
+#define SH_KEY_TYPE ResultCacheKey *
+#define SH_KEY key
+#define SH_HASH_KEY(tb, key) ResultCacheHash_hash(tb, key)
+#define SH_EQUAL(tb, a, b) ResultCacheHash_equal(tb, a, b)
+#define SH_SCOPE static inline
+#define SH_STORE_HASH
+#define SH_GET_HASH(tb, a) a->hash
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+
+/*
+ * ResultCacheHash_hash
+ *		Hash the cache key values of key, or those in the probe slot if key
+ *		is NULL.
+ */
+static uint32
+ResultCacheHash_hash(struct resultcache_hash *tb, const ResultCacheKey *key)
+{
+	ResultCacheState *rcstate = (ResultCacheState *) tb->private_data;
+	TupleTableSlot *slot;
+	MemoryContext oldcontext;
+	uint32		hashkey = 0;
+	int			i;
+
+	if (key == NULL)
+		slot = rcstate->probeslot;
+	else
+	{
+		slot = rcstate->tableslot;
+		ExecStoreMinimalTuple(key->params, slot, false);
+	}
+
+	MemoryContextReset(rcstate->tempContext);
+	oldcontext = MemoryContextSwitchTo(rcstate->tempContext);
+
+	for (i = 0; i < rcstate->nkeys; i++)
+	{
+		Datum		attr;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		attr = slot_getattr(slot, i + 1, &isNull);
+
+		if (!isNull)			/* treat nulls as having hash key 0 */
+		{
+			uint32		hkey;
+
+			hkey = DatumGetUInt32(FunctionCall1(&rcstate->hashfunctions[i],
+												attr));
+			hashkey ^= hkey;
+		}
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return hashkey;
+}
+
+/*
+ * ResultCacheHash_equal
+ *		Does the existing entry's key1 match key2?
+ *
+ * A NULL key2 stands for the values in the probe slot.  Otherwise key2 is
+ * the key of an existing entry, being looked up to find or delete that
+ * entry, and as keys are never duplicated, comparing pointers is enough.
+ */
+static bool
+ResultCacheHash_equal(struct resultcache_hash *tb, const ResultCacheKey *key1,
+					  const ResultCacheKey *key2)
+{
+	ResultCacheState *rcstate = (ResultCacheState *) tb->private_data;
+
+	Assert(key1 != NULL);
+
+	if (key2 != NULL)
+		return key1 == key2;
+
+	ExecStoreMinimalTuple(key1->params, rcstate->tableslot, false);
+
+	return execTuplesMatch(rcstate->probeslot, rcstate->tableslot,
+						   rcstate->nkeys, rcstate->keyColIdx,
+						   rcstate->eqfunctions, rcstate->tempContext);
+}
+
+/*
+ * build_hash_table
+ *		Create the cache's hash table, sized for the number of entries the
+ *		planner expected to fit.
+ */
+static void
+build_hash_table(ResultCacheState *rcstate, uint32 size)
+{
+	if (size == 0)
+		size = 1024;
+
+	rcstate->hashtable = resultcache_create(rcstate->tableContext, size,
+											rcstate);
+}
+
+/*
+ * prepare_probe_slot
+ *		Evaluate the cache keys for the current parameter values into the
+ *		probe slot.
+ *
+ * The values live in the node's per-tuple memory, which nothing else uses,
+ * so they stay valid until the next call.
+ */
+static void
+prepare_probe_slot(ResultCacheState *rcstate)
+{
+	TupleTableSlot *pslot = rcstate->probeslot;
+	ExprContext *econtext = rcstate->ss.ps.ps_ExprContext;
+	ListCell   *lc;
+	int			i = 0;
+
+	ResetExprContext(econtext);
+	ExecClearTuple(pslot);
+
+	foreach(lc, rcstate->param_exprs)
+	{
+		ExprState  *param_expr = (ExprState *) lfirst(lc);
+
+		pslot->tts_values[i] = ExecEvalExprSwitchContext(param_expr, econtext,
+														 &pslot->tts_isnull[i]);
+		i++;
+	}
+
+	ExecStoreVirtualTuple(pslot);
+}
+
+/*
+ * entry_purge_tuples
+ *		Free the cached tuples of entry, and mark it incomplete.
+ */
+static void
+entry_purge_tuples(ResultCacheState *rcstate, ResultCacheEntry *entry)
+{
+	ResultCacheTuple *tuple = entry->tuplehead;
+	uint64		freed_mem = 0;
+
+	while (tuple != NULL)
+	{
+		ResultCacheTuple *next = tuple->next;
+
+		freed_mem += CACHE_TUPLE_BYTES(tuple);
+
+		pfree(tuple->mintuple);
+		pfree(tuple);
+
+		tuple = next;
+	}
+
+	entry->complete = false;
+	entry->tuplehead = NULL;
+
+	rcstate->mem_used -= freed_mem;
+}
+
+/*
+ * remove_cache_entry
+ *		Remove the entry with the given key from the cache, and free it.
+ */
+static void
+remove_cache_entry(ResultCacheState *rcstate, ResultCacheKey *key)
+{
+	ResultCacheEntry *entry;
+
+	entry = resultcache_lookup(rcstate->hashtable, key);
+	Assert(entry != NULL);
+
+	entry_purge_tuples(rcstate, entry);
+	rcstate->mem_used -= EMPTY_ENTRY_MEMORY_BYTES(entry);
+
+	dlist_delete(&key->lru_node);
+	resultcache_delete(rcstate->hashtable, key);
+
+	pfree(key->params);
+	pfree(key);
+}
+
+/*
+ * cache_reduce_memory
+ *		Evict the least recently used entries until the cache fits within
+ *		its memory limit again.
+ *
+ * Returns false if that meant evicting the entry with key specialkey, which
+ * the caller is working on; true otherwise.  As removing entries moves others
+ * around in the hash table, the caller must look up its entry again.
+ */
+static bool
+cache_reduce_memory(ResultCacheState *rcstate, ResultCacheKey *specialkey)
+{
+	bool		specialkey_intact = true;
+	uint64		evictions = 0;
+	dlist_mutable_iter iter;
+
+	/* Update the peak memory usage before we start freeing anything */
+	if (rcstate->mem_used > rcstate->stats.mem_peak)
+		rcstate->stats.mem_peak = rcstate->mem_used;
+
+	dlist_foreach_modify(iter, &rcstate->lru_list)
+	{
+		ResultCacheKey *key = dlist_container(ResultCacheKey, lru_node,
+											  iter.cur);
+
+		if (key == specialkey)
+			specialkey_intact = false;
+
+		remove_cache_entry(rcstate, key);
+		evictions++;
+
+		if (rcstate->mem_used <= rcstate->mem_limit)
+			break;
+	}
+
+	rcstate->stats.cache_evictions += evictions;
+
+	return specialkey_intact;
+}
+
+/*
+ * cache_lookup
+ *		Find the cache entry for the values in the probe slot, or make a new,
+ *		empty one.  *found says which.
+ *
+ * Returns NULL if a new entry doesn't fit in the cache at all.
+ */
+static ResultCacheEntry *
+cache_lookup(ResultCacheState *rcstate, bool *found)
+{
+	ResultCacheKey *key;
+	ResultCacheEntry *entry;
+	MemoryContext oldcontext;
+
+	entry = resultcache_insert(rcstate->hashtable, NULL, found);
+
+	if (*found)
+	{
+		/* Move it to the end of the LRU list, as it's now the most recent */
+		dlist_delete(&entry->key->lru_node);
+		dlist_push_tail(&rcstate->lru_list, &entry->key->lru_node);
+		return entry;
+	}
+
+	oldcontext = MemoryContextSwitchTo(rcstate->tableContext);
+
+	key = (ResultCacheKey *) palloc(sizeof(ResultCacheKey));
+	key->params = ExecCopySlotMinimalTuple(rcstate->probeslot);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	entry->key = key;
+	entry->tuplehead = NULL;
+	entry->complete = false;
+
+	dlist_push_tail(&rcstate->lru_list, &key->lru_node);
+	rcstate->mem_used += EMPTY_ENTRY_MEMORY_BYTES(entry);
+
+	if (rcstate->mem_used > rcstate->mem_limit)
+	{
+		if (!cache_reduce_memory(rcstate, key))
+			return NULL;
+
+		entry = resultcache_lookup(rcstate->hashtable, key);
+		Assert(entry != NULL);
+	}
+
+	return entry;
+}
+
+/*
+ * cache_store_tuple
+ *		Add the tuple in slot to the end of the current entry's tuples.
+ *
+ * Returns false if there was no room for it, even after evicting every other
+ * entry; the current entry is gone then, and rcstate->entry is NULL.
+ */
+static bool
+cache_store_tuple(ResultCacheState *rcstate, TupleTableSlot *slot)
+{
+	ResultCacheEntry *entry = rcstate->entry;
+	ResultCacheTuple *tuple;
+	MemoryContext oldcontext;
+
+	Assert(entry != NULL);
+
+	oldcontext = MemoryContextSwitchTo(rcstate->tableContext);
+
+	tuple = (ResultCacheTuple *) palloc(sizeof(ResultCacheTuple));
+	tuple->mintuple = ExecCopySlotMinimalTuple(slot);
+	tuple->next = NULL;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	rcstate->mem_used += CACHE_TUPLE_BYTES(tuple);
+
+	if (entry->tuplehead == NULL)
+		entry->tuplehead = tuple;
+	else
+		rcstate->last_tuple->next = tuple;
+	rcstate->last_tuple = tuple;
+
+	if (rcstate->mem_used > rcstate->mem_limit)
+	{
+		ResultCacheKey *key = entry->key;
+
+		if (!cache_reduce_memory(rcstate, key))
+		{
+			rcstate->entry = NULL;
+			rcstate->last_tuple = NULL;
+			return false;
+		}
+
+		rcstate->entry = resultcache_lookup(rcstate->hashtable, key);
+		Assert(rcstate->entry != NULL);
+	}
+
+	return true;
+}
+
+/*
+ * collect_paramids_walker
+ *		Collect the ids of the PARAM_EXEC Params in an expression tree.
+ */
+static bool
+collect_paramids_walker(Node *node, Bitmapset **paramids)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *) node;
+
+		if (param->paramkind == PARAM_EXEC)
+			*paramids = bms_add_member(*paramids, param->paramid);
+		return false;
+	}
+	return expression_tree_walker(node, collect_paramids_walker,
+								  (void *) paramids);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecResultCache
+ *
+ *		At the start of each scan, look up the cache for the current
+ *		parameter values.  If there's a complete entry, return its rows;
+ *		otherwise return the subplan's rows, adding them to the cache as we
+ *		go.
+ * ----------------------------------------------------------------
+ */
+static TupleTableSlot *
+ExecResultCache(PlanState *pstate)
+{
+	ResultCacheState *node = castNode(ResultCacheState, pstate);
+	PlanState  *outerNode;
+	TupleTableSlot *slot;
+
+	CHECK_FOR_INTERRUPTS();
+
+	switch (node->rc_status)
+	{
+		case RC_CACHE_LOOKUP:
+			{
+				ResultCacheEntry *entry;
+				TupleTableSlot *outerslot;
+				bool		found;
+
+				Assert(node->entry == NULL);
+
+				/* Build the hash table on first use */
+				if (node->hashtable == NULL)
+					build_hash_table(node,
+									 ((ResultCache *) node->ss.ps.plan)->est_entries);
+
+				prepare_probe_slot(node);
+				entry = cache_lookup(node, &found);
+
+				if (found && entry->complete)
+				{
+					node->stats.cache_hits += 1;
+
+					node->entry = entry;
+					node->last_tuple = entry->tuplehead;
+
+					if (entry->tuplehead == NULL)
+					{
+						/* The subplan returned no rows for these values */
+						node->rc_status = RC_END_OF_SCAN;
+						return NULL;
+					}
+
+					node->rc_status = RC_CACHE_FETCH_NEXT_TUPLE;
+
+					slot = node->ss.ps.ps_ResultTupleSlot;
+					ExecStoreMinimalTuple(entry->tuplehead->mintuple, slot,
+										  false);
+					return slot;
+				}
+
+				node->stats.cache_misses += 1;
+
+				/* An incomplete entry is no use; start it over */
+				if (found)
+					entry_purge_tuples(node, entry);
+
+				outerNode = outerPlanState(node);
+				outerslot = ExecProcNode(outerNode);
+				if (TupIsNull(outerslot))
+				{
+					/* Remember that there are no rows for these values */
+					if (entry != NULL)
+						entry->complete = true;
+
+					node->rc_status = RC_END_OF_SCAN;
+					return NULL;
+				}
+
+				node->entry = entry;
+				node->last_tuple = NULL;
+
+				if (entry == NULL || !cache_store_tuple(node, outerslot))
+				{
+					/* Couldn't make room; just pass the rows through */
+					node->stats.cache_overflows += 1;
+					node->rc_status = RC_CACHE_BYPASS_MODE;
+				}
+				else
+				{
+					/*
+					 * If the parent only ever fetches one row, the entry is
+					 * complete already.  This lets the cache be used even
+					 * though the subplan is never read to the end.
+					 */
+					node->entry->complete = node->singlerow;
+					node->rc_status = RC_FILLING_CACHE;
+				}
+
+				return outerslot;
+			}
+
+		case RC_CACHE_FETCH_NEXT_TUPLE:
+			{
+				Assert(node->entry != NULL);
+				Assert(node->last_tuple != NULL);
+
+				node->last_tuple = node->last_tuple->next;
+				if (node->last_tuple == NULL)
+				{
+					node->rc_status = RC_END_OF_SCAN;
+					return NULL;
+				}
+
+				slot = node->ss.ps.ps_ResultTupleSlot;
+				ExecStoreMinimalTuple(node->last_tuple->mintuple, slot, false);
+				return slot;
+			}
+
+		case RC_FILLING_CACHE:
+			{
+				TupleTableSlot *outerslot;
+				ResultCacheEntry *entry = node->entry;
+
+				Assert(entry != NULL);
+				Assert(node->last_tuple != NULL);
+
+				outerNode = outerPlanState(node);
+				outerslot = ExecProcNode(outerNode);
+				if (TupIsNull(outerslot))
+				{
+					/* We've got all the rows; the entry can be used now */
+					entry->complete = true;
+					node->rc_status = RC_END_OF_SCAN;
+					return NULL;
+				}
+
+				/* Check that the planner was right to set singlerow */
+				if (entry->complete)
+					elog(ERROR, "result cache entry already complete");
+
+				if (!cache_store_tuple(node, outerslot))
+				{
+					node->stats.cache_overflows += 1;
+					node->rc_status = RC_CACHE_BYPASS_MODE;
+				}
+
+				return outerslot;
+			}
+
+		case RC_CACHE_BYPASS_MODE:
+			{
+				TupleTableSlot *outerslot;
+
+				outerNode = outerPlanState(node);
+				outerslot = ExecProcNode(outerNode);
+				if (TupIsNull(outerslot))
+				{
+					node->rc_status = RC_END_OF_SCAN;
+					return NULL;
+				}
+
+				return outerslot;
+			}
+
+		case RC_END_OF_SCAN:
+
+			/* We've already returned NULL for this scan */
+			return NULL;
+
+		default:
+			elog(ERROR, "unrecognized result cache state: %d",
+				 node->rc_status);
+			return NULL;		/* keep compiler quiet */
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitResultCache
+ * ----------------------------------------------------------------
+ */
+ResultCacheState *
+ExecInitResultCache(ResultCache *node, EState *estate, int eflags)
+{
+	ResultCacheState *rcstate;
+	Plan	   *outerNode;
+	int			i;
+	int			nkeys;
+
+	/* check for unsupported flags */
+	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
+
+	/*
+	 * create state structure
+	 */
+	rcstate = makeNode(ResultCacheState);
+	rcstate->ss.ps.plan = (Plan *) node;
+	rcstate->ss.ps.state = estate;
+	rcstate->ss.ps.ExecProcNode = ExecResultCache;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * create expression context for node, in which the cache keys are
+	 * computed
+	 */
+	ExecAssignExprContext(estate, &rcstate->ss.ps);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &rcstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &rcstate->ss);
+
+	/*
+	 * initialize child nodes
+	 */
+	outerNode = outerPlan(node);
+	outerPlanState(rcstate) = ExecInitNode(outerNode, estate, eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&rcstate->ss.ps);
+	ExecAssignScanTypeFromOuterPlan(&rcstate->ss);
+	rcstate->ss.ps.ps_ProjInfo = NULL;
+
+	/*
+	 * Set up the cache keys, and the slots to look them up with.
+	 */
+	rcstate->nkeys = nkeys = node->numKeys;
+	rcstate->hashkeydesc = ExecTypeFromExprList(node->param_exprs);
+	rcstate->tableslot = ExecInitExtraTupleSlot(estate);
+	ExecSetSlotDescriptor(rcstate->tableslot, rcstate->hashkeydesc);
+	rcstate->probeslot = ExecInitExtraTupleSlot(estate);
+	ExecSetSlotDescriptor(rcstate->probeslot, rcstate->hashkeydesc);
+
+	rcstate->param_exprs = ExecInitExprList(node->param_exprs,
+											(PlanState *) rcstate);
+	rcstate->keyparamids = NULL;
+	collect_paramids_walker((Node *) node->param_exprs,
+							&rcstate->keyparamids);
+
+	rcstate->keyColIdx = (AttrNumber *) palloc(nkeys * sizeof(AttrNumber));
+	for (i = 0; i < nkeys; i++)
+		rcstate->keyColIdx[i] = i + 1;
+
+	execTuplesHashPrepare(nkeys, node->hashOperators, &rcstate->eqfunctions,
+						  &rcstate->hashfunctions);
+
+	rcstate->tableContext = AllocSetContextCreate(CurrentMemoryContext,
+												  "ResultCacheHashTable",
+												  ALLOCSET_DEFAULT_SIZES);
+	rcstate->tempContext = AllocSetContextCreate(CurrentMemoryContext,
+												 "ResultCacheTempContext",
+												 ALLOCSET_SMALL_SIZES);
+
+	dlist_init(&rcstate->lru_list);
+	rcstate->hashtable = NULL;
+	rcstate->entry = NULL;
+	rcstate->last_tuple = NULL;
+	rcstate->singlerow = node->singlerow;
+	rcstate->mem_used = 0;
+	rcstate->mem_limit = work_mem * 1024L;
+	memset(&rcstate->stats, 0, sizeof(ResultCacheInstrumentation));
+
+	rcstate->rc_status = RC_CACHE_LOOKUP;
+
+	return rcstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndResultCache
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndResultCache(ResultCacheState *node)
+{
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+
+	/*
+	 * Release the cache
+	 */
+	MemoryContextDelete(node->tableContext);
+	MemoryContextDelete(node->tempContext);
+	node->hashtable = NULL;
+
+	/*
+	 * free exprcontext
+	 */
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+}
+
+/* ----------------------------------------------------------------
+ *		ExecReScanResultCache
+ * ----------------------------------------------------------------
+ */
+void
+ExecReScanResultCache(ResultCacheState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	/* The cached tuple in the result slot might get evicted */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+
+	node->rc_status = RC_CACHE_LOOKUP;
+	node->entry = NULL;
+	node->last_tuple = NULL;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+
+	/*
+	 * If a parameter the subplan depends on changed, and it isn't one of the
+	 * cache keys, none of the cached rows can be trusted any more.
+	 */
+	if (bms_nonempty_difference(outerPlan->chgParam, node->keyparamids) &&
+		node->hashtable != NULL)
+	{
+		if (node->mem_used > node->stats.mem_peak)
+			node->stats.mem_peak = node->mem_used;
+
+		MemoryContextReset(node->tableContext);
+		node->hashtable = NULL;
+		dlist_init(&node->lru_list);
+		node->mem_used = 0;
+	}
+}
+
+/*
+ * ExecEstimateCacheEntryOverheadBytes
+ *		For use in the planner to help it estimate the amount of memory a
+ *		cache entry with ntuples rows takes, beyond the tuples themselves.
+ */
+double
+ExecEstimateCacheEntryOverheadBytes(double ntuples)
+{
+	return sizeof(ResultCacheEntry) + sizeof(ResultCacheKey) +
+		sizeof(ResultCacheTuple) * ntuples;
+}
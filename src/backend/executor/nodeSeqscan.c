@@ -20,6 +20,9 @@
  *		ExecEndSeqScan			releases any storage allocated.
  *		ExecReScanSeqScan		rescans the relation
  *
+ *		ExecSeqScanInitBatch	prepares for fetching tuples in batches
+ *		ExecSeqScanBatch		fetches the next batch of qualifying tuples
+ *
  *		ExecSeqScanEstimate		estimates DSM space needed for parallel scan
  *		ExecSeqScanInitializeDSM initialize DSM for parallel scan
  *		ExecSeqScanInitializeWorker attach to DSM info in parallel worker
@@ -27,11 +30,15 @@
 #include "postgres.h"
 
 #include "access/relscan.h"
+#include "access/tableam.h"
 #include "executor/execdebug.h"
 #include "executor/nodeSeqscan.h"
+#include "miscadmin.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 
 static void InitScanRelation(SeqScanState *node, EState *estate, int eflags);
+static TableScanDesc SeqScanGetScanDesc(SeqScanState *node);
 static TupleTableSlot *SeqNext(SeqScanState *node);
 
 /* ----------------------------------------------------------------
@@ -39,6 +46,31 @@ static TupleTableSlot *SeqNext(SeqScanState *node);
  * ----------------------------------------------------------------
  */
 
+/* ----------------------------------------------------------------
+ *		SeqScanGetScanDesc
+ *
+ *		Return the table AM's scan descriptor, starting the scan if
+ *		need be
+ * ----------------------------------------------------------------
+ */
+static TableScanDesc
+SeqScanGetScanDesc(SeqScanState *node)
+{
+	if (node->tablescan == NULL)
+	{
+		/*
+		 * We reach here if the scan is not parallel, or if we're executing a
+		 * scan that was intended to be parallel serially.
+		 */
+		node->tablescan =
+			table_beginscan(node->ss.ss_currentRelation,
+							node->ss.ps.state->es_snapshot,
+							0, NULL);
+	}
+
+	return node->tablescan;
+}
+
 /* ----------------------------------------------------------------
  *		SeqNext
  *
@@ -48,8 +80,7 @@ static TupleTableSlot *SeqNext(SeqScanState *node);
 static TupleTableSlot *
 SeqNext(SeqScanState *node)
 {
-	HeapTuple	tuple;
-	HeapScanDesc scandesc;
+	TableScanDesc scandesc;
 	EState	   *estate;
 	ScanDirection direction;
 	TupleTableSlot *slot;
@@ -57,44 +88,18 @@ SeqNext(SeqScanState *node)
 	/*
 	 * get information from the estate and scan state
 	 */
-	scandesc = node->ss.ss_currentScanDesc;
+	scandesc = SeqScanGetScanDesc(node);
 	estate = node->ss.ps.state;
 	direction = estate->es_direction;
 	slot = node->ss.ss_ScanTupleSlot;
 
-	if (scandesc == NULL)
-	{
-		/*
-		 * We reach here if the scan is not parallel, or if we're executing a
-		 * scan that was intended to be parallel serially.
-		 */
-		scandesc = heap_beginscan(node->ss.ss_currentRelation,
-								  estate->es_snapshot,
-								  0, NULL);
-		node->ss.ss_currentScanDesc = scandesc;
-	}
-
-	/*
-	 * get the next tuple from the table
-	 */
-	tuple = heap_getnext(scandesc, direction);
-
 	/*
-	 * save the tuple and the buffer returned to us by the access methods in
-	 * our scan tuple slot and return the slot.  Note: we pass 'false' because
-	 * tuples returned by heap_getnext() are pointers onto disk pages and were
-	 * not created with palloc() and so should not be pfree()'d.  Note also
-	 * that ExecStoreTuple will increment the refcount of the buffer; the
-	 * refcount will not be dropped until the tuple table slot is cleared.
+	 * get the next tuple from the table AM, which stores it in our scan tuple
+	 * slot, or clears the slot at the end of the scan.  For a heap, the slot
+	 * holds a pin on the tuple's buffer until the slot is cleared.
 	 */
-	if (tuple)
-		ExecStoreTuple(tuple,	/* tuple to store */
-					   slot,	/* slot to store in */
-					   scandesc->rs_cbuf,	/* buffer associated with this
-											 * tuple */
-					   false);	/* don't pfree this pointer */
-	else
-		ExecClearTuple(slot);
+	table_scan_getnextslot(node->ss.ss_currentRelation, scandesc, direction,
+						   slot);
 
 	return slot;
 }
@@ -131,6 +136,99 @@ ExecSeqScan(PlanState *pstate)
 					(ExecScanRecheckMtd) SeqRecheck);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecSeqScanInitBatch
+ *
+ *		Set up for the parent node to fetch tuples with ExecSeqScanBatch
+ *		instead of ExecProcNode, which saves a trip through the executor
+ *		machinery for every tuple.  Returns NULL if the scan can't be run
+ *		that way, in which case the parent must use ExecProcNode as usual.
+ * ----------------------------------------------------------------
+ */
+TupleBatch *
+ExecSeqScanInitBatch(SeqScanState *node, int maxslots)
+{
+	/*
+	 * A batch holds raw scan tuples, so there must be no projection.
+	 * EvalPlanQual rechecks substitute test tuples in ExecScanFetch, and
+	 * EXPLAIN ANALYZE counts rows in ExecProcNode, so leave those cases to
+	 * the regular path too.
+	 */
+	if (node->ss.ps.ps_ProjInfo != NULL ||
+		node->ss.ps.state->es_epqTuple != NULL ||
+		node->ss.ps.instrument != NULL)
+		return NULL;
+
+	return ExecInitTupleBatch(node->ss.ps.state,
+							  node->ss.ss_ScanTupleSlot->tts_tupleDescriptor,
+							  maxslots);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSeqScanBatch
+ *
+ *		Fill the batch with the next tuples that satisfy the scan's quals,
+ *		replacing its previous contents.  Returns the number of tuples
+ *		fetched; zero means the scan is done.  This is what ExecScan does
+ *		for one tuple, in a loop.  It relies on the table AM keeping each
+ *		slot's tuple valid while the scan fills the others.
+ * ----------------------------------------------------------------
+ */
+int
+ExecSeqScanBatch(SeqScanState *node, TupleBatch *batch)
+{
+	ExprState  *qual = node->ss.ps.qual;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	ScanDirection direction = node->ss.ps.state->es_direction;
+	Relation	relation = node->ss.ss_currentRelation;
+	TableScanDesc scandesc;
+	int			nslots = 0;
+
+	Assert(node->ss.ps.ps_ProjInfo == NULL);
+
+	/* as in ExecProcNode */
+	if (node->ss.ps.chgParam != NULL)
+		ExecReScan((PlanState *) node);
+
+	scandesc = SeqScanGetScanDesc(node);
+
+	while (nslots < batch->maxslots)
+	{
+		TupleTableSlot *slot = batch->slots[nslots];
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (!table_scan_getnextslot(relation, scandesc, direction, slot))
+			break;
+
+		if (qual != NULL)
+		{
+			ResetExprContext(econtext);
+			econtext->ecxt_scantuple = slot;
+			if (!ExecQual(qual, econtext))
+				continue;		/* the slot will be reused */
+		}
+		nslots++;
+	}
+
+	/* At the end of the scan, release pins held by the unused slots */
+	if (nslots < batch->maxslots)
+	{
+		int			i;
+
+		for (i = nslots; i < batch->maxslots; i++)
+		{
+			if (!TupIsNull(batch->slots[i]))
+				ExecClearTuple(batch->slots[i]);
+		}
+	}
+
+	batch->nslots = nslots;
+	batch->next = 0;
+
+	return nslots;
+}
+
 /* ----------------------------------------------------------------
  *		InitScanRelation
  *
@@ -224,13 +322,13 @@ void
 ExecEndSeqScan(SeqScanState *node)
 {
 	Relation	relation;
-	HeapScanDesc scanDesc;
+	TableScanDesc scanDesc;
 
 	/*
 	 * get information from node
 	 */
 	relation = node->ss.ss_currentRelation;
-	scanDesc = node->ss.ss_currentScanDesc;
+	scanDesc = node->tablescan;
 
 	/*
 	 * Free the exprcontext
@@ -244,10 +342,10 @@ ExecEndSeqScan(SeqScanState *node)
 	ExecClearTuple(node->ss.ss_ScanTupleSlot);
 
 	/*
-	 * close heap scan
+	 * close table scan
 	 */
 	if (scanDesc != NULL)
-		heap_endscan(scanDesc);
+		table_endscan(relation, scanDesc);
 
 	/*
 	 * close the heap relation.
@@ -269,13 +367,14 @@ ExecEndSeqScan(SeqScanState *node)
 void
 ExecReScanSeqScan(SeqScanState *node)
 {
-	HeapScanDesc scan;
+	TableScanDesc scan;
 
-	scan = node->ss.ss_currentScanDesc;
+	scan = node->tablescan;
 
 	if (scan != NULL)
-		heap_rescan(scan,		/* scan desc */
-					NULL);		/* new scan keys */
+		table_rescan(node->ss.ss_currentRelation,
+					 scan,		/* scan desc */
+					 NULL);		/* new scan keys */
 
 	ExecScanReScan((ScanState *) node);
 }
@@ -305,7 +404,8 @@ ExecSeqScanEstimate(SeqScanState *node,
 /* ----------------------------------------------------------------
  *		ExecSeqScanInitializeDSM
  *
- *		Set up a parallel heap scan descriptor.
+ *		Set up a parallel heap scan descriptor.  Only heap tables are
+ *		scanned in parallel, so this can use heapam.c directly.
  * ----------------------------------------------------------------
  */
 void
@@ -320,7 +420,7 @@ ExecSeqScanInitializeDSM(SeqScanState *node,
 								 node->ss.ss_currentRelation,
 								 estate->es_snapshot);
 	shm_toc_insert(pcxt->toc, node->ss.ps.plan->plan_node_id, pscan);
-	node->ss.ss_currentScanDesc =
+	node->tablescan = (TableScanDesc)
 		heap_beginscan_parallel(node->ss.ss_currentRelation, pscan);
 }
 
@@ -336,6 +436,6 @@ ExecSeqScanInitializeWorker(SeqScanState *node, shm_toc *toc)
 	ParallelHeapScanDesc pscan;
 
 	pscan = shm_toc_lookup(toc, node->ss.ps.plan->plan_node_id, false);
-	node->ss.ss_currentScanDesc =
+	node->tablescan = (TableScanDesc)
 		heap_beginscan_parallel(node->ss.ss_currentRelation, pscan);
 }
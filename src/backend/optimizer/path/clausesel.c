@@ -65,9 +65,9 @@ static RelOptInfo *find_single_rel_for_clauses(PlannerInfo *root,
  *
  * If the clauses taken together refer to just one relation, we'll try to
  * apply selectivity estimates using any extended statistics for that rel.
- * Currently we only have (soft) functional dependencies, so apply these in as
- * many cases as possible, and fall back on normal estimates for remaining
- * clauses.
+ * We first apply multivariate MCV lists, then (soft) functional dependencies
+ * on the clauses not covered by the MCV lists, and fall back on normal
+ * estimates for remaining clauses.
  *
  * We also recognize "range queries", such as "x > 34 AND x < 42".  Clauses
  * are recognized as possible range query components if they are restriction
@@ -125,19 +125,23 @@ clauselist_selectivity(PlannerInfo *root,
 	if (rel && rel->rtekind == RTE_RELATION && rel->statlist != NIL)
 	{
 		/*
-		 * Perform selectivity estimations on any clauses found applicable by
-		 * dependencies_clauselist_selectivity.  'estimatedclauses' will be
-		 * filled with the 0-based list positions of clauses used that way, so
-		 * that we can ignore them below.
+		 * First, try estimating the clauses using multivariate MCV lists,
+		 * which capture the actual combinations of values and so give the
+		 * most accurate estimates.  'estimatedclauses' will be filled with
+		 * the 0-based list positions of clauses used that way, so that we can
+		 * ignore them below.
 		 */
-		s1 *= dependencies_clauselist_selectivity(root, clauses, varRelid,
-												  jointype, sjinfo, rel,
-												  &estimatedclauses);
+		s1 *= mcv_clauselist_selectivity(root, clauses, varRelid,
+										 jointype, sjinfo, rel,
+										 &estimatedclauses);
 
 		/*
-		 * This would be the place to apply any other types of extended
-		 * statistics selectivity estimations for remaining clauses.
+		 * Then perform selectivity estimations on any remaining clauses found
+		 * applicable by dependencies_clauselist_selectivity.
 		 */
+		s1 *= dependencies_clauselist_selectivity(root, clauses, varRelid,
+												  jointype, sjinfo, rel,
+												  &estimatedclauses);
 	}
 
 	/*
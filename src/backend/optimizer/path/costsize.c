@@ -81,6 +81,7 @@
 #include "access/tsmapi.h"
 #include "executor/executor.h"
 #include "executor/nodeHash.h"
+#include "executor/nodeResultCache.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
@@ -124,6 +125,7 @@ bool		enable_sort = true;
 bool		enable_hashagg = true;
 bool		enable_nestloop = true;
 bool		enable_material = true;
+bool		enable_resultcache = false;
 bool		enable_mergejoin = true;
 bool		enable_hashjoin = true;
 bool		enable_gathermerge = true;
@@ -140,6 +142,8 @@ static MergeScanSelCache *cached_scansel(PlannerInfo *root,
 			   PathKey *pathkey);
 static void cost_rescan(PlannerInfo *root, Path *path,
 			Cost *rescan_startup_cost, Cost *rescan_total_cost);
+static void cost_resultcache_rescan(PlannerInfo *root, ResultCachePath *rcpath,
+						Cost *rescan_startup_cost, Cost *rescan_total_cost);
 static bool cost_qual_eval_walker(Node *node, cost_qual_eval_context *context);
 static void get_restriction_qual_cost(PlannerInfo *root, RelOptInfo *baserel,
 						  ParamPathInfo *param_info,
@@ -527,7 +531,14 @@ cost_index(IndexPath *path, PlannerInfo *root, double loop_count,
 	 * the fraction of main-table tuples we will have to retrieve) and its
 	 * correlation to the main-table tuple order.  We need a cast here because
 	 * relation.h uses a weak function type to avoid including amapi.h.
+	 *
+	 * A parallel scan can work differently from a plain one (btree doesn't do
+	 * skip scans in parallel, for one), so mark a partial path as
+	 * parallel-aware first.  If we can't assign any workers below, the path
+	 * is thrown away anyway.
 	 */
+	if (partial_path)
+		path->path.parallel_aware = true;
 	amcostestimate = (amcostestimate_function) index->amcostestimate;
 	amcostestimate(root, path, loop_count,
 				   &indexStartupCost, &indexTotalCost,
@@ -677,7 +688,9 @@ cost_index(IndexPath *path, PlannerInfo *root, double loop_count,
 		 * order.
 		 */
 		path->path.parallel_workers = compute_parallel_worker(baserel,
-															  rand_heap_pages, index_pages);
+															  rand_heap_pages,
+															  index_pages,
+															  max_parallel_workers_per_gather);
 
 		/*
 		 * Fall out if workers can't be assigned for parallel scan, because in
@@ -3442,6 +3455,10 @@ cost_rescan(PlannerInfo *root, Path *path,
 				*rescan_total_cost = run_cost;
 			}
 			break;
+		case T_ResultCache:
+			cost_resultcache_rescan(root, (ResultCachePath *) path,
+									rescan_startup_cost, rescan_total_cost);
+			break;
 		default:
 			*rescan_startup_cost = path->startup_cost;
 			*rescan_total_cost = path->total_cost;
@@ -3449,6 +3466,118 @@ cost_rescan(PlannerInfo *root, Path *path,
 	}
 }
 
+/*
+ * cost_resultcache_rescan
+ *	  Determines the estimated cost of rescanning a ResultCache node.
+ *
+ * The rescans are spread over the distinct values of the cache keys.  As
+ * many of those as fit in work_mem stay cached, so a rescan with a value
+ * seen before is usually a cache hit that costs next to nothing; the others
+ * cost a full scan of the subpath, plus evicting an old entry.  We also
+ * fill in the path's est_entries here, which the executor uses to size its
+ * hash table.
+ */
+static void
+cost_resultcache_rescan(PlannerInfo *root, ResultCachePath *rcpath,
+						Cost *rescan_startup_cost, Cost *rescan_total_cost)
+{
+	Cost		input_startup_cost = rcpath->subpath->startup_cost;
+	Cost		input_total_cost = rcpath->subpath->total_cost;
+	double		tuples = rcpath->subpath->rows;
+	double		calls = rcpath->calls;
+	int			width = rcpath->subpath->pathtarget->width;
+	double		work_mem_bytes = work_mem * 1024.0;
+	double		est_entry_bytes;
+	double		est_cache_entries;
+	double		ndistinct;
+	double		evict_ratio;
+	double		hit_ratio;
+	Cost		startup_cost;
+	Cost		total_cost;
+	ListCell   *lc;
+
+	/* Estimate the memory an entry takes, including its key */
+	est_entry_bytes = relation_byte_size(tuples, width) +
+		ExecEstimateCacheEntryOverheadBytes(tuples);
+	foreach(lc, rcpath->param_exprs)
+	{
+		Node	   *expr = (Node *) lfirst(lc);
+
+		est_entry_bytes += get_typavgwidth(exprType(expr), exprTypmod(expr));
+	}
+
+	/* The number of entries we can hold at once */
+	est_cache_entries = floor(work_mem_bytes / est_entry_bytes);
+
+	/*
+	 * Estimate the number of distinct keys.  If we have no statistics for
+	 * any of them, it's too risky to assume there'll be many repeats: a
+	 * default estimate could make us use a result cache where it's really
+	 * inappropriate.  Assume every call has different keys then, which
+	 * makes it very unlikely that the path will survive add_path().
+	 */
+	ndistinct = estimate_num_groups(root, rcpath->param_exprs, calls, NULL);
+	foreach(lc, rcpath->param_exprs)
+	{
+		VariableStatData vardata;
+		bool		isdefault;
+
+		examine_variable(root, (Node *) lfirst(lc), 0, &vardata);
+		(void) get_variable_numdistinct(&vardata, &isdefault);
+		ReleaseVariableStats(vardata);
+
+		if (isdefault)
+		{
+			ndistinct = calls;
+			break;
+		}
+	}
+	ndistinct = clamp_row_est(Min(ndistinct, calls));
+
+	rcpath->est_entries = (uint32) Min(Min(ndistinct, est_cache_entries),
+									   PG_UINT32_MAX);
+
+	/*
+	 * If there are more distinct keys than we can cache at once, some
+	 * entries will have to be evicted; estimate how often.
+	 */
+	evict_ratio = 1.0 - Min(est_cache_entries, ndistinct) / ndistinct;
+
+	/*
+	 * The fraction of rescans we expect to be answered from the cache: all
+	 * but the first with each key, scaled down if not all keys fit.
+	 */
+	hit_ratio = ((calls - ndistinct) / calls) *
+		(est_cache_entries / Max(ndistinct, est_cache_entries));
+
+	Assert(hit_ratio >= 0 && hit_ratio <= 1.0);
+
+	/*
+	 * Misses pay for a scan of the subpath.  Every rescan pays a
+	 * cpu_operator_cost for the lookup.
+	 */
+	total_cost = input_total_cost * (1.0 - hit_ratio) + cpu_operator_cost;
+
+	/*
+	 * Charge a cpu_tuple_cost for evicting an entry, and a tenth of a
+	 * cpu_operator_cost for freeing each of its tuples.
+	 */
+	total_cost += cpu_tuple_cost * evict_ratio;
+	total_cost += cpu_operator_cost / 10.0 * evict_ratio * tuples;
+
+	/*
+	 * Storing things in the cache isn't free either: charge a cpu_tuple_cost
+	 * for creating the entry and a cpu_operator_cost per tuple cached.
+	 */
+	total_cost += cpu_tuple_cost + cpu_operator_cost * tuples;
+
+	/* The first row only costs anything on a miss, apart from the lookup */
+	startup_cost = input_startup_cost * (1.0 - hit_ratio) + cpu_tuple_cost;
+
+	*rescan_startup_cost = startup_cost;
+	*rescan_total_cost = total_cost;
+}
+
 
 /*
  * cost_qual_eval
@@ -18,10 +18,14 @@
 
 #include "executor/executor.h"
 #include "foreign/fdwapi.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/planmain.h"
+#include "utils/lsyscache.h"
+#include "utils/typcache.h"
 
 /* Hook for plugins to get control in add_paths_to_joinrel() */
 set_join_pathlist_hook_type set_join_pathlist_hook = NULL;
@@ -329,6 +333,147 @@ allow_star_schema_join(PlannerInfo *root,
 			bms_nonempty_difference(inner_paramrels, outerrelids));
 }
 
+/*
+ * paraminfo_get_equal_hashops
+ *		Work out the cache keys for caching the rows of a path with the given
+ *		parameterization, and their hashable equality operators.
+ *
+ * Each of the parameterization clauses must be a hashable equality between
+ * an expression of the outer rel and one of the inner rel; the outer side is
+ * the cache key.  Returns false if that's not so, or if the type of some key
+ * has no hashable equality operator.
+ */
+static bool
+paraminfo_get_equal_hashops(ParamPathInfo *param_info, RelOptInfo *outerrel,
+							RelOptInfo *innerrel, List **param_exprs,
+							List **operators)
+{
+	ListCell   *lc;
+
+	*param_exprs = NIL;
+	*operators = NIL;
+
+	foreach(lc, param_info->ppi_clauses)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		OpExpr	   *opexpr;
+		Node	   *expr;
+		TypeCacheEntry *typentry;
+		Oid			left_hashfn;
+		Oid			right_hashfn;
+
+		/* This also rules out volatile clauses */
+		if (!OidIsValid(rinfo->hashjoinoperator))
+			return false;
+
+		opexpr = (OpExpr *) rinfo->clause;
+		Assert(IsA(opexpr, OpExpr) && list_length(opexpr->args) == 2);
+
+		if (!bms_is_empty(rinfo->left_relids) &&
+			bms_is_subset(rinfo->left_relids, outerrel->relids) &&
+			bms_is_subset(rinfo->right_relids, innerrel->relids))
+			expr = (Node *) linitial(opexpr->args);
+		else if (!bms_is_empty(rinfo->right_relids) &&
+				 bms_is_subset(rinfo->right_relids, outerrel->relids) &&
+				 bms_is_subset(rinfo->left_relids, innerrel->relids))
+			expr = (Node *) lsecond(opexpr->args);
+		else
+			return false;
+
+		/*
+		 * The key is compared with its own type's equality operator, which
+		 * needn't be the one in the clause if that's cross-type.
+		 */
+		typentry = lookup_type_cache(exprType(expr), TYPECACHE_EQ_OPR);
+		if (!OidIsValid(typentry->eq_opr) ||
+			!get_op_hash_functions(typentry->eq_opr,
+								   &left_hashfn, &right_hashfn))
+			return false;
+
+		*param_exprs = lappend(*param_exprs, expr);
+		*operators = lappend_oid(*operators, typentry->eq_opr);
+	}
+
+	return true;
+}
+
+/*
+ * get_resultcache_path
+ *		If possible, make a ResultCachePath to cache the rows of inner_path,
+ *		for use on the inner side of a nestloop with outer_path.
+ *
+ * This is only worth doing for a parameterized inner path, where repeated
+ * parameter values would otherwise mean running the inner side over again
+ * for the same result.  Whether it's worth it in the end is up to the
+ * costing.  Returns NULL if a result cache can't be used.
+ */
+static Path *
+get_resultcache_path(PlannerInfo *root, RelOptInfo *innerrel,
+					 RelOptInfo *outerrel, Path *inner_path,
+					 Path *outer_path, JoinType jointype,
+					 JoinPathExtraData *extra)
+{
+	List	   *param_exprs;
+	List	   *hash_operators;
+	ListCell   *lc;
+
+	if (!enable_resultcache)
+		return NULL;
+
+	/* With a single outer row, there'd be nothing to reuse */
+	if (outer_path->rows < 2)
+		return NULL;
+
+	/* The inner side must depend on the outer through its parameters only */
+	if (inner_path->param_info == NULL ||
+		inner_path->param_info->ppi_clauses == NIL)
+		return NULL;
+	if (!bms_is_empty(innerrel->lateral_relids))
+		return NULL;
+	if (!bms_is_subset(inner_path->param_info->ppi_req_outer,
+					   outerrel->relids))
+		return NULL;
+
+	/*
+	 * A semi or anti join stops reading the inner side after the first
+	 * match, so an entry would hardly ever be complete, unless we know there
+	 * can be just one matching row.  With inner_unique, the nestloop also
+	 * stops after the first match, so entries are complete after one row,
+	 * but that's only right if every join clause is a parameterization
+	 * clause; otherwise the first row returned might not even match.
+	 */
+	if ((jointype == JOIN_SEMI || jointype == JOIN_ANTI) &&
+		!extra->inner_unique)
+		return NULL;
+	if (extra->inner_unique &&
+		list_length(inner_path->param_info->ppi_clauses) <
+		list_length(extra->restrictlist))
+		return NULL;
+
+	/*
+	 * Volatile functions in the inner rel would be called fewer times with a
+	 * cache than without.
+	 */
+	if (contain_volatile_functions((Node *) innerrel->reltarget->exprs))
+		return NULL;
+	foreach(lc, innerrel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+		if (contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+	}
+
+	if (!paraminfo_get_equal_hashops(inner_path->param_info, outerrel,
+									 innerrel, &param_exprs, &hash_operators))
+		return NULL;
+
+	return (Path *) create_resultcache_path(root, innerrel, inner_path,
+											param_exprs, hash_operators,
+											extra->inner_unique,
+											outer_path->rows);
+}
+
 /*
  * try_nestloop_path
  *	  Consider a nestloop join path; if it appears useful, push it into
@@ -1378,6 +1523,7 @@ match_unsorted_outer(PlannerInfo *root,
 			foreach(lc2, innerrel->cheapest_parameterized_paths)
 			{
 				Path	   *innerpath = (Path *) lfirst(lc2);
+				Path	   *rcpath;
 
 				try_nestloop_path(root,
 								  joinrel,
@@ -1386,6 +1532,19 @@ match_unsorted_outer(PlannerInfo *root,
 								  merge_pathkeys,
 								  jointype,
 								  extra);
+
+				/* Also try caching the rows of a parameterized inner path */
+				rcpath = get_resultcache_path(root, innerrel, outerrel,
+											  innerpath, outerpath, jointype,
+											  extra);
+				if (rcpath != NULL)
+					try_nestloop_path(root,
+									  joinrel,
+									  outerpath,
+									  rcpath,
+									  merge_pathkeys,
+									  jointype,
+									  extra);
 			}
 
 			/* Also consider materialized form of the cheapest inner path */
@@ -1541,6 +1700,7 @@ consider_parallel_nestloop(PlannerInfo *root,
 		foreach(lc2, innerrel->cheapest_parameterized_paths)
 		{
 			Path	   *innerpath = (Path *) lfirst(lc2);
+			Path	   *rcpath;
 
 			/* Can't join to an inner path that is not parallel-safe */
 			if (!innerpath->parallel_safe)
@@ -1565,6 +1725,14 @@ consider_parallel_nestloop(PlannerInfo *root,
 
 			try_partial_nestloop_path(root, joinrel, outerpath, innerpath,
 									  pathkeys, jointype, extra);
+
+			/* Also try caching the rows of a parameterized inner path */
+			rcpath = get_resultcache_path(root, innerrel, outerrel,
+										  innerpath, outerpath, jointype,
+										  extra);
+			if (rcpath != NULL)
+				try_partial_nestloop_path(root, joinrel, outerpath, rcpath,
+										  pathkeys, jointype, extra);
 		}
 	}
 }
@@ -652,6 +652,22 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 			 */
 			Assert(plan->qual == NIL);
 			break;
+		case T_ResultCache:
+			{
+				ResultCache *rcplan = (ResultCache *) plan;
+
+				/*
+				 * Like the plan types above, ResultCache doesn't evaluate its
+				 * tlist or quals.  But we have to fix up the cache keys,
+				 * which by now refer only to Params.
+				 */
+				set_dummy_tlist_references(plan, rtoffset);
+				Assert(plan->qual == NIL);
+
+				rcplan->param_exprs = fix_scan_list(root, rcplan->param_exprs,
+													rtoffset);
+			}
+			break;
 		case T_LockRows:
 			{
 				LockRows   *splan = (LockRows *) plan;
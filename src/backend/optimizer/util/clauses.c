@@ -19,6 +19,8 @@
 
 #include "postgres.h"
 
+#include "access/genam.h"
+#include "access/heapam.h"
 #include "access/htup_details.h"
 #include "catalog/pg_aggregate.h"
 #include "catalog/pg_class.h"
@@ -41,6 +43,7 @@
 #include "parser/parse_agg.h"
 #include "parser/parse_coerce.h"
 #include "parser/parse_func.h"
+#include "parser/parsetree.h"
 #include "rewrite/rewriteManip.h"
 #include "tcop/tcopprot.h"
 #include "utils/acl.h"
@@ -49,6 +52,7 @@
 #include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/rel.h"
 #include "utils/syscache.h"
 #include "utils/typcache.h"
 
@@ -104,8 +108,12 @@ static bool contain_subplans_walker(Node *node, void *context);
 static bool contain_mutable_functions_walker(Node *node, void *context);
 static bool contain_volatile_functions_walker(Node *node, void *context);
 static bool contain_volatile_functions_not_nextval_walker(Node *node, void *context);
+static bool max_parallel_hazard_test(char proparallel,
+						 max_parallel_hazard_context *context);
 static bool max_parallel_hazard_walker(Node *node,
 						   max_parallel_hazard_context *context);
+static bool target_rel_max_parallel_hazard(Query *parse,
+							   max_parallel_hazard_context *context);
 static bool contain_nonstrict_functions_walker(Node *node, void *context);
 static bool contain_context_dependent_node(Node *clause);
 static bool contain_context_dependent_node_walker(Node *node, int *flags);
@@ -1072,10 +1080,85 @@ max_parallel_hazard(Query *parse)
 	context.max_hazard = PROPARALLEL_SAFE;
 	context.max_interesting = PROPARALLEL_UNSAFE;
 	context.safe_param_ids = NIL;
-	(void) max_parallel_hazard_walker((Node *) parse, &context);
+	if (!max_parallel_hazard_walker((Node *) parse, &context) &&
+		parse->commandType == CMD_INSERT)
+		(void) target_rel_max_parallel_hazard(parse, &context);
 	return context.max_hazard;
 }
 
+/*
+ * target_rel_max_parallel_hazard
+ *		Check the target relation of an INSERT for parallel hazards
+ *
+ * Only the query feeding an INSERT runs in the workers; the leader inserts
+ * the rows itself.  But it does so in parallel mode, so anything that runs
+ * as part of the insertion must not be parallel unsafe.  Triggers (which
+ * includes foreign keys) and ON CONFLICT are simply treated as unsafe, and
+ * so are target relations other than plain tables and materialized views,
+ * since partition routing and foreign tables open up too many other
+ * possibilities.  Column defaults are already part of the targetlist, so
+ * that leaves CHECK constraints and index expressions and predicates.
+ * Parallel-restricted constructs are fine here, since the leader is the
+ * one to evaluate them.
+ */
+static bool
+target_rel_max_parallel_hazard(Query *parse,
+							   max_parallel_hazard_context *context)
+{
+	RangeTblEntry *rte = rt_fetch(parse->resultRelation, parse->rtable);
+	Relation	rel;
+	TupleConstr *constr;
+	List	   *indexoidlist;
+	ListCell   *lc;
+	bool		result = false;
+	int			i;
+
+	if (parse->onConflict != NULL)
+		return max_parallel_hazard_test(PROPARALLEL_UNSAFE, context);
+
+	/* the rewriter already locked the target relation */
+	rel = heap_open(rte->relid, NoLock);
+
+	if ((rel->rd_rel->relkind != RELKIND_RELATION &&
+		 rel->rd_rel->relkind != RELKIND_MATVIEW) ||
+		rel->trigdesc != NULL)
+	{
+		result = max_parallel_hazard_test(PROPARALLEL_UNSAFE, context);
+		heap_close(rel, NoLock);
+		return result;
+	}
+
+	/* CHECK constraints */
+	constr = RelationGetDescr(rel)->constr;
+	if (constr != NULL)
+	{
+		for (i = 0; i < constr->num_check && !result; i++)
+			result = max_parallel_hazard_walker(stringToNode(constr->check[i].ccbin),
+												context);
+	}
+
+	/* Index expressions and predicates */
+	indexoidlist = RelationGetIndexList(rel);
+	foreach(lc, indexoidlist)
+	{
+		Relation	indexDesc;
+
+		if (result)
+			break;
+		indexDesc = index_open(lfirst_oid(lc), RowExclusiveLock);
+		result = max_parallel_hazard_walker((Node *) RelationGetIndexExpressions(indexDesc),
+											context) ||
+			max_parallel_hazard_walker((Node *) RelationGetIndexPredicate(indexDesc),
+									   context);
+		index_close(indexDesc, NoLock);
+	}
+	list_free(indexoidlist);
+
+	heap_close(rel, NoLock);
+
+	return result;
+}
+
 /*
  * is_parallel_safe
  *		Detect whether the given expr contains only parallel-safe functions
@@ -1104,6 +1187,25 @@ is_parallel_safe(PlannerInfo *root, Node *node)
 	return !max_parallel_hazard_walker(node, &context);
 }
 
+/*
+ * is_parallel_safe_expr
+ *		Detect whether a standalone expression can be evaluated in a worker.
+ *
+ * This is for expressions that are not part of a query being planned, such
+ * as column defaults or index expressions.  As in is_parallel_safe(),
+ * parallel-restricted constructs count as unsafe.
+ */
+bool
+is_parallel_safe_expr(Node *node)
+{
+	max_parallel_hazard_context context;
+
+	context.max_hazard = PROPARALLEL_SAFE;
+	context.max_interesting = PROPARALLEL_RESTRICTED;
+	context.safe_param_ids = NIL;
+	return !max_parallel_hazard_walker(node, &context);
+}
+
 /* core logic for all parallel-hazard checks */
 static bool
 max_parallel_hazard_test(char proparallel, max_parallel_hazard_context *context)
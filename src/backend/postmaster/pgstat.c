@@ -5560,6 +5560,21 @@ pgstat_clear_snapshot(void)
 }
 
 
+/* ----------
+ * pgstat_have_snapshot() -
+ *
+ *	Report whether the stats files have already been read in the current
+ *	transaction, that is, whether subsequent requests will be answered
+ *	from an existing (possibly slightly stale) snapshot.
+ * ----------
+ */
+bool
+pgstat_have_snapshot(void)
+{
+	return pgStatDBHash != NULL;
+}
+
+
 /* ----------
  * pgstat_recv_inquiry() -
  *
@@ -517,6 +517,7 @@ typedef struct
 	bool		IsBinaryUpgrade;
 	int			max_safe_fds;
 	int			MaxBackends;
+	int			FastPathLockGroupsPerBackend;
 #ifdef WIN32
 	HANDLE		PostmasterHandle;
 	HANDLE		initial_signal_pipe;
@@ -980,6 +981,9 @@ PostmasterMain(int argc, char *argv[])
 	 */
 	InitializeMaxBackends();
 
+	/* Size the per-backend fast-path lock arrays, too. */
+	InitializeFastPathLocks();
+
 	/*
 	 * Establish input sockets.
 	 *
@@ -6001,6 +6005,7 @@ save_backend_variables(BackendParameters *param, Port *port,
 	param->max_safe_fds = max_safe_fds;
 
 	param->MaxBackends = MaxBackends;
+	param->FastPathLockGroupsPerBackend = FastPathLockGroupsPerBackend;
 
 #ifdef WIN32
 	param->PostmasterHandle = PostmasterHandle;
@@ -6233,6 +6238,7 @@ restore_backend_variables(BackendParameters *param, Port *port)
 	max_safe_fds = param->max_safe_fds;
 
 	MaxBackends = param->MaxBackends;
+	FastPathLockGroupsPerBackend = param->FastPathLockGroupsPerBackend;
 
 #ifdef WIN32
 	PostmasterHandle = param->PostmasterHandle;
@@ -0,0 +1,1191 @@
+/*-------------------------------------------------------------------------
+ *
+ * mcv.c
+ *	  POSTGRES multivariate MCV lists
+ *
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/statistics/mcv.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/sysattr.h"
+#include "access/tuptoaster.h"
+#include "catalog/pg_statistic_ext.h"
+#include "fmgr.h"
+#include "lib/stringinfo.h"
+#include "nodes/relation.h"
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
+#include "optimizer/var.h"
+#include "statistics/extended_stats_internal.h"
+#include "statistics/statistics.h"
+#include "utils/builtins.h"
+#include "utils/bytea.h"
+#include "utils/fmgroids.h"
+#include "utils/fmgrprotos.h"
+#include "utils/lsyscache.h"
+#include "utils/selfuncs.h"
+#include "utils/syscache.h"
+#include "utils/typcache.h"
+
+/*
+ * Values wider than this are not included in the MCV list, for the same
+ * reasons compute_distinct_stats ignores them (see WIDTH_THRESHOLD in
+ * analyze.c).  Such values are unlikely to be common, and including them
+ * would bloat the serialized list.
+ */
+#define MCV_WIDTH_THRESHOLD		1024
+
+/*
+ * Size of a serialized MCV item, excluding the values themselves - the
+ * frequency, the base frequency and a NULL flag for each dimension.
+ */
+#define ITEM_HEADER_SIZE(ndims) \
+	(2 * sizeof(double) + (ndims) * sizeof(bool))
+
+/* size of the serialized MCV list header, excluding the types array */
+#define SizeOfMCVList \
+	(offsetof(MCVList, ndimensions) + sizeof(AttrNumber))
+
+/*
+ * A group of identical sample rows, i.e. a single combination of values
+ * and the number of times it appeared in the sample.
+ */
+typedef struct MCVGroup
+{
+	int			first;			/* index of the first item in the group */
+	int			count;			/* number of sample rows in the group */
+} MCVGroup;
+
+static int	compare_groups_by_count(const void *a, const void *b);
+static int	compare_single_dimension(const void *a, const void *b, void *arg);
+static int	count_dimension_value(SortItem *values, int nvalues,
+					  SortItem *key, SortSupport ssup);
+static bool mcv_item_is_too_wide(SortItem *item, VacAttrStats **stats,
+					 int ndims);
+static Size mcv_value_size(Datum value, int16 typlen, bool typbyval);
+static bool mcv_is_compatible_clause(PlannerInfo *root, Node *clause,
+						 Index relid, AttrNumber *attnum);
+static bool mcv_item_matches_clause(MCVItem *item, Node *clause,
+						AttrNumber *attnums, int ndims);
+
+
+/*
+ * statext_mcv_build
+ *		Build a multivariate MCV list from the sample rows.
+ *
+ * The algorithm is fairly simple:
+ *
+ * (a) sort the sample rows lexicographically, using all the columns
+ *
+ * (b) split the sorted rows into groups of identical combinations
+ *
+ * (c) keep the most frequent groups, and compute the frequency and the
+ *	   "base" frequency (i.e. the frequency we would expect if the columns
+ *	   were independent) for each of them
+ *
+ * The size of the list is limited by the largest statistics target of the
+ * columns covered by the statistics object.  Returns NULL when no
+ * combination is common enough to be worth keeping.
+ */
+MCVList *
+statext_mcv_build(int numrows, HeapTuple *rows, Bitmapset *attrs,
+				  VacAttrStats **stats)
+{
+	int			i,
+				j;
+	int			numattrs = bms_num_members(attrs);
+	int			ngroups;
+	int			nitems;
+	int			maxitems;
+	double		mincount;
+	int		   *attnums;
+	MultiSortSupport mss;
+	SortItem   *items;
+	Datum	   *values;
+	bool	   *isnull;
+	MCVGroup   *groups;
+	MCVList    *mcvlist;
+
+	if (numrows <= 0)
+		return NULL;
+
+	/* transform the bms into an array, to make accessing i-th member easier */
+	attnums = (int *) palloc(sizeof(int) * numattrs);
+	i = 0;
+	j = -1;
+	while ((j = bms_next_member(attrs, j)) >= 0)
+		attnums[i++] = j;
+
+	/* the list size is determined by the largest per-column target */
+	maxitems = 0;
+	for (i = 0; i < numattrs; i++)
+		maxitems = Max(maxitems, stats[i]->attr->attstattarget);
+	maxitems = Min(maxitems, STATS_MCVLIST_MAX_ITEMS);
+
+	if (maxitems <= 0)
+		return NULL;
+
+	/* sort info for all attributes columns */
+	mss = multi_sort_init(numattrs);
+
+	/* data for the sort */
+	items = (SortItem *) palloc(numrows * sizeof(SortItem));
+	values = (Datum *) palloc(sizeof(Datum) * numrows * numattrs);
+	isnull = (bool *) palloc(sizeof(bool) * numrows * numattrs);
+
+	/* fix the pointers to values/isnull */
+	for (i = 0; i < numrows; i++)
+	{
+		items[i].values = &values[i * numattrs];
+		items[i].isnull = &isnull[i * numattrs];
+	}
+
+	for (i = 0; i < numattrs; i++)
+	{
+		VacAttrStats *colstat = stats[i];
+		TypeCacheEntry *type;
+
+		type = lookup_type_cache(colstat->attrtypid, TYPECACHE_LT_OPR);
+		if (type->lt_opr == InvalidOid) /* shouldn't happen */
+			elog(ERROR, "cache lookup failed for ordering operator for type %u",
+				 colstat->attrtypid);
+
+		/* prepare the sort function for this dimension */
+		multi_sort_add_dimension(mss, i, type->lt_opr);
+
+		/* accumulate all the data for this column */
+		for (j = 0; j < numrows; j++)
+			items[j].values[i] = heap_getattr(rows[j], attnums[i],
+											  colstat->tupDesc,
+											  &items[j].isnull[i]);
+	}
+
+	/* sort the items so that identical combinations are adjacent */
+	qsort_arg((void *) items, numrows, sizeof(SortItem),
+			  multi_sort_compare, mss);
+
+	/* split the sorted items into groups of identical combinations */
+	groups = (MCVGroup *) palloc(sizeof(MCVGroup) * numrows);
+	groups[0].first = 0;
+	groups[0].count = 1;
+	ngroups = 1;
+
+	for (i = 1; i < numrows; i++)
+	{
+		if (multi_sort_compare(&items[i - 1], &items[i], mss) != 0)
+		{
+			groups[ngroups].first = i;
+			groups[ngroups].count = 0;
+			ngroups++;
+		}
+
+		groups[ngroups - 1].count++;
+	}
+
+	/* most common combinations first */
+	qsort(groups, ngroups, sizeof(MCVGroup), compare_groups_by_count);
+
+	/*
+	 * Decide which groups to keep.  If every combination appeared in the
+	 * sample more than once and they all fit into the list, the sample
+	 * presumably contains all the combinations present in the table, so we
+	 * keep all of them.  Otherwise keep only the combinations noticeably more
+	 * common than the average one, using the same rule as
+	 * compute_distinct_stats.
+	 */
+	if (ngroups <= maxitems && groups[ngroups - 1].count > 1)
+		mincount = 0;
+	else
+	{
+		mincount = 1.25 * numrows / ngroups;
+		if (mincount < 2)
+			mincount = 2;
+	}
+
+	mcvlist = (MCVList *) palloc0(sizeof(MCVList));
+	mcvlist->magic = STATS_MCV_MAGIC;
+	mcvlist->type = STATS_MCV_TYPE_BASIC;
+	mcvlist->ndimensions = numattrs;
+	mcvlist->items = (MCVItem **) palloc(sizeof(MCVItem *) *
+										 Min(ngroups, maxitems));
+
+	for (i = 0; i < numattrs; i++)
+		mcvlist->types[i] = stats[i]->attrtypid;
+
+	nitems = 0;
+	for (i = 0; i < ngroups && nitems < maxitems; i++)
+	{
+		SortItem   *first = &items[groups[i].first];
+		MCVItem    *item;
+
+		/* the groups are sorted, so all the remaining ones are rarer */
+		if (groups[i].count < mincount)
+			break;
+
+		if (mcv_item_is_too_wide(first, stats, numattrs))
+			continue;
+
+		item = (MCVItem *) palloc(sizeof(MCVItem));
+		item->values = (Datum *) palloc(sizeof(Datum) * numattrs);
+		item->isnull = (bool *) palloc(sizeof(bool) * numattrs);
+		item->frequency = (double) groups[i].count / numrows;
+		item->base_frequency = 1.0;
+
+		for (j = 0; j < numattrs; j++)
+		{
+			item->isnull[j] = first->isnull[j];
+			item->values[j] = first->values[j];
+
+			/* the serialization works with detoasted values */
+			if (!item->isnull[j] && stats[j]->attrtype->typlen == -1)
+				item->values[j] =
+					PointerGetDatum(PG_DETOAST_DATUM(item->values[j]));
+		}
+
+		mcvlist->items[nitems++] = item;
+	}
+
+	/*
+	 * Now compute the base frequencies, i.e. the product of per-column
+	 * frequencies of the values in each item.  We sort the values in each
+	 * dimension separately, and then look up each value using a binary
+	 * search.
+	 */
+	if (nitems > 0)
+	{
+		SortItem   *dimvalues = (SortItem *) palloc(sizeof(SortItem) * numrows);
+
+		for (j = 0; j < numattrs; j++)
+		{
+			for (i = 0; i < numrows; i++)
+			{
+				dimvalues[i].values = &items[i].values[j];
+				dimvalues[i].isnull = &items[i].isnull[j];
+			}
+
+			qsort_arg((void *) dimvalues, numrows, sizeof(SortItem),
+					  compare_single_dimension, &mss->ssup[j]);
+
+			for (i = 0; i < nitems; i++)
+			{
+				MCVItem    *item = mcvlist->items[i];
+				SortItem	key;
+				int			count;
+
+				key.values = &item->values[j];
+				key.isnull = &item->isnull[j];
+
+				count = count_dimension_value(dimvalues, numrows, &key,
+											  &mss->ssup[j]);
+
+				item->base_frequency *= (double) count / numrows;
+			}
+		}
+
+		pfree(dimvalues);
+	}
+
+	pfree(groups);
+	pfree(items);
+	pfree(values);
+	pfree(isnull);
+	pfree(attnums);
+	pfree(mss);
+
+	if (nitems == 0)
+	{
+		pfree(mcvlist->items);
+		pfree(mcvlist);
+		return NULL;
+	}
+
+	mcvlist->nitems = nitems;
+
+	return mcvlist;
+}
+
+/*
+ * qsort comparator sorting MCVGroups by count (descending), breaking ties
+ * using the position in the sorted sample so that the result is stable
+ */
+static int
+compare_groups_by_count(const void *a, const void *b)
+{
+	const MCVGroup *ga = (const MCVGroup *) a;
+	const MCVGroup *gb = (const MCVGroup *) b;
+
+	if (ga->count != gb->count)
+		return (ga->count > gb->count) ? -1 : 1;
+
+	if (ga->first != gb->first)
+		return (ga->first < gb->first) ? -1 : 1;
+
+	return 0;
+}
+
+/* qsort_arg comparator for SortItems pointing to a single dimension */
+static int
+compare_single_dimension(const void *a, const void *b, void *arg)
+{
+	const SortItem *ia = (const SortItem *) a;
+	const SortItem *ib = (const SortItem *) b;
+
+	return ApplySortComparator(ia->values[0], ia->isnull[0],
+							   ib->values[0], ib->isnull[0],
+							   (SortSupport) arg);
+}
+
+/*
+ * count_dimension_value
+ *		Count occurrences of the key in the sorted array of values.
+ */
+static int
+count_dimension_value(SortItem *values, int nvalues, SortItem *key,
+					  SortSupport ssup)
+{
+	int			lo,
+				hi,
+				start;
+
+	/* find the first value not smaller than the key */
+	lo = 0;
+	hi = nvalues;
+	while (lo < hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+
+		if (compare_single_dimension(&values[mid], key, ssup) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	start = lo;
+
+	/* and the first value greater than the key */
+	hi = nvalues;
+	while (lo < hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+
+		if (compare_single_dimension(&values[mid], key, ssup) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo - start;
+}
+
+/*
+ * mcv_item_is_too_wide
+ *		Check if any of the values exceeds MCV_WIDTH_THRESHOLD.
+ */
+static bool
+mcv_item_is_too_wide(SortItem *item, VacAttrStats **stats, int ndims)
+{
+	int			i;
+
+	for (i = 0; i < ndims; i++)
+	{
+		int16		typlen = stats[i]->attrtype->typlen;
+
+		if (item->isnull[i])
+			continue;
+
+		if (typlen == -1 &&
+			toast_raw_datum_size(item->values[i]) > MCV_WIDTH_THRESHOLD)
+			return true;
+
+		if (typlen == -2 &&
+			strlen(DatumGetCString(item->values[i])) > MCV_WIDTH_THRESHOLD)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * mcv_value_size
+ *		Size of a serialized (non-NULL) value.
+ *
+ * Pass-by-value and fixed-length values are stored as is, varlena and
+ * cstring values are prefixed with their length.
+ */
+static Size
+mcv_value_size(Datum value, int16 typlen, bool typbyval)
+{
+	if (typbyval || typlen > 0)
+		return typlen;
+	else if (typlen == -1)
+		return sizeof(uint32) + VARSIZE_ANY(DatumGetPointer(value));
+	else
+	{
+		Assert(typlen == -2);
+		return sizeof(uint32) + strlen(DatumGetCString(value)) + 1;
+	}
+}
+
+/*
+ * statext_mcv_serialize
+ *		Serialize MCV list into a bytea value.
+ *
+ * The serialized format starts with the list header (magic, type, number of
+ * items and dimensions) and the OIDs of the data types, followed by the
+ * items.  Each item is stored as the two frequencies, the NULL flags, and
+ * the non-NULL values.
+ */
+bytea *
+statext_mcv_serialize(MCVList *mcvlist)
+{
+	int			i,
+				dim;
+	int			ndims = mcvlist->ndimensions;
+	int16		typlen[STATS_MAX_DIMENSIONS];
+	bool		typbyval[STATS_MAX_DIMENSIONS];
+	bytea	   *output;
+	char	   *tmp;
+	Size		len;
+
+	Assert((ndims >= 2) && (ndims <= STATS_MAX_DIMENSIONS));
+
+	for (dim = 0; dim < ndims; dim++)
+		get_typlenbyval(mcvlist->types[dim], &typlen[dim], &typbyval[dim]);
+
+	/* the header, type OIDs and the fixed part of items */
+	len = VARHDRSZ + SizeOfMCVList + ndims * sizeof(Oid)
+		+ mcvlist->nitems * ITEM_HEADER_SIZE(ndims);
+
+	/* and also include space for the actual values */
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+
+		for (dim = 0; dim < ndims; dim++)
+		{
+			if (item->isnull[dim])
+				continue;
+
+			len += mcv_value_size(item->values[dim], typlen[dim],
+								  typbyval[dim]);
+		}
+	}
+
+	output = (bytea *) palloc0(len);
+	SET_VARSIZE(output, len);
+
+	tmp = VARDATA(output);
+
+	/* Store the base struct values (magic, type, nitems, ndimensions) */
+	memcpy(tmp, &mcvlist->magic, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(tmp, &mcvlist->type, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(tmp, &mcvlist->nitems, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(tmp, &mcvlist->ndimensions, sizeof(AttrNumber));
+	tmp += sizeof(AttrNumber);
+	memcpy(tmp, mcvlist->types, sizeof(Oid) * ndims);
+	tmp += sizeof(Oid) * ndims;
+
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+
+		memcpy(tmp, &item->frequency, sizeof(double));
+		tmp += sizeof(double);
+		memcpy(tmp, &item->base_frequency, sizeof(double));
+		tmp += sizeof(double);
+		memcpy(tmp, item->isnull, sizeof(bool) * ndims);
+		tmp += sizeof(bool) * ndims;
+
+		for (dim = 0; dim < ndims; dim++)
+		{
+			Datum		value = item->values[dim];
+
+			if (item->isnull[dim])
+				continue;
+
+			if (typbyval[dim])
+			{
+				/* go through an aligned Datum, the output may be unaligned */
+				Datum		tmpval;
+
+				store_att_byval(&tmpval, value, typlen[dim]);
+				memcpy(tmp, &tmpval, typlen[dim]);
+				tmp += typlen[dim];
+			}
+			else if (typlen[dim] > 0)
+			{
+				memcpy(tmp, DatumGetPointer(value), typlen[dim]);
+				tmp += typlen[dim];
+			}
+			else
+			{
+				uint32		vlen;
+
+				if (typlen[dim] == -1)
+					vlen = VARSIZE_ANY(DatumGetPointer(value));
+				else
+					vlen = strlen(DatumGetCString(value)) + 1;
+
+				memcpy(tmp, &vlen, sizeof(uint32));
+				tmp += sizeof(uint32);
+				memcpy(tmp, DatumGetPointer(value), vlen);
+				tmp += vlen;
+			}
+		}
+
+		Assert(tmp <= ((char *) output + len));
+	}
+
+	/* we should have used the whole bytea exactly */
+	Assert(tmp == ((char *) output + len));
+
+	return output;
+}
+
+/*
+ * statext_mcv_deserialize
+ *		Reads serialized MCV list into MCVList structure.
+ *
+ * Pass-by-reference values are copied into separately palloc'd chunks, so
+ * that they are properly aligned.
+ */
+MCVList *
+statext_mcv_deserialize(bytea *data)
+{
+	int			i,
+				dim;
+	Size		min_expected_size;
+	MCVList    *mcvlist;
+	int16		typlen[STATS_MAX_DIMENSIONS];
+	bool		typbyval[STATS_MAX_DIMENSIONS];
+	char	   *tmp;
+	char	   *end;
+
+	if (data == NULL)
+		return NULL;
+
+	if (VARSIZE_ANY_EXHDR(data) < SizeOfMCVList)
+		elog(ERROR, "invalid MCV size %zd (expected at least %zd)",
+			 VARSIZE_ANY_EXHDR(data), SizeOfMCVList);
+
+	/* read the MCV list header */
+	mcvlist = (MCVList *) palloc0(sizeof(MCVList));
+
+	/* initialize pointer to the data part (skip the varlena header) */
+	tmp = VARDATA_ANY(data);
+	end = (char *) data + VARSIZE_ANY(data);
+
+	/* read the header fields and perform basic sanity checks */
+	memcpy(&mcvlist->magic, tmp, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(&mcvlist->type, tmp, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(&mcvlist->nitems, tmp, sizeof(uint32));
+	tmp += sizeof(uint32);
+	memcpy(&mcvlist->ndimensions, tmp, sizeof(AttrNumber));
+	tmp += sizeof(AttrNumber);
+
+	if (mcvlist->magic != STATS_MCV_MAGIC)
+		elog(ERROR, "invalid MCV magic %u (expected %u)",
+			 mcvlist->magic, STATS_MCV_MAGIC);
+
+	if (mcvlist->type != STATS_MCV_TYPE_BASIC)
+		elog(ERROR, "invalid MCV type %u (expected %u)",
+			 mcvlist->type, STATS_MCV_TYPE_BASIC);
+
+	if (mcvlist->nitems == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid zero-length item array in MCVList")));
+
+	if ((mcvlist->ndimensions < 2) ||
+		(mcvlist->ndimensions > STATS_MAX_DIMENSIONS))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid number of dimensions %d in MCVList",
+						mcvlist->ndimensions)));
+
+	/* what minimum bytea size do we expect for those parameters */
+	min_expected_size = SizeOfMCVList + mcvlist->ndimensions * sizeof(Oid)
+		+ mcvlist->nitems * ITEM_HEADER_SIZE(mcvlist->ndimensions);
+
+	if (VARSIZE_ANY_EXHDR(data) < min_expected_size)
+		elog(ERROR, "invalid MCV size %zd (expected at least %zd)",
+			 VARSIZE_ANY_EXHDR(data), min_expected_size);
+
+	memcpy(mcvlist->types, tmp, sizeof(Oid) * mcvlist->ndimensions);
+	tmp += sizeof(Oid) * mcvlist->ndimensions;
+
+	for (dim = 0; dim < mcvlist->ndimensions; dim++)
+		get_typlenbyval(mcvlist->types[dim], &typlen[dim], &typbyval[dim]);
+
+	/* allocate space for the MCV items */
+	mcvlist->items = (MCVItem **) palloc(sizeof(MCVItem *) * mcvlist->nitems);
+
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item;
+		int			ndims = mcvlist->ndimensions;
+
+		item = (MCVItem *) palloc(sizeof(MCVItem));
+		item->values = (Datum *) palloc0(sizeof(Datum) * ndims);
+		item->isnull = (bool *) palloc(sizeof(bool) * ndims);
+
+		memcpy(&item->frequency, tmp, sizeof(double));
+		tmp += sizeof(double);
+		memcpy(&item->base_frequency, tmp, sizeof(double));
+		tmp += sizeof(double);
+		memcpy(item->isnull, tmp, sizeof(bool) * ndims);
+		tmp += sizeof(bool) * ndims;
+
+		for (dim = 0; dim < ndims; dim++)
+		{
+			if (item->isnull[dim])
+				continue;
+
+			if (typbyval[dim])
+			{
+				Datum		tmpval = 0;
+
+				memcpy(&tmpval, tmp, typlen[dim]);
+				item->values[dim] = fetch_att(&tmpval, true, typlen[dim]);
+				tmp += typlen[dim];
+			}
+			else if (typlen[dim] > 0)
+			{
+				char	   *value = palloc(typlen[dim]);
+
+				memcpy(value, tmp, typlen[dim]);
+				item->values[dim] = PointerGetDatum(value);
+				tmp += typlen[dim];
+			}
+			else
+			{
+				uint32		vlen;
+				char	   *value;
+
+				memcpy(&vlen, tmp, sizeof(uint32));
+				tmp += sizeof(uint32);
+
+				if (tmp + vlen > end)
+					elog(ERROR, "invalid MCV value length %u", vlen);
+
+				value = palloc(vlen);
+				memcpy(value, tmp, vlen);
+				item->values[dim] = PointerGetDatum(value);
+				tmp += vlen;
+			}
+
+			/* still within the bytea */
+			if (tmp > end)
+				elog(ERROR, "invalid MCV item %d", i);
+		}
+
+		mcvlist->items[i] = item;
+	}
+
+	/* we should have consumed the whole bytea exactly */
+	Assert(tmp == end);
+
+	return mcvlist;
+}
+
+/*
+ * statext_mcv_load
+ *		Load the MCV list for the indicated pg_statistic_ext tuple
+ */
+MCVList *
+statext_mcv_load(Oid mvoid)
+{
+	bool		isnull;
+	Datum		mcvlist;
+	HeapTuple	htup = SearchSysCache1(STATEXTOID, ObjectIdGetDatum(mvoid));
+	MCVList    *result;
+
+	if (!HeapTupleIsValid(htup))
+		elog(ERROR, "cache lookup failed for statistics object %u", mvoid);
+
+	mcvlist = SysCacheGetAttr(STATEXTOID, htup,
+							  Anum_pg_statistic_ext_stxmcv, &isnull);
+	Assert(!isnull);
+
+	/* deserialize before releasing the tuple, the values point into it */
+	result = statext_mcv_deserialize(DatumGetByteaP(mcvlist));
+
+	ReleaseSysCache(htup);
+
+	return result;
+}
+
+/*
+ * pg_mcv_list_in		- input routine for type pg_mcv_list.
+ *
+ * pg_mcv_list is real enough to be a table column, but it has no operations
+ * of its own, and disallows input too
+ */
+Datum
+pg_mcv_list_in(PG_FUNCTION_ARGS)
+{
+	/*
+	 * pg_mcv_list stores the data in binary form and parsing text input is
+	 * not needed, so disallow this.
+	 */
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("cannot accept a value of type %s", "pg_mcv_list")));
+
+	PG_RETURN_VOID();			/* keep compiler quiet */
+}
+
+/*
+ * pg_mcv_list_out		- output routine for type pg_mcv_list.
+ *
+ * Each item is printed as the combination of values, followed by the
+ * frequency and the base frequency, e.g. {(1, a): 0.010000/0.000100}.
+ */
+Datum
+pg_mcv_list_out(PG_FUNCTION_ARGS)
+{
+	bytea	   *data = PG_GETARG_BYTEA_PP(0);
+	MCVList    *mcvlist = statext_mcv_deserialize(data);
+	Oid			outfuncs[STATS_MAX_DIMENSIONS];
+	int			i,
+				dim;
+	StringInfoData str;
+
+	for (dim = 0; dim < mcvlist->ndimensions; dim++)
+	{
+		bool		isvarlena;
+
+		getTypeOutputInfo(mcvlist->types[dim], &outfuncs[dim], &isvarlena);
+	}
+
+	initStringInfo(&str);
+	appendStringInfoChar(&str, '{');
+
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+
+		if (i > 0)
+			appendStringInfoString(&str, ", ");
+
+		appendStringInfoChar(&str, '(');
+		for (dim = 0; dim < mcvlist->ndimensions; dim++)
+		{
+			if (dim > 0)
+				appendStringInfoString(&str, ", ");
+
+			if (item->isnull[dim])
+				appendStringInfoString(&str, "NULL");
+			else
+				appendStringInfoString(&str,
+									   OidOutputFunctionCall(outfuncs[dim],
+															 item->values[dim]));
+		}
+		appendStringInfo(&str, "): %f/%f",
+						 item->frequency, item->base_frequency);
+	}
+
+	appendStringInfoChar(&str, '}');
+
+	PG_RETURN_CSTRING(str.data);
+}
+
+/*
+ * pg_mcv_list_recv		- binary input routine for type pg_mcv_list.
+ */
+Datum
+pg_mcv_list_recv(PG_FUNCTION_ARGS)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("cannot accept a value of type %s", "pg_mcv_list")));
+
+	PG_RETURN_VOID();			/* keep compiler quiet */
+}
+
+/*
+ * pg_mcv_list_send		- binary output routine for type pg_mcv_list.
+ *
+ * MCV lists are serialized in a bytea value (although the type is named
+ * differently), so let's just send that.
+ */
+Datum
+pg_mcv_list_send(PG_FUNCTION_ARGS)
+{
+	return byteasend(fcinfo);
+}
+
+/*
+ * mcv_is_compatible_clause
+ *		Determines if the clause is compatible with MCV lists
+ *
+ * Supported clauses are OpExprs comparing a Var to a Const using an equality
+ * or inequality operator (as determined by the restriction selectivity
+ * estimator), and NullTests on a Var.  When returning True attnum is set to
+ * the attribute number of the Var within the supported clause.
+ *
+ * As the operators get evaluated on the values stored in the MCV list, we
+ * apply the same security check as for per-column statistics.
+ */
+static bool
+mcv_is_compatible_clause(PlannerInfo *root, Node *clause, Index relid,
+						 AttrNumber *attnum)
+{
+	RestrictInfo *rinfo = (RestrictInfo *) clause;
+	Var		   *var;
+	Oid			opfuncoid = InvalidOid;
+
+	if (!IsA(rinfo, RestrictInfo))
+		return false;
+
+	/* Pseudoconstants are not really interesting here. */
+	if (rinfo->pseudoconstant)
+		return false;
+
+	/* clauses referencing multiple varnos are incompatible */
+	if (bms_membership(rinfo->clause_relids) != BMS_SINGLETON)
+		return false;
+
+	if (is_opclause(rinfo->clause))
+	{
+		OpExpr	   *expr = (OpExpr *) rinfo->clause;
+
+		/* Only expressions with two arguments are considered compatible. */
+		if (list_length(expr->args) != 2)
+			return false;
+
+		/* we need the actual value to match it against the MCV items */
+		if (IsA(lsecond(expr->args), Const))
+			var = linitial(expr->args);
+		else if (IsA(linitial(expr->args), Const))
+			var = lsecond(expr->args);
+		else
+			return false;
+
+		/*
+		 * Only consider operators that are estimated as equality or
+		 * inequality, which makes it likely they are well-behaved.
+		 */
+		switch (get_oprrest(expr->opno))
+		{
+			case F_EQSEL:
+			case F_SCALARLTSEL:
+			case F_SCALARGTSEL:
+				break;
+
+			default:
+				return false;
+		}
+
+		opfuncoid = get_opcode(expr->opno);
+	}
+	else if (IsA(rinfo->clause, NullTest))
+	{
+		NullTest   *nt = (NullTest *) rinfo->clause;
+
+		/* row-wise tests are not supported */
+		if (nt->argisrow)
+			return false;
+
+		var = (Var *) nt->arg;
+	}
+	else
+		return false;
+
+	/* We only support plain Vars for now */
+	if (!IsA(var, Var))
+		return false;
+
+	/* Ensure var is from the correct relation */
+	if (var->varno != relid)
+		return false;
+
+	/* we also better ensure the Var is from the current level */
+	if (var->varlevelsup > 0)
+		return false;
+
+	/* Also skip system attributes (we don't allow stats on those). */
+	if (!AttrNumberIsForUserDefinedAttr(var->varattno))
+		return false;
+
+	/* NullTests don't call any functions on the values */
+	if (OidIsValid(opfuncoid))
+	{
+		VariableStatData vardata;
+		bool		ok;
+
+		examine_variable(root, (Node *) var, 0, &vardata);
+		ok = statistic_proc_security_check(&vardata, opfuncoid);
+		ReleaseVariableStats(vardata);
+
+		if (!ok)
+			return false;
+	}
+
+	*attnum = var->varattno;
+	return true;
+}
+
+/*
+ * mcv_item_matches_clause
+ *		Evaluate a compatible clause on the values of the MCV item.
+ *
+ * 'attnums' is the array of attribute numbers of the statistics object, in
+ * the order of the MCV list dimensions.
+ */
+static bool
+mcv_item_matches_clause(MCVItem *item, Node *clause,
+						AttrNumber *attnums, int ndims)
+{
+	Expr	   *expr = ((RestrictInfo *) clause)->clause;
+	Var		   *var;
+	int			dim;
+
+	if (is_opclause(expr))
+	{
+		OpExpr	   *opexpr = (OpExpr *) expr;
+		Const	   *cst;
+		bool		varonleft = IsA(lsecond(opexpr->args), Const);
+		FmgrInfo	opproc;
+		Datum		result;
+
+		if (varonleft)
+		{
+			var = (Var *) linitial(opexpr->args);
+			cst = (Const *) lsecond(opexpr->args);
+		}
+		else
+		{
+			var = (Var *) lsecond(opexpr->args);
+			cst = (Const *) linitial(opexpr->args);
+		}
+
+		for (dim = 0; dim < ndims; dim++)
+			if (attnums[dim] == var->varattno)
+				break;
+		Assert(dim < ndims);
+
+		/* the operators are strict, so NULLs never match */
+		if (cst->constisnull || item->isnull[dim])
+			return false;
+
+		fmgr_info(get_opcode(opexpr->opno), &opproc);
+
+		if (varonleft)
+			result = FunctionCall2Coll(&opproc, opexpr->inputcollid,
+									   item->values[dim], cst->constvalue);
+		else
+			result = FunctionCall2Coll(&opproc, opexpr->inputcollid,
+									   cst->constvalue, item->values[dim]);
+
+		return DatumGetBool(result);
+	}
+	else
+	{
+		NullTest   *nt = (NullTest *) expr;
+
+		Assert(IsA(nt, NullTest));
+
+		var = (Var *) nt->arg;
+
+		for (dim = 0; dim < ndims; dim++)
+			if (attnums[dim] == var->varattno)
+				break;
+		Assert(dim < ndims);
+
+		if (nt->nulltesttype == IS_NULL)
+			return item->isnull[dim];
+		else
+			return !item->isnull[dim];
+	}
+}
+
+/*
+ * mcv_clauselist_selectivity
+ *		Return the estimated selectivity of the given clauses using MCV list
+ *		statistics, or 1.0 if no useful MCV list exists.
+ *
+ * 'estimatedclauses' is an output argument that gets a bit set corresponding
+ * to the (zero-based) list index of clauses that are included in the
+ * estimated selectivity.
+ *
+ * We pick the statistics object covering the most clauses, and evaluate the
+ * compatible clauses on each MCV item.  The MCV list however only covers a
+ * part of the data, so we combine the result with the estimate based on
+ * per-column statistics for the rest:
+ *
+ *	   sel = mcv_sel + (simple_sel - mcv_basesel)
+ *
+ * where mcv_sel is the total frequency of the matching MCV items, simple_sel
+ * is the estimate assuming independence, and mcv_basesel is the part of
+ * simple_sel corresponding to the matching items (the sum of their base
+ * frequencies).  The remaining part is clamped to the fraction of data not
+ * covered by the MCV list.
+ */
+Selectivity
+mcv_clauselist_selectivity(PlannerInfo *root,
+						   List *clauses,
+						   int varRelid,
+						   JoinType jointype,
+						   SpecialJoinInfo *sjinfo,
+						   RelOptInfo *rel,
+						   Bitmapset **estimatedclauses)
+{
+	ListCell   *l;
+	Bitmapset  *clauses_attnums = NULL;
+	StatisticExtInfo *stat;
+	MCVList    *mcvlist;
+	AttrNumber *list_attnums;
+	AttrNumber	stat_attnums[STATS_MAX_DIMENSIONS];
+	List	   *stat_clauses = NIL;
+	Bitmapset  *stat_clauses_idx = NULL;
+	int			listidx;
+	int			ndims;
+	int			i;
+	Selectivity simple_sel = 1.0,
+				mcv_sel = 0.0,
+				mcv_basesel = 0.0,
+				mcv_totalsel = 0.0,
+				other_sel,
+				sel;
+
+	/* check if there's any stats that might be useful for us. */
+	if (!has_stats_of_kind(rel->statlist, STATS_EXT_MCV))
+		return 1.0;
+
+	list_attnums = (AttrNumber *) palloc(sizeof(AttrNumber) *
+										 list_length(clauses));
+
+	/*
+	 * Pre-process the clauses list to extract the attnums seen in each item,
+	 * skipping clauses already estimated by some other method.
+	 */
+	listidx = 0;
+	foreach(l, clauses)
+	{
+		Node	   *clause = (Node *) lfirst(l);
+		AttrNumber	attnum;
+
+		if (!bms_is_member(listidx, *estimatedclauses) &&
+			mcv_is_compatible_clause(root, clause, rel->relid, &attnum))
+		{
+			list_attnums[listidx] = attnum;
+			clauses_attnums = bms_add_member(clauses_attnums, attnum);
+		}
+		else
+			list_attnums[listidx] = InvalidAttrNumber;
+
+		listidx++;
+	}
+
+	/*
+	 * If there's not at least two distinct attnums then reject the whole list
+	 * of clauses. We must return 1.0 so the calling function's selectivity is
+	 * unaffected.
+	 */
+	if (bms_num_members(clauses_attnums) < 2)
+	{
+		pfree(list_attnums);
+		return 1.0;
+	}
+
+	/* find the best suited statistics object for these attnums */
+	stat = choose_best_statistics(rel->statlist, clauses_attnums,
+								  STATS_EXT_MCV);
+
+	/* if no matching stats could be found then we've nothing to do */
+	if (!stat)
+	{
+		pfree(list_attnums);
+		return 1.0;
+	}
+
+	/* collect the clauses covered by the statistics object */
+	listidx = 0;
+	foreach(l, clauses)
+	{
+		if (list_attnums[listidx] != InvalidAttrNumber &&
+			bms_is_member(list_attnums[listidx], stat->keys))
+		{
+			stat_clauses = lappend(stat_clauses, lfirst(l));
+			stat_clauses_idx = bms_add_member(stat_clauses_idx, listidx);
+		}
+
+		listidx++;
+	}
+
+	/* the MCV list dimensions are in the order of attribute numbers */
+	ndims = 0;
+	i = -1;
+	while ((i = bms_next_member(stat->keys, i)) >= 0)
+		stat_attnums[ndims++] = i;
+
+	/* load the MCV list stored in the statistics object */
+	mcvlist = statext_mcv_load(stat->statOid);
+
+	Assert(mcvlist->ndimensions == ndims);
+
+	/* evaluate the clauses on each MCV item */
+	for (i = 0; i < mcvlist->nitems; i++)
+	{
+		MCVItem    *item = mcvlist->items[i];
+		bool		match = true;
+
+		mcv_totalsel += item->frequency;
+
+		foreach(l, stat_clauses)
+		{
+			if (!mcv_item_matches_clause(item, (Node *) lfirst(l),
+										 stat_attnums, ndims))
+			{
+				match = false;
+				break;
+			}
+		}
+
+		if (match)
+		{
+			mcv_sel += item->frequency;
+			mcv_basesel += item->base_frequency;
+		}
+	}
+
+	/* estimate assuming independence, using the per-column statistics */
+	foreach(l, stat_clauses)
+		simple_sel *= clause_selectivity(root, (Node *) lfirst(l), varRelid,
+										 jointype, sjinfo);
+
+	/*
+	 * The estimate for the part of data not covered by the MCV list can't be
+	 * negative, nor exceed the fraction of data not covered by the list.
+	 */
+	other_sel = simple_sel - mcv_basesel;
+	CLAMP_PROBABILITY(other_sel);
+
+	if (other_sel > 1.0 - mcv_totalsel)
+		other_sel = Max(1.0 - mcv_totalsel, 0.0);
+
+	sel = mcv_sel + other_sel;
+	CLAMP_PROBABILITY(sel);
+
+	/* mark the clauses as estimated, so that we don't touch them again */
+	*estimatedclauses = bms_add_members(*estimatedclauses, stat_clauses_idx);
+
+	list_free(stat_clauses);
+	bms_free(stat_clauses_idx);
+	pfree(list_attnums);
+
+	return sel;
+}
@@ -171,6 +171,8 @@ static void KnownAssignedXidsReset(void);
 static inline void ProcArrayEndTransactionInternal(PGPROC *proc,
 								PGXACT *pgxact, TransactionId latestXid);
 static void ProcArrayGroupClearXid(PGPROC *proc, TransactionId latestXid);
+static bool GetSnapshotDataReuse(Snapshot snapshot);
+static void GetSnapshotDataInitOldSnapshot(Snapshot snapshot);
 
 /*
  * Report shared-memory space needed by CreateSharedProcArray.
@@ -245,6 +247,8 @@ CreateSharedProcArray(void)
 		procArray->lastOverflowedXid = InvalidTransactionId;
 		procArray->replication_slot_xmin = InvalidTransactionId;
 		procArray->replication_slot_catalog_xmin = InvalidTransactionId;
+		/* 0 is reserved for snapshots that can't be reused */
+		ShmemVariableCache->xactCompletionCount = 1;
 	}
 
 	allProcs = ProcGlobal->allProcs;
@@ -316,6 +320,14 @@ ProcArrayAdd(PGPROC *proc)
 	arrayP->pgprocnos[index] = proc->pgprocno;
 	arrayP->numProcs++;
 
+	/*
+	 * Adding a prepared transaction's dummy PGPROC can make an XID older than
+	 * existing snapshots' xmax appear as running, so those snapshots must not
+	 * be reused.  Regular backends have no XID yet when they get here.
+	 */
+	if (TransactionIdIsValid(allPgXact[proc->pgprocno].xid))
+		ShmemVariableCache->xactCompletionCount++;
+
 	LWLockRelease(ProcArrayLock);
 }
 
@@ -351,6 +363,9 @@ ProcArrayRemove(PGPROC *proc, TransactionId latestXid)
 		if (TransactionIdPrecedes(ShmemVariableCache->latestCompletedXid,
 								  latestXid))
 			ShmemVariableCache->latestCompletedXid = latestXid;
+
+		/* Same as for ProcArrayEndTransactionInternal */
+		ShmemVariableCache->xactCompletionCount++;
 	}
 	else
 	{
@@ -466,6 +481,9 @@ ProcArrayEndTransactionInternal(PGPROC *proc, PGXACT *pgxact,
 	if (TransactionIdPrecedes(ShmemVariableCache->latestCompletedXid,
 							  latestXid))
 		ShmemVariableCache->latestCompletedXid = latestXid;
+
+	/* Invalidate snapshots that still consider our XID running */
+	ShmemVariableCache->xactCompletionCount++;
 }
 
 /*
@@ -607,11 +625,16 @@ ProcArrayClearTransaction(PGPROC *proc)
 	PGXACT	   *pgxact = &allPgXact[proc->pgprocno];
 
 	/*
-	 * We can skip locking ProcArrayLock here, because this action does not
-	 * actually change anyone's view of the set of running XIDs: our entry is
-	 * duplicate with the gxact that has already been inserted into the
-	 * ProcArray.
+	 * This action does not actually change anyone's view of the set of
+	 * running XIDs: our entry is duplicate with the gxact that has already
+	 * been inserted into the ProcArray.  But snapshots computed by this
+	 * backend don't include its own XID, so they would wrongly treat the
+	 * prepared transaction as completed if they were reused.  Hence we must
+	 * take ProcArrayLock to bump xactCompletionCount.  PREPARE TRANSACTION is
+	 * not frequent enough for that to matter.
 	 */
+	LWLockAcquire(ProcArrayLock, LW_EXCLUSIVE);
+
 	pgxact->xid = InvalidTransactionId;
 	proc->lxid = InvalidLocalTransactionId;
 	pgxact->xmin = InvalidTransactionId;
@@ -624,6 +647,10 @@ ProcArrayClearTransaction(PGPROC *proc)
 	/* Clear the subtransaction-XID cache too */
 	pgxact->nxids = 0;
 	pgxact->overflowed = false;
+
+	ShmemVariableCache->xactCompletionCount++;
+
+	LWLockRelease(ProcArrayLock);
 }
 
 /*
@@ -1502,6 +1529,12 @@ GetMaxSnapshotSubxidCount(void)
  *		RecentGlobalDataXmin: the global xmin for non-catalog tables
  *			>= RecentGlobalXmin
  *
+ * If no transaction has completed since the snapshot passed in was last
+ * computed, its contents are still correct and we reuse them instead of
+ * scanning the ProcArray again; see GetSnapshotDataReuse().  In that case
+ * RecentGlobalXmin and RecentGlobalDataXmin are not recomputed, which is
+ * safe because they can only be older than necessary, never newer.
+ *
  * Note: this function should probably not be called with an argument that's
  * not statically allocated (see xip allocation below).
  */
@@ -1559,6 +1592,12 @@ GetSnapshotData(Snapshot snapshot)
 	 */
 	LWLockAcquire(ProcArrayLock, LW_SHARED);
 
+	if (GetSnapshotDataReuse(snapshot))
+	{
+		LWLockRelease(ProcArrayLock);
+		return snapshot;
+	}
+
 	/* xmax is always latestCompletedXid + 1 */
 	xmax = ShmemVariableCache->latestCompletedXid;
 	Assert(TransactionIdIsNormal(xmax));
@@ -1568,6 +1607,8 @@ GetSnapshotData(Snapshot snapshot)
 	globalxmin = xmin = xmax;
 
 	snapshot->takenDuringRecovery = RecoveryInProgress();
+	snapshot->snapXactCompletionCount = snapshot->takenDuringRecovery ? 0 :
+		ShmemVariableCache->xactCompletionCount;
 
 	if (!snapshot->takenDuringRecovery)
 	{
@@ -1759,6 +1800,73 @@ GetSnapshotData(Snapshot snapshot)
 	snapshot->regd_count = 0;
 	snapshot->copied = false;
 
+	GetSnapshotDataInitOldSnapshot(snapshot);
+
+	return snapshot;
+}
+
+/*
+ * GetSnapshotDataReuse -- helper for GetSnapshotData
+ *
+ * Check whether the snapshot's previously computed contents are still valid,
+ * and if so, prepare it for use as though it had just been computed.  Caller
+ * must hold ProcArrayLock.
+ *
+ * The set of running XIDs only shrinks when a transaction completes; XIDs
+ * assigned after the snapshot was computed are >= its xmax and are treated
+ * as running anyway.  So if xactCompletionCount hasn't changed, a fresh
+ * snapshot would have exactly the same xmin, xmax, and XID arrays.  With
+ * many connections that are mostly idle or read-only, this avoids scanning
+ * the whole ProcArray for every snapshot.
+ *
+ * Snapshots taken during recovery are never reused, since KnownAssignedXids
+ * is maintained without regard to xactCompletionCount.
+ */
+static bool
+GetSnapshotDataReuse(Snapshot snapshot)
+{
+	Assert(LWLockHeldByMe(ProcArrayLock));
+
+	if (snapshot->snapXactCompletionCount == 0 ||
+		snapshot->snapXactCompletionCount !=
+		ShmemVariableCache->xactCompletionCount)
+		return false;
+
+	Assert(!snapshot->takenDuringRecovery);
+
+	/*
+	 * Since no transaction has completed, the transaction that determined
+	 * the snapshot's xmin is still running (or xmin is still
+	 * latestCompletedXid + 1), so nobody can have computed a global xmin
+	 * newer than it.  That makes it safe to advertise it as our xmin, just
+	 * as if we had computed it afresh.
+	 */
+	if (!TransactionIdIsValid(MyPgXact->xmin))
+		MyPgXact->xmin = TransactionXmin = snapshot->xmin;
+
+	RecentXmin = snapshot->xmin;
+	Assert(TransactionIdPrecedesOrEquals(TransactionXmin, RecentXmin));
+
+	snapshot->curcid = GetCurrentCommandId(false);
+
+	/* As in GetSnapshotData, this counts as a new snapshot */
+	snapshot->active_count = 0;
+	snapshot->regd_count = 0;
+	snapshot->copied = false;
+
+	GetSnapshotDataInitOldSnapshot(snapshot);
+
+	return true;
+}
+
+/*
+ * GetSnapshotDataInitOldSnapshot -- helper for GetSnapshotData
+ *
+ * Fill in the fields used by the "snapshot too old" feature.
+ */
+static void
+GetSnapshotDataInitOldSnapshot(Snapshot snapshot)
+{
 	if (old_snapshot_threshold < 0)
 	{
 		/*
@@ -1777,10 +1885,8 @@ GetSnapshotData(Snapshot snapshot)
 		 */
 		snapshot->lsn = GetXLogInsertRecPtr();
 		snapshot->whenTaken = GetSnapshotCurrentTimestamp();
-		MaintainOldSnapshotTimeMapping(snapshot->whenTaken, xmin);
+		MaintainOldSnapshotTimeMapping(snapshot->whenTaken, snapshot->xmin);
 	}
-
-	return snapshot;
 }
 
 /*
@@ -3077,6 +3183,9 @@ XidCacheRemoveRunningXids(TransactionId xid,
 							  latestXid))
 		ShmemVariableCache->latestCompletedXid = latestXid;
 
+	/* The aborted subtransactions are no longer running, either */
+	ShmemVariableCache->xactCompletionCount++;
+
 	LWLockRelease(ProcArrayLock);
 }
 
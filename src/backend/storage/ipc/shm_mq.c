@@ -42,8 +42,12 @@
  * simple for now.
  *
  * mq_detached can be set by either the sender or the receiver, so the mutex
- * must be held to read or write it.  Memory barriers could be used here as
- * well, if needed.
+ * must be held to write it, and normally to read it.  The one exception is
+ * the sender checking it while its cached copy of mq_bytes_read shows enough
+ * space, so that it needn't take the lock just for that; as the flag only
+ * ever goes from false to true, a stale value merely means the detach is
+ * noticed on the next pass.  Memory barriers could be used here as well, if
+ * needed.
  *
  * mq_ring_size and mq_ring_offset never change after initialization, and
  * can therefore be read without the lock.
@@ -65,6 +69,21 @@
  * data it's already marked as read, or to write any data; and it would be
  * unsafe for the sender to reread any data after incrementing
  * mq_bytes_written, but fortunately there's no need for any of that.
+ *
+ * Taking the spinlock and setting the other side's latch for every message
+ * adds up when messages are small, as with tuples sent to a Gather node, so
+ * both sides report their progress in batches.  Unless the caller of
+ * shm_mq_sendv() asks for the message to be flushed, the sender doesn't
+ * advance mq_bytes_written for it; it just adds it to mq_send_pending,
+ * which only the sender looks at, and publishes those bytes once they
+ * amount to a quarter of the ring, when the ring fills up, or when it
+ * detaches.  Likewise, the receiver lets the bytes it has consumed pile up
+ * in mqh_consume_pending, and only advances mq_bytes_read once they amount
+ * to a quarter of the ring, or before it waits or gives up for want of
+ * data.  Each side also remembers the other's counter as of the last time
+ * it took the lock, and only takes it again if that doesn't show enough
+ * data or space.  Since the counters only ever move forward, a stale value
+ * just makes a process more pessimistic than it needs to be.
  */
 struct shm_mq
 {
@@ -73,6 +92,7 @@ struct shm_mq
 	PGPROC	   *mq_sender;
 	uint64		mq_bytes_read;
 	uint64		mq_bytes_written;
+	Size		mq_send_pending;
 	Size		mq_ring_size;
 	bool		mq_detached;
 	uint8		mq_ring_offset;
@@ -119,6 +139,11 @@ struct shm_mq
  * attached to the queue at some previous point.  This lets us avoid some
  * mutex acquisitions.
  *
+ * mqh_consume_pending is the number of bytes the receiver has consumed but
+ * not yet reported by advancing mq_bytes_read.  mqh_known_count is the last
+ * value of the counterparty's counter we have seen: mq_bytes_read if we're
+ * the sender, mq_bytes_written if we're the receiver.
+ *
  * mqh_context is the memory context in effect at the time we attached to
  * the shm_mq.  The shm_mq_handle itself is allocated in this context, and
  * we make sure any other allocations we do happen in this context as well,
@@ -132,6 +157,7 @@ struct shm_mq_handle
 	char	   *mqh_buffer;
 	Size		mqh_buflen;
 	Size		mqh_consume_pending;
+	uint64		mqh_known_count;
 	Size		mqh_partial_bytes;
 	Size		mqh_expected_bytes;
 	bool		mqh_length_word_complete;
@@ -141,8 +167,9 @@ struct shm_mq_handle
 
 static shm_mq_result shm_mq_send_bytes(shm_mq_handle *mq, Size nbytes,
 				  const void *data, bool nowait, Size *bytes_written);
-static shm_mq_result shm_mq_receive_bytes(shm_mq *mq, Size bytes_needed,
-					 bool nowait, Size *nbytesp, void **datap);
+static shm_mq_result shm_mq_receive_bytes(shm_mq_handle *mqh,
+					 Size bytes_needed, bool nowait, Size *nbytesp,
+					 void **datap);
 static bool shm_mq_counterparty_gone(volatile shm_mq *mq,
 						 BackgroundWorkerHandle *handle);
 static bool shm_mq_wait_internal(volatile shm_mq *mq, PGPROC *volatile *ptr,
@@ -181,6 +208,7 @@ shm_mq_create(void *address, Size size)
 	mq->mq_sender = NULL;
 	mq->mq_bytes_read = 0;
 	mq->mq_bytes_written = 0;
+	mq->mq_send_pending = 0;
 	mq->mq_ring_size = size - data_offset;
 	mq->mq_detached = false;
 	mq->mq_ring_offset = data_offset - offsetof(shm_mq, mq_ring);
@@ -292,6 +320,7 @@ shm_mq_attach(shm_mq *mq, dsm_segment *seg, BackgroundWorkerHandle *handle)
 	mqh->mqh_handle = handle;
 	mqh->mqh_buflen = 0;
 	mqh->mqh_consume_pending = 0;
+	mqh->mqh_known_count = 0;
 	mqh->mqh_context = CurrentMemoryContext;
 	mqh->mqh_partial_bytes = 0;
 	mqh->mqh_length_word_complete = false;
@@ -318,14 +347,15 @@ shm_mq_set_handle(shm_mq_handle *mqh, BackgroundWorkerHandle *handle)
  * Write a message into a shared message queue.
  */
 shm_mq_result
-shm_mq_send(shm_mq_handle *mqh, Size nbytes, const void *data, bool nowait)
+shm_mq_send(shm_mq_handle *mqh, Size nbytes, const void *data, bool nowait,
+			bool force_flush)
 {
 	shm_mq_iovec iov;
 
 	iov.data = data;
 	iov.len = nbytes;
 
-	return shm_mq_sendv(mqh, &iov, 1, nowait);
+	return shm_mq_sendv(mqh, &iov, 1, nowait, force_flush);
 }
 
 /*
@@ -342,9 +372,16 @@ shm_mq_send(shm_mq_handle *mqh, Size nbytes, const void *data, bool nowait)
  * arguments, each time the process latch is set.  (Once begun, the sending
  * of a message cannot be aborted except by detaching from the queue; changing
  * the length or payload will corrupt the queue.)
+ *
+ * When force_flush = true, the message is made visible to the receiver, and
+ * the receiver's latch is set, before we return.  Otherwise, that may be put
+ * off until more data has been written, or until we detach from the queue;
+ * that is much cheaper when sending many small messages, but a receiver
+ * waiting for this particular message might have to wait a while longer.
  */
 shm_mq_result
-shm_mq_sendv(shm_mq_handle *mqh, shm_mq_iovec *iov, int iovcnt, bool nowait)
+shm_mq_sendv(shm_mq_handle *mqh, shm_mq_iovec *iov, int iovcnt, bool nowait,
+			 bool force_flush)
 {
 	shm_mq_result res;
 	shm_mq	   *mq = mqh->mqh_queue;
@@ -488,7 +525,16 @@ shm_mq_sendv(shm_mq_handle *mqh, shm_mq_iovec *iov, int iovcnt, bool nowait)
 	mqh->mqh_partial_bytes = 0;
 	mqh->mqh_length_word_complete = false;
 
+	/*
+	 * Unless asked to flush, leave the message unpublished until enough data
+	 * has piled up to be worth waking the receiver for.
+	 */
+	if (!force_flush && mq->mq_send_pending <= mq->mq_ring_size / 4)
+		return SHM_MQ_SUCCESS;
+
 	/* Notify receiver of the newly-written data, and return. */
+	shm_mq_inc_bytes_written(mq, mq->mq_send_pending);
+	mq->mq_send_pending = 0;
 	return shm_mq_notify_receiver(mq);
 }
 
@@ -561,8 +607,12 @@ shm_mq_receive(shm_mq_handle *mqh, Size *nbytesp, void **datap, bool nowait)
 		mqh->mqh_counterparty_attached = true;
 	}
 
-	/* Consume any zero-copy data from previous receive operation. */
-	if (mqh->mqh_consume_pending > 0)
+	/*
+	 * Consume any zero-copy data from previous receive operations, if enough
+	 * of it has piled up to be worth telling the sender about.  Otherwise,
+	 * shm_mq_receive_bytes will do it if it runs out of data.
+	 */
+	if (mqh->mqh_consume_pending > mq->mq_ring_size / 4)
 	{
 		shm_mq_inc_bytes_read(mq, mqh->mqh_consume_pending);
 		mqh->mqh_consume_pending = 0;
@@ -573,7 +623,7 @@ shm_mq_receive(shm_mq_handle *mqh, Size *nbytesp, void **datap, bool nowait)
 	{
 		/* Try to receive the message length word. */
 		Assert(mqh->mqh_partial_bytes < sizeof(Size));
-		res = shm_mq_receive_bytes(mq, sizeof(Size) - mqh->mqh_partial_bytes,
+		res = shm_mq_receive_bytes(mqh, sizeof(Size) - mqh->mqh_partial_bytes,
 								   nowait, &rb, &rawdata);
 		if (res != SHM_MQ_SUCCESS)
 			return res;
@@ -599,7 +649,7 @@ shm_mq_receive(shm_mq_handle *mqh, Size *nbytesp, void **datap, bool nowait)
 				 * memory wouldn't be free and in most cases we would reap no
 				 * benefit.
 				 */
-				mqh->mqh_consume_pending = needed;
+				mqh->mqh_consume_pending += needed;
 				*nbytesp = nbytes;
 				*datap = ((char *) rawdata) + MAXALIGN(sizeof(Size));
 				return SHM_MQ_SUCCESS;
@@ -660,13 +710,13 @@ shm_mq_receive(shm_mq_handle *mqh, Size *nbytesp, void **datap, bool nowait)
 		 * we need not copy the data and can return a pointer directly into
 		 * shared memory.
 		 */
-		res = shm_mq_receive_bytes(mq, nbytes, nowait, &rb, &rawdata);
+		res = shm_mq_receive_bytes(mqh, nbytes, nowait, &rb, &rawdata);
 		if (res != SHM_MQ_SUCCESS)
 			return res;
 		if (rb >= nbytes)
 		{
 			mqh->mqh_length_word_complete = false;
-			mqh->mqh_consume_pending = MAXALIGN(nbytes);
+			mqh->mqh_consume_pending += MAXALIGN(nbytes);
 			*nbytesp = nbytes;
 			*datap = rawdata;
 			return SHM_MQ_SUCCESS;
@@ -720,7 +770,7 @@ shm_mq_receive(shm_mq_handle *mqh, Size *nbytesp, void **datap, bool nowait)
 
 		/* Wait for some more data. */
 		still_needed = nbytes - mqh->mqh_partial_bytes;
-		res = shm_mq_receive_bytes(mq, still_needed, nowait, &rb, &rawdata);
+		res = shm_mq_receive_bytes(mqh, still_needed, nowait, &rb, &rawdata);
 		if (res != SHM_MQ_SUCCESS)
 			return res;
 		if (rb > still_needed)
@@ -773,6 +823,9 @@ shm_mq_wait_for_attach(shm_mq_handle *mqh)
  * detaches, the receiver can read any messages remaining in the queue;
  * further reads will return SHM_MQ_DETACHED.  If the receiver detaches,
  * further attempts to send messages will likewise return SHM_MQ_DETACHED.
+ *
+ * If the sender detaches, any messages it has not yet published are
+ * published now, so that the receiver can read them.
  */
 void
 shm_mq_detach(shm_mq *mq)
@@ -782,7 +835,11 @@ shm_mq_detach(shm_mq *mq)
 
 	SpinLockAcquire(&mq->mq_mutex);
 	if (vmq->mq_sender == MyProc)
+	{
 		victim = vmq->mq_receiver;
+		vmq->mq_bytes_written += vmq->mq_send_pending;
+		vmq->mq_send_pending = 0;
+	}
 	else
 	{
 		Assert(vmq->mq_receiver == MyProc);
@@ -819,13 +876,34 @@ shm_mq_send_bytes(shm_mq_handle *mqh, Size nbytes, const void *data,
 
 	while (sent < nbytes)
 	{
-		bool		detached;
+		bool		detached = false;
 		uint64		rb;
+		uint64		wb;
 
-		/* Compute number of ring buffer bytes used and available. */
-		rb = shm_mq_get_bytes_read(mq, &detached);
-		Assert(mq->mq_bytes_written >= rb);
-		used = mq->mq_bytes_written - rb;
+		/*
+		 * Compute number of ring buffer bytes used and available.  The last
+		 * value of mq_bytes_read we saw will do, if it leaves room for all
+		 * the bytes we have to write.
+		 */
+		wb = mq->mq_bytes_written + mq->mq_send_pending;
+		rb = mqh->mqh_known_count;
+		Assert(wb >= rb);
+		if (ringsize - (wb - rb) < nbytes - sent)
+		{
+			rb = shm_mq_get_bytes_read(mq, &detached);
+			mqh->mqh_known_count = rb;
+		}
+		else
+		{
+			/*
+			 * We still have to notice if the receiver has gone away, rather
+			 * than keep writing until the ring fills; see the notes on
+			 * mq_detached at the top of this file.
+			 */
+			detached = ((volatile shm_mq *) mq)->mq_detached;
+		}
+		Assert(wb >= rb);
+		used = wb - rb;
 		Assert(used <= ringsize);
 		available = Min(ringsize - used, nbytes - sent);
 
@@ -873,7 +951,15 @@ shm_mq_send_bytes(shm_mq_handle *mqh, Size nbytes, const void *data,
 		{
 			shm_mq_result res;
 
-			/* Let the receiver know that we need them to read some data. */
+			/*
+			 * Publish everything we've written, and let the receiver know
+			 * that we need them to read some data.
+			 */
+			if (mq->mq_send_pending > 0)
+			{
+				shm_mq_inc_bytes_written(mq, mq->mq_send_pending);
+				mq->mq_send_pending = 0;
+			}
 			res = shm_mq_notify_receiver(mq);
 			if (res != SHM_MQ_SUCCESS)
 			{
@@ -905,7 +991,7 @@ shm_mq_send_bytes(shm_mq_handle *mqh, Size nbytes, const void *data,
 		}
 		else
 		{
-			Size		offset = mq->mq_bytes_written % (uint64) ringsize;
+			Size		offset = wb % (uint64) ringsize;
 			Size		sendnow = Min(available, ringsize - offset);
 
 			/* Write as much data as we can via a single memcpy(). */
@@ -920,12 +1006,12 @@ shm_mq_send_bytes(shm_mq_handle *mqh, Size nbytes, const void *data,
 			 * MAXIMUM_ALIGNOF, and each read is as well.
 			 */
 			Assert(sent == nbytes || sendnow == MAXALIGN(sendnow));
-			shm_mq_inc_bytes_written(mq, MAXALIGN(sendnow));
+			mq->mq_send_pending += MAXALIGN(sendnow);
 
 			/*
-			 * For efficiency, we don't set the reader's latch here.  We'll do
-			 * that only when the buffer fills up or after writing an entire
-			 * message.
+			 * For efficiency, we don't publish the bytes or set the reader's
+			 * latch here.  We'll do that only when the buffer fills up, or
+			 * after writing an entire message if shm_mq_sendv sees fit.
 			 */
 		}
 	}
@@ -944,9 +1030,10 @@ shm_mq_send_bytes(shm_mq_handle *mqh, Size nbytes, const void *data,
  * is SHM_MQ_SUCCESS.
  */
 static shm_mq_result
-shm_mq_receive_bytes(shm_mq *mq, Size bytes_needed, bool nowait,
+shm_mq_receive_bytes(shm_mq_handle *mqh, Size bytes_needed, bool nowait,
 					 Size *nbytesp, void **datap)
 {
+	shm_mq	   *mq = mqh->mqh_queue;
 	Size		ringsize = mq->mq_ring_size;
 	uint64		used;
 	uint64		written;
@@ -954,13 +1041,27 @@ shm_mq_receive_bytes(shm_mq *mq, Size bytes_needed, bool nowait,
 	for (;;)
 	{
 		Size		offset;
-		bool		detached;
+		uint64		read;
+		bool		detached = false;
 
-		/* Get bytes written, so we can compute what's available to read. */
-		written = shm_mq_get_bytes_written(mq, &detached);
-		used = written - mq->mq_bytes_read;
+		/*
+		 * Get bytes written, so we can compute what's available to read.
+		 * Bytes we've consumed but not yet reported are not available.  The
+		 * last value of mq_bytes_written we saw will do, if it shows enough
+		 * data.
+		 */
+		read = mq->mq_bytes_read + mqh->mqh_consume_pending;
+		written = mqh->mqh_known_count;
+		Assert(written >= read);
+		used = written - read;
+		offset = read % (uint64) ringsize;
+		if (used < bytes_needed && offset + used < ringsize)
+		{
+			written = shm_mq_get_bytes_written(mq, &detached);
+			mqh->mqh_known_count = written;
+			used = written - read;
+		}
 		Assert(used <= ringsize);
-		offset = mq->mq_bytes_read % (uint64) ringsize;
 
 		/* If we have enough data or buffer has wrapped, we're done. */
 		if (used >= bytes_needed || offset + used >= ringsize)
@@ -981,6 +1082,17 @@ shm_mq_receive_bytes(shm_mq *mq, Size bytes_needed, bool nowait,
 		if (detached)
 			return SHM_MQ_DETACHED;
 
+		/*
+		 * Before we wait, or let the caller go off and do something else,
+		 * report the bytes we've consumed, in case the sender is waiting for
+		 * room in the ring.
+		 */
+		if (mqh->mqh_consume_pending > 0)
+		{
+			shm_mq_inc_bytes_read(mq, mqh->mqh_consume_pending);
+			mqh->mqh_consume_pending = 0;
+		}
+
 		/* Skip manipulation of our latch if nowait = true. */
 		if (nowait)
 			return SHM_MQ_WOULD_BLOCK;
@@ -163,30 +163,54 @@ typedef struct TwoPhaseLockRecord
 
 
 /*
- * Count of the number of fast path lock slots we believe to be used.  This
- * might be higher than the real number if another backend has transferred
- * our locks to the primary lock table, but it can never be lower than the
- * real value, since only we can acquire locks on our own behalf.
+ * Number of groups of fast-path lock slots per backend; see
+ * InitializeFastPathLocks().
  */
-static int	FastPathLocalUseCount = 0;
+int			FastPathLockGroupsPerBackend = 0;
+
+/*
+ * Count of the number of fast path lock slots we believe to be used in each
+ * group.  This might be higher than the real number if another backend has
+ * transferred our locks to the primary lock table, but it can never be lower
+ * than the real value, since only we can acquire locks on our own behalf.
+ */
+static int	FastPathLocalUseCounts[FP_LOCK_GROUPS_PER_BACKEND_MAX];
+
+/*
+ * Macros for locating fast-path slots.  A relation can only be stored in the
+ * group chosen by hashing its OID, so lookups only examine that group.  Slot
+ * numbers are global across groups, i.e. slot n lives in group
+ * n / FP_LOCK_SLOTS_PER_GROUP.
+ */
+#define FAST_PATH_REL_GROUP(rel) \
+	((uint32) (((uint64) (rel) * 49157) & (FastPathLockGroupsPerBackend - 1)))
+#define FAST_PATH_SLOT(group, index) \
+	(AssertMacro((uint32) (group) < FastPathLockGroupsPerBackend), \
+	 AssertMacro((uint32) (index) < FP_LOCK_SLOTS_PER_GROUP), \
+	 ((group) * FP_LOCK_SLOTS_PER_GROUP + (index)))
+#define FAST_PATH_GROUP(n)				((n) / FP_LOCK_SLOTS_PER_GROUP)
+#define FAST_PATH_INDEX(n)				((n) % FP_LOCK_SLOTS_PER_GROUP)
 
 /* Macros for manipulating proc->fpLockBits */
 #define FAST_PATH_BITS_PER_SLOT			3
 #define FAST_PATH_LOCKNUMBER_OFFSET		1
 #define FAST_PATH_MASK					((1 << FAST_PATH_BITS_PER_SLOT) - 1)
+#define FAST_PATH_BITS(proc, n)			(proc)->fpLockBits[FAST_PATH_GROUP(n)]
 #define FAST_PATH_GET_BITS(proc, n) \
-	(((proc)->fpLockBits >> (FAST_PATH_BITS_PER_SLOT * n)) & FAST_PATH_MASK)
+	((FAST_PATH_BITS(proc, n) >> \
+	  (FAST_PATH_BITS_PER_SLOT * FAST_PATH_INDEX(n))) & FAST_PATH_MASK)
 #define FAST_PATH_BIT_POSITION(n, l) \
 	(AssertMacro((l) >= FAST_PATH_LOCKNUMBER_OFFSET), \
 	 AssertMacro((l) < FAST_PATH_BITS_PER_SLOT+FAST_PATH_LOCKNUMBER_OFFSET), \
-	 AssertMacro((n) < FP_LOCK_SLOTS_PER_BACKEND), \
-	 ((l) - FAST_PATH_LOCKNUMBER_OFFSET + FAST_PATH_BITS_PER_SLOT * (n)))
+	 AssertMacro((n) < FastPathLockSlotsPerBackend()), \
+	 ((l) - FAST_PATH_LOCKNUMBER_OFFSET + \
+	  FAST_PATH_BITS_PER_SLOT * FAST_PATH_INDEX(n)))
 #define FAST_PATH_SET_LOCKMODE(proc, n, l) \
-	 (proc)->fpLockBits |= UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)
+	 FAST_PATH_BITS(proc, n) |= UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)
 #define FAST_PATH_CLEAR_LOCKMODE(proc, n, l) \
-	 (proc)->fpLockBits &= ~(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l))
+	 FAST_PATH_BITS(proc, n) &= ~(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l))
 #define FAST_PATH_CHECK_LOCKMODE(proc, n, l) \
-	 ((proc)->fpLockBits & (UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)))
+	 (FAST_PATH_BITS(proc, n) & (UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)))
 
 /*
  * The fast-path lock mechanism is concerned only with relation locks on
@@ -821,16 +845,18 @@ LockAcquireExtended(const LOCKTAG *locktag,
 
 	/*
 	 * Attempt to take lock via fast path, if eligible.  But if we remember
-	 * having filled up the fast path array, we don't attempt to make any
-	 * further use of it until we release some locks.  It's possible that some
-	 * other backend has transferred some of those locks to the shared hash
-	 * table, leaving space free, but it's not worth acquiring the LWLock just
-	 * to check.  It's also possible that we're acquiring a second or third
-	 * lock type on a relation we have already locked using the fast-path, but
-	 * for now we don't worry about that case either.
+	 * having filled up the fast path group this relation maps to, we don't
+	 * attempt to make any further use of it until we release some locks.
+	 * It's possible that some other backend has transferred some of those
+	 * locks to the shared hash table, leaving space free, but it's not worth
+	 * acquiring the LWLock just to check.  It's also possible that we're
+	 * acquiring a second or third lock type on a relation we have already
+	 * locked using the fast-path, but for now we don't worry about that case
+	 * either.
 	 */
 	if (EligibleForRelationFastPath(locktag, lockmode) &&
-		FastPathLocalUseCount < FP_LOCK_SLOTS_PER_BACKEND)
+		FastPathLocalUseCounts[FAST_PATH_REL_GROUP(locktag->locktag_field2)] <
+		FP_LOCK_SLOTS_PER_GROUP)
 	{
 		uint32		fasthashcode = FastPathStrongLockHashPartition(hashcode);
 		bool		acquired;
@@ -1353,6 +1379,29 @@ LockCheckConflicts(LockMethod lockMethodTable,
 		return STATUS_FOUND;
 	}
 
+	/*
+	 * Relation extension and page locks protect physical structures rather
+	 * than logical ones, so they must conflict even between members of a
+	 * lock group; otherwise two parallel workers inserting into the same
+	 * relation could both extend it at once.
+	 *
+	 * The deadlock detector treats a lock group as a single process, so it
+	 * can't see a cycle among members of the same group waiting on these
+	 * locks.  That's OK because no such cycle can form: the relation
+	 * extension lock is never held while acquiring any other heavyweight
+	 * lock, and a page lock (taken only by GIN pending-list cleanup) is held
+	 * while acquiring nothing but a relation extension lock.  Since the two
+	 * are always taken in that order, a member waiting for one of them is
+	 * waiting for a holder that will release it without blocking on us.
+	 */
+	if (lock->tag.locktag_type == LOCKTAG_RELATION_EXTEND ||
+		lock->tag.locktag_type == LOCKTAG_PAGE)
+	{
+		PROCLOCK_PRINT("LockCheckConflicts: conflicting (group)",
+					   proclock);
+		return STATUS_FOUND;
+	}
+
 	/*
 	 * Locks held in conflicting modes by members of our own lock group are
 	 * not real conflicts; we can subtract those out and see if we still have
@@ -1911,7 +1960,7 @@ LockRelease(const LOCKTAG *locktag, LOCKMODE lockmode, bool sessionLock)
 
 	/* Attempt fast release of any lock eligible for the fast path. */
 	if (EligibleForRelationFastPath(locktag, lockmode) &&
-		FastPathLocalUseCount > 0)
+		FastPathLocalUseCounts[FAST_PATH_REL_GROUP(locktag->locktag_field2)] > 0)
 	{
 		bool		released;
 
@@ -2488,12 +2537,15 @@ LockReassignOwner(LOCALLOCK *locallock, ResourceOwner parent)
 static bool
 FastPathGrantRelationLock(Oid relid, LOCKMODE lockmode)
 {
-	uint32		f;
-	uint32		unused_slot = FP_LOCK_SLOTS_PER_BACKEND;
+	uint32		i;
+	uint32		unused_slot = FastPathLockSlotsPerBackend();
+	uint32		group = FAST_PATH_REL_GROUP(relid);
 
 	/* Scan for existing entry for this relid, remembering empty slot. */
-	for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+	for (i = 0; i < FP_LOCK_SLOTS_PER_GROUP; i++)
 	{
+		uint32		f = FAST_PATH_SLOT(group, i);
+
 		if (FAST_PATH_GET_BITS(MyProc, f) == 0)
 			unused_slot = f;
 		else if (MyProc->fpRelId[f] == relid)
@@ -2505,11 +2557,11 @@ FastPathGrantRelationLock(Oid relid, LOCKMODE lockmode)
 	}
 
 	/* If no existing entry, use any empty slot. */
-	if (unused_slot < FP_LOCK_SLOTS_PER_BACKEND)
+	if (unused_slot < FastPathLockSlotsPerBackend())
 	{
 		MyProc->fpRelId[unused_slot] = relid;
 		FAST_PATH_SET_LOCKMODE(MyProc, unused_slot, lockmode);
-		++FastPathLocalUseCount;
+		++FastPathLocalUseCounts[group];
 		return true;
 	}
 
@@ -2525,22 +2577,25 @@ FastPathGrantRelationLock(Oid relid, LOCKMODE lockmode)
 static bool
 FastPathUnGrantRelationLock(Oid relid, LOCKMODE lockmode)
 {
-	uint32		f;
+	uint32		i;
+	uint32		group = FAST_PATH_REL_GROUP(relid);
 	bool		result = false;
 
-	FastPathLocalUseCount = 0;
-	for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+	FastPathLocalUseCounts[group] = 0;
+	for (i = 0; i < FP_LOCK_SLOTS_PER_GROUP; i++)
 	{
+		uint32		f = FAST_PATH_SLOT(group, i);
+
 		if (MyProc->fpRelId[f] == relid
 			&& FAST_PATH_CHECK_LOCKMODE(MyProc, f, lockmode))
 		{
 			Assert(!result);
 			FAST_PATH_CLEAR_LOCKMODE(MyProc, f, lockmode);
 			result = true;
-			/* we continue iterating so as to update FastPathLocalUseCount */
+			/* we continue iterating so as to update FastPathLocalUseCounts */
 		}
 		if (FAST_PATH_GET_BITS(MyProc, f) != 0)
-			++FastPathLocalUseCount;
+			++FastPathLocalUseCounts[group];
 	}
 	return result;
 }
@@ -2558,6 +2613,7 @@ FastPathTransferRelationLocks(LockMethod lockMethodTable, const LOCKTAG *locktag
 {
 	LWLock	   *partitionLock = LockHashPartitionLock(hashcode);
 	Oid			relid = locktag->locktag_field2;
+	uint32		group = FAST_PATH_REL_GROUP(relid);
 	uint32		i;
 
 	/*
@@ -2569,7 +2625,7 @@ FastPathTransferRelationLocks(LockMethod lockMethodTable, const LOCKTAG *locktag
 	for (i = 0; i < ProcGlobal->allProcCount; i++)
 	{
 		PGPROC	   *proc = &ProcGlobal->allProcs[i];
-		uint32		f;
+		uint32		j;
 
 		LWLockAcquire(&proc->backendLock, LW_EXCLUSIVE);
 
@@ -2594,8 +2650,9 @@ FastPathTransferRelationLocks(LockMethod lockMethodTable, const LOCKTAG *locktag
 			continue;
 		}
 
-		for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+		for (j = 0; j < FP_LOCK_SLOTS_PER_GROUP; j++)
 		{
+			uint32		f = FAST_PATH_SLOT(group, j);
 			uint32		lockmode;
 
 			/* Look for an allocated slot matching the given relid. */
@@ -2648,12 +2705,14 @@ FastPathGetRelationLockEntry(LOCALLOCK *locallock)
 	PROCLOCK   *proclock = NULL;
 	LWLock	   *partitionLock = LockHashPartitionLock(locallock->hashcode);
 	Oid			relid = locktag->locktag_field2;
-	uint32		f;
+	uint32		group = FAST_PATH_REL_GROUP(relid);
+	uint32		i;
 
 	LWLockAcquire(&MyProc->backendLock, LW_EXCLUSIVE);
 
-	for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+	for (i = 0; i < FP_LOCK_SLOTS_PER_GROUP; i++)
 	{
+		uint32		f = FAST_PATH_SLOT(group, i);
 		uint32		lockmode;
 
 		/* Look for an allocated slot matching the given relid. */
@@ -2792,6 +2851,7 @@ GetLockConflicts(const LOCKTAG *locktag, LOCKMODE lockmode)
 	{
 		int			i;
 		Oid			relid = locktag->locktag_field2;
+		uint32		group = FAST_PATH_REL_GROUP(relid);
 		VirtualTransactionId vxid;
 
 		/*
@@ -2807,7 +2867,7 @@ GetLockConflicts(const LOCKTAG *locktag, LOCKMODE lockmode)
 		for (i = 0; i < ProcGlobal->allProcCount; i++)
 		{
 			PGPROC	   *proc = &ProcGlobal->allProcs[i];
-			uint32		f;
+			uint32		j;
 
 			/* A backend never blocks itself */
 			if (proc == MyProc)
@@ -2829,8 +2889,9 @@ GetLockConflicts(const LOCKTAG *locktag, LOCKMODE lockmode)
 				continue;
 			}
 
-			for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++)
+			for (j = 0; j < FP_LOCK_SLOTS_PER_GROUP; j++)
 			{
+				uint32		f = FAST_PATH_SLOT(group, j);
 				uint32		lockmask;
 
 				/* Look for an allocated slot matching the given relid. */
@@ -3430,12 +3491,20 @@ GetLockStatusData(void)
 
 		LWLockAcquire(&proc->backendLock, LW_SHARED);
 
-		for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; ++f)
+		for (f = 0; f < FastPathLockSlotsPerBackend(); ++f)
 		{
 			LockInstanceData *instance;
-			uint32		lockbits = FAST_PATH_GET_BITS(proc, f);
+			uint32		lockbits;
+
+			/* Skip groups with no allocated slots at all. */
+			if (FAST_PATH_INDEX(f) == 0 && proc->fpLockBits[FAST_PATH_GROUP(f)] == 0)
+			{
+				f += FP_LOCK_SLOTS_PER_GROUP - 1;
+				continue;
+			}
 
 			/* Skip unallocated slots. */
+			lockbits = FAST_PATH_GET_BITS(proc, f);
 			if (!lockbits)
 				continue;
 
@@ -511,6 +511,9 @@ RegisterLWLockTranches(void)
 	LWLockRegisterTranche(LWTRANCHE_PARALLEL_QUERY_DSA,
 						  "parallel_query_dsa");
 	LWLockRegisterTranche(LWTRANCHE_TBM, "tbm");
+	LWLockRegisterTranche(LWTRANCHE_RECORD_TYPMOD_DSA, "record_typmod_dsa");
+	LWLockRegisterTranche(LWTRANCHE_RECORD_TYPMOD_REGISTRY,
+						  "record_typmod_registry");
 
 	/* Register named tranches. */
 	for (i = 0; i < NamedLWLockTrancheRequests; i++)
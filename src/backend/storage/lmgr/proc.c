@@ -61,6 +61,7 @@ int			DeadlockTimeout = 1000;
 int			StatementTimeout = 0;
 int			LockTimeout = 0;
 int			IdleInTransactionSessionTimeout = 0;
+int			IdleSessionTimeout = 0;
 bool		log_lock_waits = false;
 
 /* Pointer to this process's PGPROC and PGXACT structs, if any */
@@ -89,6 +90,7 @@ static DeadLockState deadlock_state = DS_NOT_YET_CHECKED;
 /* Is a deadlock check pending? */
 static volatile sig_atomic_t got_deadlock_timeout;
 
+static Size FastPathLockArraySize(void);
 static void RemoveProcFromArray(int code, Datum arg);
 static void ProcKill(int code, Datum arg);
 static void AuxiliaryProcKill(int code, Datum arg);
@@ -118,6 +120,31 @@ ProcGlobalShmemSize(void)
 	size = add_size(size, mul_size(NUM_AUXILIARY_PROCS, sizeof(PGXACT)));
 	size = add_size(size, mul_size(max_prepared_xacts, sizeof(PGXACT)));
 
+	/* fast-path lock arrays */
+	size = add_size(size, mul_size(add_size(MaxBackends,
+											add_size(NUM_AUXILIARY_PROCS,
+													 max_prepared_xacts)),
+								   FastPathLockArraySize()));
+
+	return size;
+}
+
+/*
+ * Report the size of the fast-path lock arrays of a single PGPROC.
+ */
+static Size
+FastPathLockArraySize(void)
+{
+	Size		size;
+
+	Assert(FastPathLockGroupsPerBackend > 0);
+
+	/* one word of lock bits per group, plus the relation OID slots */
+	size = MAXALIGN(mul_size(FastPathLockGroupsPerBackend, sizeof(uint64)));
+	size = add_size(size,
+					MAXALIGN(mul_size(FastPathLockSlotsPerBackend(),
+									  sizeof(Oid))));
+
 	return size;
 }
 
@@ -163,6 +190,9 @@ InitProcGlobal(void)
 {
 	PGPROC	   *procs;
 	PGXACT	   *pgxacts;
+	char	   *fpPtr;
+	Size		fpLockBitsSize,
+				fpArraySize;
 	int			i,
 				j;
 	bool		found;
@@ -213,10 +243,25 @@ InitProcGlobal(void)
 	MemSet(pgxacts, 0, TotalProcs * sizeof(PGXACT));
 	ProcGlobal->allPgXact = pgxacts;
 
+	/*
+	 * Allocate the fast-path lock arrays in one chunk, too.  Their size
+	 * depends on max_locks_per_transaction, so they can't be embedded in
+	 * PGPROC; each PGPROC just points to its own part of this chunk.
+	 */
+	fpLockBitsSize = MAXALIGN(FastPathLockGroupsPerBackend * sizeof(uint64));
+	fpArraySize = FastPathLockArraySize();
+	fpPtr = (char *) ShmemAlloc(TotalProcs * fpArraySize);
+	MemSet(fpPtr, 0, TotalProcs * fpArraySize);
+
 	for (i = 0; i < TotalProcs; i++)
 	{
 		/* Common initialization for all PGPROCs, regardless of type. */
 
+		/* Point to this PGPROC's fast-path lock arrays. */
+		procs[i].fpLockBits = (uint64 *) fpPtr;
+		procs[i].fpRelId = (Oid *) (fpPtr + fpLockBitsSize);
+		fpPtr += fpArraySize;
+
 		/*
 		 * Set up per-PGPROC semaphore, latch, and backendLock. Prepared xact
 		 * dummy PGPROCs don't need these though - they're never associated
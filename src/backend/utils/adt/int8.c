@@ -23,8 +23,6 @@
 #include "utils/builtins.h"
 
 
-#define MAXINT8LEN		25
-
 #define SAMESIGN(a,b)	(((a) < 0) == ((b) < 0))
 
 typedef struct
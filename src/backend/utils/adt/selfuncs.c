@@ -6498,9 +6498,10 @@ genericcostestimate(PlannerInfo *root,
 
 	/*
 	 * Check for ScalarArrayOpExpr index quals, and estimate the number of
-	 * index scans that will be performed.
+	 * index scans that will be performed.  Start from the caller's count of
+	 * any scans the index AM will perform for other reasons.
 	 */
-	num_sa_scans = 1;
+	num_sa_scans = (costs->num_sa_scans > 1) ? costs->num_sa_scans : 1;
 	foreach(l, indexQuals)
 	{
 		RestrictInfo *rinfo = (RestrictInfo *) lfirst(l);
@@ -6704,6 +6705,60 @@ add_predicate_to_quals(IndexOptInfo *index, List *indexQuals)
 	return list_concat(predExtraQuals, indexQuals);
 }
 
+/*
+ * Estimate the number of primitive index scans of a btree skip scan.
+ *
+ * When there are no quals on the leading column of a btree index, but some
+ * on the second, a non-parallel btree scan skips through the distinct values
+ * of the leading column, scanning the entries for each of them as if there
+ * were an "=" qual for it (see _bt_preprocess_skip_scan).  That's like having
+ * a ScalarArrayOpExpr listing all those values, so the quals on the second
+ * column then act as boundary quals.  But once it turns out that the entries
+ * for each value take up less than a page, the scan stops skipping and reads
+ * the rest of the index in full; so we only estimate it as a skip scan if
+ * that's not expected to happen.
+ *
+ * Returns the estimated number of distinct leading-column values, or zero if
+ * the scan isn't expected to skip.
+ */
+static double
+btskipscannumscans(PlannerInfo *root, IndexPath *path, List *qinfos)
+{
+	IndexOptInfo *index = path->indexinfo;
+	IndexQualInfo *qinfo;
+	TargetEntry *tle;
+	VariableStatData vardata;
+	double		ndistinct;
+	bool		isdefault;
+	ListCell   *lc;
+
+	if (index->ncolumns < 2 || qinfos == NIL || path->path.parallel_aware)
+		return 0;
+
+	/* The quals are in index column order, so check the first one */
+	qinfo = (IndexQualInfo *) linitial(qinfos);
+	if (qinfo->indexcol != 1)
+		return 0;
+
+	/* Array keys rule out a skip scan */
+	foreach(lc, qinfos)
+	{
+		qinfo = (IndexQualInfo *) lfirst(lc);
+		if (IsA(qinfo->rinfo->clause, ScalarArrayOpExpr))
+			return 0;
+	}
+
+	tle = (TargetEntry *) linitial(index->indextlist);
+	examine_variable(root, (Node *) tle->expr, 0, &vardata);
+	ndistinct = get_variable_numdistinct(&vardata, &isdefault);
+	ReleaseVariableStats(vardata);
+
+	/* Without stats, don't risk it */
+	if (isdefault || ndistinct > index->pages)
+		return 0;
+
+	return ndistinct;
+}
 
 void
 btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
@@ -6719,17 +6774,22 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	VariableStatData vardata;
 	double		numIndexTuples;
 	Cost		descentCost;
+	double		num_descents;
 	List	   *indexBoundQuals;
 	int			indexcol;
 	bool		eqQualHere;
 	bool		found_saop;
 	bool		found_is_null_op;
 	double		num_sa_scans;
+	double		num_skip_scans;
 	ListCell   *lc;
 
 	/* Do preliminary analysis of indexquals */
 	qinfos = deconstruct_indexquals(path);
 
+	/* Will this be a skip scan? */
+	num_skip_scans = btskipscannumscans(root, path, qinfos);
+
 	/*
 	 * For a btree scan, only leading '=' quals plus inequality quals for the
 	 * immediately next attribute contribute to index selectivity (these are
@@ -6745,14 +6805,16 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 *
 	 * If there's a ScalarArrayOpExpr in the quals, we'll actually perform N
 	 * index scans not one, but the ScalarArrayOpExpr's operator can be
-	 * considered to act the same as it normally does.
+	 * considered to act the same as it normally does.  Likewise, a skip scan
+	 * performs one index scan per distinct value of the leading column, and
+	 * the boundary quals start at the second column.
 	 */
 	indexBoundQuals = NIL;
-	indexcol = 0;
+	indexcol = (num_skip_scans > 0) ? 1 : 0;
 	eqQualHere = false;
 	found_saop = false;
 	found_is_null_op = false;
-	num_sa_scans = 1;
+	num_sa_scans = (num_skip_scans > 0) ? num_skip_scans : 1;
 	foreach(lc, qinfos)
 	{
 		IndexQualInfo *qinfo = (IndexQualInfo *) lfirst(lc);
@@ -6856,6 +6918,7 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 */
 	MemSet(&costs, 0, sizeof(costs));
 	costs.numIndexTuples = numIndexTuples;
+	costs.num_sa_scans = num_skip_scans;
 
 	genericcostestimate(root, path, loop_count, qinfos, &costs);
 
@@ -6868,13 +6931,18 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 *
 	 * If there are ScalarArrayOpExprs, charge this once per SA scan.  The
 	 * ones after the first one are not startup cost so far as the overall
-	 * plan is concerned, so add them only to "total" cost.
+	 * plan is concerned, so add them only to "total" cost.  A skip scan
+	 * descends twice per scan: once to find the next leading-column value,
+	 * and once more to start scanning its entries.
 	 */
+	num_descents = costs.num_sa_scans;
+	if (num_skip_scans > 0)
+		num_descents *= 2;
 	if (index->tuples > 1)		/* avoid computing log(0) */
 	{
 		descentCost = ceil(log(index->tuples) / log(2.0)) * cpu_operator_cost;
 		costs.indexStartupCost += descentCost;
-		costs.indexTotalCost += costs.num_sa_scans * descentCost;
+		costs.indexTotalCost += num_descents * descentCost;
 	}
 
 	/*
@@ -6885,11 +6953,11 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 * in cases where only a single leaf page is expected to be visited.  This
 	 * cost is somewhat arbitrarily set at 50x cpu_operator_cost per page
 	 * touched.  The number of such pages is btree tree height plus one (ie,
-	 * we charge for the leaf page too).  As above, charge once per SA scan.
+	 * we charge for the leaf page too).  As above, charge once per descent.
 	 */
 	descentCost = (index->tree_height + 1) * 50.0 * cpu_operator_cost;
 	costs.indexStartupCost += descentCost;
-	costs.indexTotalCost += costs.num_sa_scans * descentCost;
+	costs.indexTotalCost += num_descents * descentCost;
 
 	/*
 	 * If we can get an estimate of the first column's ordering correlation C
@@ -35,6 +35,7 @@
 #include "access/nbtree.h"
 #include "access/reloptions.h"
 #include "access/sysattr.h"
+#include "access/tableam.h"
 #include "access/xact.h"
 #include "access/xlog.h"
 #include "catalog/catalog.h"
@@ -1366,10 +1367,13 @@ RelationBuildDesc(Oid targetRelId, bool insertIt)
 	}
 
 	/*
-	 * if it's an index, initialize index-related information
+	 * if it's an index, initialize index-related information; if it's a
+	 * table, look up its table access method
 	 */
-	if (OidIsValid(relation->rd_rel->relam))
+	if (relation->rd_rel->relkind == RELKIND_INDEX)
 		RelationInitIndexAccessInfo(relation);
+	else if (RELKIND_HAS_TABLE_AM(relation->rd_rel->relkind))
+		RelationInitTableAccessMethod(relation);
 
 	/* extract reloptions if any */
 	RelationParseRelOptions(relation, pg_class_tuple);
@@ -1504,6 +1508,24 @@ InitIndexAmRoutine(Relation relation)
 	pfree(tmp);
 }
 
+/*
+ * Initialize the table access method of a table, materialized view or TOAST
+ * table
+ *
+ * A relam of zero, as in the catalogs, means the heap AM.  That one is
+ * known without a catalog lookup, which matters while bootstrapping and for
+ * the nailed relations built by formrdesc.
+ */
+void
+RelationInitTableAccessMethod(Relation relation)
+{
+	if (!OidIsValid(relation->rd_rel->relam) ||
+		relation->rd_rel->relam == HEAP_TABLE_AM_OID)
+		relation->rd_tableam = GetHeapamTableAmRoutine();
+	else
+		relation->rd_tableam = GetTableAmRoutineByAmId(relation->rd_rel->relam);
+}
+
 /*
  * Initialize index-access-method support data for an index relation
  */
@@ -2002,6 +2024,9 @@ formrdesc(const char *relationName, Oid relationReltype,
 	 */
 	RelationGetRelid(relation) = relation->rd_att->attrs[0]->attrelid;
 
+	/* the bootstrap catalogs are all heaps */
+	relation->rd_tableam = GetHeapamTableAmRoutine();
+
 	/*
 	 * All relations made with formrdesc are mapped.  This is necessarily so
 	 * because there is no other way to know what filenode they currently
@@ -3321,6 +3346,13 @@ RelationBuildLocalRelation(const char *relname,
 			break;
 	}
 
+	/*
+	 * Tables start out with the heap AM; heap_create_with_catalog overrides
+	 * that if it was asked for another one.
+	 */
+	if (RELKIND_HAS_TABLE_AM(relkind))
+		rel->rd_tableam = GetHeapamTableAmRoutine();
+
 	/* if it's a materialized view, it's not populated initially */
 	if (relkind == RELKIND_MATVIEW)
 		rel->rd_rel->relispopulated = false;
@@ -5635,6 +5667,11 @@ load_relcache_init_file(bool shared)
 		rel->rd_exclstrats = NULL;
 		rel->rd_fdwroutine = NULL;
 
+		/* the saved pointer isn't valid in this backend */
+		rel->rd_tableam = NULL;
+		if (RELKIND_HAS_TABLE_AM(relform->relkind))
+			RelationInitTableAccessMethod(rel);
+
 		/*
 		 * Reset transient-state fields in the relcache entry
 		 */
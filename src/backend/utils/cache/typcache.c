@@ -46,6 +46,7 @@
 #include "access/heapam.h"
 #include "access/htup_details.h"
 #include "access/nbtree.h"
+#include "access/parallel.h"
 #include "catalog/indexing.h"
 #include "catalog/pg_am.h"
 #include "catalog/pg_constraint.h"
@@ -56,8 +57,11 @@
 #include "commands/defrem.h"
 #include "executor/executor.h"
 #include "optimizer/planner.h"
+#include "storage/dsm.h"
+#include "storage/lwlock.h"
 #include "utils/builtins.h"
 #include "utils/catcache.h"
+#include "utils/dsa.h"
 #include "utils/fmgroids.h"
 #include "utils/inval.h"
 #include "utils/lsyscache.h"
@@ -136,6 +140,16 @@ typedef struct TypeCacheEnumData
  * a hash table to speed searches for matching TupleDescs.  The hash key
  * uses just the first N columns' type OIDs, and so we may have multiple
  * entries with the same hash key.
+ *
+ * Once a backend launches parallel workers, the typmods must mean the same
+ * thing in the leader and all of its workers, so that tuples containing
+ * record values can be passed between them as they are.  The leader then
+ * creates a shared registry of record types in dynamic shared memory, seeded
+ * with the types it has already registered, and the leader and workers
+ * assign new typmods through it from then on.  Each backend still keeps its
+ * own array and hash table as a cache in front of the shared registry, but
+ * the array may then have holes for typmods registered by other backends
+ * that this one has never needed.
  */
 #define REC_HASH_KEYS	16		/* use this many columns in hash key */
 
@@ -152,7 +166,39 @@ static HTAB *RecordCacheHash = NULL;
 
 static TupleDesc *RecordCacheArray = NULL;
 static int32 RecordCacheArrayLen = 0;	/* allocated length of array */
-static int32 NextRecordTypmod = 0;	/* number of entries used */
+static int32 NextRecordTypmod = 0;	/* 1 + highest typmod in array */
+
+/*
+ * The shared registry lives at the start of a DSM segment of
+ * SHARED_RECORD_SEGMENT_SIZE bytes, followed by a DSA area that holds its
+ * entries.  Entries are found by typmod through typmod_table, and by
+ * column types through a fixed number of hash chains.
+ */
+#define SHARED_RECORD_SEGMENT_SIZE	(64 * 1024)
+#define SHARED_RECORD_BUCKETS		256
+
+typedef struct SharedRecordTypmodRegistry
+{
+	LWLock		lock;			/* protects all the fields below */
+	int32		next_typmod;	/* next typmod to assign */
+	int32		typmod_table_len;	/* allocated length of typmod_table */
+	dsa_pointer typmod_table;	/* array of entry pointers, by typmod */
+	dsa_pointer buckets[SHARED_RECORD_BUCKETS]; /* hash chains of entries */
+} SharedRecordTypmodRegistry;
+
+typedef struct SharedRecordTypeEntry
+{
+	dsa_pointer next;			/* next entry in the same hash chain */
+	uint32		hash;			/* hash of the column type OIDs */
+	int32		typmod;			/* typmod assigned to this record type */
+	int			natts;			/* number of columns */
+	bool		hasoid;			/* tdhasoid of the record type */
+	FormData_pg_attribute attrs[FLEXIBLE_ARRAY_MEMBER];
+} SharedRecordTypeEntry;
+
+static dsm_segment *SharedRecordSegment = NULL;
+static SharedRecordTypmodRegistry *SharedRecordRegistry = NULL;
+static dsa_area *SharedRecordArea = NULL;
 
 static void load_typcache_tupdesc(TypeCacheEntry *typentry);
 static void load_rangetype_info(TypeCacheEntry *typentry);
@@ -168,6 +214,15 @@ static void cache_array_element_properties(TypeCacheEntry *typentry);
 static bool record_fields_have_equality(TypeCacheEntry *typentry);
 static bool record_fields_have_compare(TypeCacheEntry *typentry);
 static void cache_record_field_properties(TypeCacheEntry *typentry);
+static RecordCacheEntry *find_record_cache_entry(TupleDesc tupDesc);
+static void record_cache_insert(RecordCacheEntry *recentry,
+					TupleDesc tupDesc, int32 typmod);
+static uint32 record_type_hash(TupleDesc tupDesc);
+static TupleDesc shared_record_entry_tupdesc(SharedRecordTypeEntry *entry);
+static void shared_record_insert(TupleDesc tupDesc, int32 typmod,
+					 uint32 hash);
+static int32 shared_record_register(TupleDesc tupDesc);
+static TupleDesc shared_record_lookup(int32 typmod);
 static void TypeCacheRelCallback(Datum arg, Oid relid);
 static void TypeCacheOpcCallback(Datum arg, int cacheid, uint32 hashvalue);
 static void TypeCacheConstrCallback(Datum arg, int cacheid, uint32 hashvalue);
@@ -1226,18 +1281,21 @@ lookup_rowtype_tupdesc_internal(Oid type_id, int32 typmod, bool noError)
 	}
 	else
 	{
+		TupleDesc	tupDesc = NULL;
+
 		/*
-		 * It's a transient record type, so look in our record-type table.
+		 * It's a transient record type, so look in our record-type table,
+		 * and failing that, in the shared registry if we're attached to one.
 		 */
-		if (typmod < 0 || typmod >= NextRecordTypmod)
-		{
-			if (!noError)
-				ereport(ERROR,
-						(errcode(ERRCODE_WRONG_OBJECT_TYPE),
-						 errmsg("record type has not been registered")));
-			return NULL;
-		}
-		return RecordCacheArray[typmod];
+		if (typmod >= 0 && typmod < NextRecordTypmod)
+			tupDesc = RecordCacheArray[typmod];
+		if (tupDesc == NULL && typmod >= 0 && SharedRecordRegistry != NULL)
+			tupDesc = shared_record_lookup(typmod);
+		if (tupDesc == NULL && !noError)
+			ereport(ERROR,
+					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					 errmsg("record type has not been registered")));
+		return tupDesc;
 	}
 }
 
@@ -1309,15 +1367,56 @@ assign_record_type_typmod(TupleDesc tupDesc)
 {
 	RecordCacheEntry *recentry;
 	TupleDesc	entDesc;
-	Oid			hashkey[REC_HASH_KEYS];
-	bool		found;
-	int			i;
 	ListCell   *l;
 	int32		newtypmod;
 	MemoryContext oldcxt;
 
 	Assert(tupDesc->tdtypeid == RECORDOID);
 
+	recentry = find_record_cache_entry(tupDesc);
+
+	/* Look for existing record cache entry */
+	foreach(l, recentry->tupdescs)
+	{
+		entDesc = (TupleDesc) lfirst(l);
+		if (equalTupleDescs(tupDesc, entDesc))
+		{
+			tupDesc->tdtypmod = entDesc->tdtypmod;
+			return;
+		}
+	}
+
+	/*
+	 * Not present, so need to manufacture an entry.  If we share typmods
+	 * with other backends, the registry tells us which typmod to use.
+	 */
+	if (SharedRecordRegistry != NULL)
+		newtypmod = shared_record_register(tupDesc);
+	else
+		newtypmod = NextRecordTypmod;
+
+	oldcxt = MemoryContextSwitchTo(CacheMemoryContext);
+	record_cache_insert(recentry, tupDesc, newtypmod);
+	MemoryContextSwitchTo(oldcxt);
+
+	/* report to caller as well */
+	tupDesc->tdtypmod = newtypmod;
+}
+
+/*
+ * find_record_cache_entry
+ *
+ * Find or create the RecordCacheHash entry for the hash class of the given
+ * record type.
+ */
+static RecordCacheEntry *
+find_record_cache_entry(TupleDesc tupDesc)
+{
+	RecordCacheEntry *recentry;
+	Oid			hashkey[REC_HASH_KEYS];
+	bool		found;
+	int			i;
+
 	if (RecordCacheHash == NULL)
 	{
 		/* First time through: initialize the hash table */
@@ -1351,31 +1450,37 @@ assign_record_type_typmod(TupleDesc tupDesc)
 		recentry->tupdescs = NIL;
 	}
 
-	/* Look for existing record cache entry */
-	foreach(l, recentry->tupdescs)
-	{
-		entDesc = (TupleDesc) lfirst(l);
-		if (equalTupleDescs(tupDesc, entDesc))
-		{
-			tupDesc->tdtypmod = entDesc->tdtypmod;
-			return;
-		}
-	}
+	return recentry;
+}
 
-	/* Not present, so need to manufacture an entry */
-	oldcxt = MemoryContextSwitchTo(CacheMemoryContext);
+/*
+ * record_cache_insert
+ *
+ * Add a copy of the given record type to our record-type table, under the
+ * given typmod.  Caller must be in CacheMemoryContext.
+ */
+static void
+record_cache_insert(RecordCacheEntry *recentry, TupleDesc tupDesc,
+					int32 typmod)
+{
+	TupleDesc	entDesc;
 
 	if (RecordCacheArray == NULL)
 	{
-		RecordCacheArray = (TupleDesc *) palloc(64 * sizeof(TupleDesc));
+		RecordCacheArray = (TupleDesc *) palloc0(64 * sizeof(TupleDesc));
 		RecordCacheArrayLen = 64;
 	}
-	else if (NextRecordTypmod >= RecordCacheArrayLen)
+	if (typmod >= RecordCacheArrayLen)
 	{
 		int32		newlen = RecordCacheArrayLen * 2;
 
+		while (typmod >= newlen)
+			newlen *= 2;
+
 		RecordCacheArray = (TupleDesc *) repalloc(RecordCacheArray,
 												  newlen * sizeof(TupleDesc));
+		memset(RecordCacheArray + RecordCacheArrayLen, 0,
+			   (newlen - RecordCacheArrayLen) * sizeof(TupleDesc));
 		RecordCacheArrayLen = newlen;
 	}
 
@@ -1384,15 +1489,317 @@ assign_record_type_typmod(TupleDesc tupDesc)
 	recentry->tupdescs = lcons(entDesc, recentry->tupdescs);
 	/* mark it as a reference-counted tupdesc */
 	entDesc->tdrefcount = 1;
-	/* now it's safe to advance NextRecordTypmod */
-	newtypmod = NextRecordTypmod++;
-	entDesc->tdtypmod = newtypmod;
-	RecordCacheArray[newtypmod] = entDesc;
+	/* now it's safe to enter it in the array */
+	entDesc->tdtypmod = typmod;
+	RecordCacheArray[typmod] = entDesc;
+	if (typmod >= NextRecordTypmod)
+		NextRecordTypmod = typmod + 1;
+}
 
-	/* report to caller as well */
-	tupDesc->tdtypmod = newtypmod;
+/*
+ * GetSharedRecordTypmodRegistry
+ *
+ * Called by a backend about to launch parallel workers, to get the handle
+ * of the DSM segment holding the shared record type registry that the
+ * workers should attach to.  The registry is created on first use, and
+ * lasts for the rest of the session.  Returns DSM_HANDLE_INVALID if there
+ * is no segment available to create it in, in which case the caller had
+ * better not launch any workers.
+ */
+dsm_handle
+GetSharedRecordTypmodRegistry(void)
+{
+	dsm_segment *seg;
+	SharedRecordTypmodRegistry *registry;
+	Size		registry_size = MAXALIGN(sizeof(SharedRecordTypmodRegistry));
+	int32		typmod;
+	int			i;
+
+	if (SharedRecordSegment != NULL)
+		return dsm_segment_handle(SharedRecordSegment);
+
+	/* Parallel workers use their leader's registry. */
+	Assert(!IsParallelWorker());
+
+	seg = dsm_create(SHARED_RECORD_SEGMENT_SIZE, DSM_CREATE_NULL_IF_MAXSEGMENTS);
+	if (seg == NULL)
+		return DSM_HANDLE_INVALID;
 
+	registry = (SharedRecordTypmodRegistry *) dsm_segment_address(seg);
+	LWLockInitialize(&registry->lock, LWTRANCHE_RECORD_TYPMOD_REGISTRY);
+	registry->next_typmod = 0;
+	registry->typmod_table_len = 0;
+	registry->typmod_table = InvalidDsaPointer;
+	for (i = 0; i < SHARED_RECORD_BUCKETS; i++)
+		registry->buckets[i] = InvalidDsaPointer;
+
+	SharedRecordArea = dsa_create_in_place((char *) registry + registry_size,
+										   SHARED_RECORD_SEGMENT_SIZE -
+										   registry_size,
+										   LWTRANCHE_RECORD_TYPMOD_DSA,
+										   seg);
+	SharedRecordRegistry = registry;
+
+	/*
+	 * Copy in the record types we've registered so far, keeping their
+	 * typmods.  Nobody else can see the registry yet, but take the lock
+	 * anyway for the benefit of the assertions.
+	 */
+	PG_TRY();
+	{
+		LWLockAcquire(&registry->lock, LW_EXCLUSIVE);
+		for (typmod = 0; typmod < NextRecordTypmod; typmod++)
+		{
+			TupleDesc	tupDesc = RecordCacheArray[typmod];
+
+			if (tupDesc != NULL)
+				shared_record_insert(tupDesc, typmod,
+									 record_type_hash(tupDesc));
+		}
+		registry->next_typmod = NextRecordTypmod;
+		LWLockRelease(&registry->lock);
+	}
+	PG_CATCH();
+	{
+		/* the resource owner will detach the segment */
+		SharedRecordRegistry = NULL;
+		SharedRecordArea = NULL;
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	/* Keep the segment, and any that the area adds, until we exit. */
+	dsa_pin_mapping(SharedRecordArea);
+	dsm_pin_mapping(seg);
+	SharedRecordSegment = seg;
+
+	return dsm_segment_handle(seg);
+}
+
+/*
+ * AttachSharedRecordTypmodRegistry
+ *
+ * Called by a parallel worker at startup to attach to its leader's shared
+ * record type registry, before it has registered any record types itself.
+ */
+void
+AttachSharedRecordTypmodRegistry(dsm_handle handle)
+{
+	dsm_segment *seg;
+	Size		registry_size = MAXALIGN(sizeof(SharedRecordTypmodRegistry));
+
+	Assert(SharedRecordSegment == NULL);
+	Assert(NextRecordTypmod == 0);
+
+	seg = dsm_attach(handle);
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map shared record type registry segment")));
+
+	SharedRecordArea = dsa_attach_in_place((char *) dsm_segment_address(seg) +
+										   registry_size,
+										   seg);
+	dsa_pin_mapping(SharedRecordArea);
+	dsm_pin_mapping(seg);
+
+	SharedRecordRegistry = (SharedRecordTypmodRegistry *)
+		dsm_segment_address(seg);
+	SharedRecordSegment = seg;
+}
+
+/*
+ * record_type_hash
+ *
+ * Hash a record type by its column types, like the RecordCacheHash key.
+ */
+static uint32
+record_type_hash(TupleDesc tupDesc)
+{
+	Oid			hashkey[REC_HASH_KEYS];
+	int			i;
+
+	MemSet(hashkey, 0, sizeof(hashkey));
+	for (i = 0; i < tupDesc->natts && i < REC_HASH_KEYS; i++)
+		hashkey[i] = tupDesc->attrs[i]->atttypid;
+
+	return DatumGetUInt32(hash_any((const unsigned char *) hashkey,
+								   sizeof(hashkey)));
+}
+
+/*
+ * shared_record_entry_tupdesc
+ *
+ * Build a TupleDesc in CurrentMemoryContext for a shared registry entry.
+ */
+static TupleDesc
+shared_record_entry_tupdesc(SharedRecordTypeEntry *entry)
+{
+	TupleDesc	tupDesc;
+	int			i;
+
+	tupDesc = CreateTemplateTupleDesc(entry->natts, entry->hasoid);
+	for (i = 0; i < entry->natts; i++)
+		memcpy(tupDesc->attrs[i], &entry->attrs[i], ATTRIBUTE_FIXED_PART_SIZE);
+	tupDesc->tdtypeid = RECORDOID;
+	tupDesc->tdtypmod = entry->typmod;
+
+	return tupDesc;
+}
+
+/*
+ * shared_record_insert
+ *
+ * Add a record type to the shared registry under the given typmod.  Caller
+ * must hold the registry's lock exclusively, and must advance next_typmod
+ * itself.
+ */
+static void
+shared_record_insert(TupleDesc tupDesc, int32 typmod, uint32 hash)
+{
+	SharedRecordTypmodRegistry *registry = SharedRecordRegistry;
+	SharedRecordTypeEntry *entry;
+	dsa_pointer entry_dp;
+	dsa_pointer *typmod_table;
+	int			bucket = hash % SHARED_RECORD_BUCKETS;
+	int			i;
+
+	Assert(LWLockHeldByMeInMode(&registry->lock, LW_EXCLUSIVE));
+
+	/* Make sure the typmod table has room first */
+	if (typmod >= registry->typmod_table_len)
+	{
+		int32		newlen = Max(registry->typmod_table_len * 2, 64);
+		dsa_pointer new_dp;
+		dsa_pointer *new_table;
+
+		while (typmod >= newlen)
+			newlen *= 2;
+
+		new_dp = dsa_allocate(SharedRecordArea, newlen * sizeof(dsa_pointer));
+		new_table = (dsa_pointer *) dsa_get_address(SharedRecordArea, new_dp);
+		for (i = 0; i < newlen; i++)
+			new_table[i] = InvalidDsaPointer;
+		if (DsaPointerIsValid(registry->typmod_table))
+		{
+			memcpy(new_table,
+				   dsa_get_address(SharedRecordArea, registry->typmod_table),
+				   registry->typmod_table_len * sizeof(dsa_pointer));
+			dsa_free(SharedRecordArea, registry->typmod_table);
+		}
+		registry->typmod_table = new_dp;
+		registry->typmod_table_len = newlen;
+	}
+
+	entry_dp = dsa_allocate(SharedRecordArea,
+							offsetof(SharedRecordTypeEntry, attrs) +
+							tupDesc->natts * sizeof(FormData_pg_attribute));
+	entry = (SharedRecordTypeEntry *) dsa_get_address(SharedRecordArea,
+													  entry_dp);
+	entry->hash = hash;
+	entry->typmod = typmod;
+	entry->natts = tupDesc->natts;
+	entry->hasoid = tupDesc->tdhasoid;
+	for (i = 0; i < tupDesc->natts; i++)
+		memcpy(&entry->attrs[i], tupDesc->attrs[i], ATTRIBUTE_FIXED_PART_SIZE);
+
+	/* Now link it in */
+	typmod_table = (dsa_pointer *)
+		dsa_get_address(SharedRecordArea, registry->typmod_table);
+	typmod_table[typmod] = entry_dp;
+	entry->next = registry->buckets[bucket];
+	registry->buckets[bucket] = entry_dp;
+}
+
+/*
+ * shared_record_register
+ *
+ * Find the typmod of the given record type in the shared registry, adding
+ * the type if it isn't there yet.
+ */
+static int32
+shared_record_register(TupleDesc tupDesc)
+{
+	SharedRecordTypmodRegistry *registry = SharedRecordRegistry;
+	uint32		hash = record_type_hash(tupDesc);
+	dsa_pointer entry_dp;
+	int32		typmod;
+
+	LWLockAcquire(&registry->lock, LW_EXCLUSIVE);
+
+	for (entry_dp = registry->buckets[hash % SHARED_RECORD_BUCKETS];
+		 DsaPointerIsValid(entry_dp);
+		 entry_dp = ((SharedRecordTypeEntry *)
+					 dsa_get_address(SharedRecordArea, entry_dp))->next)
+	{
+		SharedRecordTypeEntry *entry;
+		TupleDesc	entDesc;
+		bool		match;
+
+		entry = (SharedRecordTypeEntry *) dsa_get_address(SharedRecordArea,
+														  entry_dp);
+		if (entry->hash != hash || entry->natts != tupDesc->natts)
+			continue;
+
+		entDesc = shared_record_entry_tupdesc(entry);
+		match = equalTupleDescs(tupDesc, entDesc);
+		FreeTupleDesc(entDesc);
+		if (match)
+		{
+			typmod = entry->typmod;
+			LWLockRelease(&registry->lock);
+			return typmod;
+		}
+	}
+
+	typmod = registry->next_typmod;
+	shared_record_insert(tupDesc, typmod, hash);
+	registry->next_typmod++;
+
+	LWLockRelease(&registry->lock);
+
+	return typmod;
+}
+
+/*
+ * shared_record_lookup
+ *
+ * Look up a typmod that another backend registered in the shared registry,
+ * and add the record type to our own table.  Returns NULL if the typmod has
+ * not been assigned.
+ */
+static TupleDesc
+shared_record_lookup(int32 typmod)
+{
+	SharedRecordTypmodRegistry *registry = SharedRecordRegistry;
+	RecordCacheEntry *recentry;
+	TupleDesc	tupDesc = NULL;
+	MemoryContext oldcxt;
+
+	LWLockAcquire(&registry->lock, LW_SHARED);
+	if (typmod < registry->next_typmod)
+	{
+		dsa_pointer *typmod_table;
+		SharedRecordTypeEntry *entry;
+
+		typmod_table = (dsa_pointer *)
+			dsa_get_address(SharedRecordArea, registry->typmod_table);
+		entry = (SharedRecordTypeEntry *)
+			dsa_get_address(SharedRecordArea, typmod_table[typmod]);
+		tupDesc = shared_record_entry_tupdesc(entry);
+	}
+	LWLockRelease(&registry->lock);
+
+	if (tupDesc == NULL)
+		return NULL;
+
+	recentry = find_record_cache_entry(tupDesc);
+	oldcxt = MemoryContextSwitchTo(CacheMemoryContext);
+	record_cache_insert(recentry, tupDesc, typmod);
 	MemoryContextSwitchTo(oldcxt);
+	FreeTupleDesc(tupDesc);
+
+	return RecordCacheArray[typmod];
 }
 
 /*
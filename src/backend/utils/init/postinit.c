@@ -71,6 +71,7 @@ static void ShutdownPostgres(int code, Datum arg);
 static void StatementTimeoutHandler(void);
 static void LockTimeoutHandler(void);
 static void IdleInTransactionSessionTimeoutHandler(void);
+static void IdleSessionTimeoutHandler(void);
 static bool ThereIsAtLeastOneRole(void);
 static void process_startup_options(Port *port, bool am_superuser);
 static void process_settings(Oid databaseid, Oid roleid);
@@ -505,6 +506,32 @@ InitializeMaxBackends(void)
 		elog(ERROR, "too many backends configured");
 }
 
+/*
+ * Initialize the number of fast-path lock groups from config options.
+ *
+ * We want roughly max_locks_per_transaction fast-path slots per backend, so
+ * that a transaction touching many relations (a partitioned table with many
+ * partitions, for instance) doesn't overflow into the main lock table.  The
+ * slots come in groups of FP_LOCK_SLOTS_PER_GROUP, and the number of groups
+ * is rounded up to a power of two so that a relation's group can be chosen
+ * with a simple mask.
+ *
+ * The same calling rules as for InitializeMaxBackends apply: this must run
+ * before shared memory size is determined, and in an EXEC_BACKEND
+ * environment the value is passed down via BackendParameters.
+ */
+void
+InitializeFastPathLocks(void)
+{
+	Assert(FastPathLockGroupsPerBackend == 0);
+
+	FastPathLockGroupsPerBackend = 1;
+	while (FastPathLockGroupsPerBackend < FP_LOCK_GROUPS_PER_BACKEND_MAX &&
+		   FastPathLockGroupsPerBackend * FP_LOCK_SLOTS_PER_GROUP <
+		   max_locks_per_xact)
+		FastPathLockGroupsPerBackend *= 2;
+}
+
 /*
  * Early initialization of a backend (either standalone or under postmaster).
  * This happens even before InitPostgres.
@@ -599,6 +626,7 @@ InitPostgres(const char *in_dbname, Oid dboid, const char *username,
 		RegisterTimeout(LOCK_TIMEOUT, LockTimeoutHandler);
 		RegisterTimeout(IDLE_IN_TRANSACTION_SESSION_TIMEOUT,
 						IdleInTransactionSessionTimeoutHandler);
+		RegisterTimeout(IDLE_SESSION_TIMEOUT, IdleSessionTimeoutHandler);
 	}
 
 	/*
@@ -1196,6 +1224,14 @@ IdleInTransactionSessionTimeoutHandler(void)
 	SetLatch(MyLatch);
 }
 
+static void
+IdleSessionTimeoutHandler(void)
+{
+	IdleSessionTimeoutPending = true;
+	InterruptPending = true;
+	SetLatch(MyLatch);
+}
+
 /*
  * Returns true if at least one role is defined in this database cluster.
  */
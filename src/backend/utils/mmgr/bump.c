@@ -0,0 +1,542 @@
+/*-------------------------------------------------------------------------
+ *
+ * bump.c
+ *	  Bump allocator definitions.
+ *
+ * Bump is a MemoryContext implementation designed for memory usages which
+ * require allocating a large number of chunks, none of which ever need to
+ * be pfree'd or realloc'd.
+ *
+ * Portions Copyright (c) 2017, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/mmgr/bump.c
+ *
+ *
+ *	Bump is best suited to cases which require a large number of short-lived
+ *	chunks where performance matters.  Because bump allocated chunks don't
+ *	have a chunk header, they are more compact than AllocSet chunks, and
+ *	since there is no power-of-2 rounding of the request size, no space is
+ *	wasted on that either.  Allocation is a matter of bumping a pointer
+ *	within the current block.  The downside is that chunks can't be freed
+ *	individually: the only way to release memory is to reset or delete the
+ *	whole context.
+ *
+ *	Because the chunks lack the standard header, pfree(), repalloc() and
+ *	GetMemoryChunkSpace() must never be called on memory allocated here;
+ *	there is nothing in front of the chunk for them to find the owning
+ *	context with.  In MEMORY_CONTEXT_CHECKING builds, chunks do get a header
+ *	so that such mistakes are reported by an ERROR rather than a crash.
+ *
+ *	Blocks start at initBlockSize and double in size up to maxBlockSize, in
+ *	the same way as in aset.c.  Requests larger than allocChunkLimit get a
+ *	dedicated block so that they don't waste the rest of the current block.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "lib/ilist.h"
+#include "utils/memdebug.h"
+#include "utils/memutils.h"
+
+#define Bump_BLOCKHDRSZ	MAXALIGN(sizeof(BumpBlock))
+
+/* No chunk header unless built with MEMORY_CONTEXT_CHECKING */
+#ifdef MEMORY_CONTEXT_CHECKING
+#define Bump_CHUNKHDRSZ	sizeof(BumpChunk)
+#else
+#define Bump_CHUNKHDRSZ	0
+#endif
+
+/* Requests larger than this get a block of their own */
+#define Bump_CHUNK_FRACTION	8
+
+typedef struct BumpBlock BumpBlock; /* forward reference */
+
+/*
+ * BumpContext is our bump-pointer implementation of MemoryContext.
+ */
+typedef struct BumpContext
+{
+	MemoryContextData header;	/* Standard memory-context fields */
+
+	/* Allocation parameters for this context: */
+	Size		initBlockSize;	/* initial block size */
+	Size		maxBlockSize;	/* maximum block size */
+	Size		nextBlockSize;	/* next block size to allocate */
+	Size		allocChunkLimit;	/* effective chunk size limit */
+
+	/*
+	 * Blocks in this context.  The head of the list is the block that new
+	 * allocations are carved from; dedicated blocks for large chunks are
+	 * added at the tail.
+	 */
+	dlist_head	blocks;
+} BumpContext;
+
+/*
+ * BumpBlock
+ *		A BumpBlock is the unit of memory that is obtained by bump.c from
+ *		malloc().  It contains zero or more chunks, packed back to back.
+ *
+ *		BumpBlock is the header data for a block --- the usable space within
+ *		the block begins at the next alignment boundary.
+ */
+struct BumpBlock
+{
+	dlist_node	node;			/* doubly-linked list of blocks */
+	Size		blksize;		/* allocated size of this block */
+	char	   *freeptr;		/* start of free space in this block */
+	char	   *endptr;			/* end of space in this block */
+};
+
+#ifdef MEMORY_CONTEXT_CHECKING
+/*
+ * BumpChunk
+ *		The prefix of each piece of memory in a BumpBlock.  Only present in
+ *		MEMORY_CONTEXT_CHECKING builds.
+ */
+typedef struct BumpChunk
+{
+	/* size of the usable space in the chunk */
+	Size		size;
+	/* actual requested size */
+	Size		requested_size;
+	/* owning context, so that pfree() and friends can complain */
+	BumpContext *context;
+	/* there must not be any padding to reach a MAXALIGN boundary here! */
+} BumpChunk;
+#endif
+
+/*
+ * BumpIsValid
+ *		True iff set is valid bump context.
+ */
+#define BumpIsValid(set) PointerIsValid(set)
+
+/*
+ * These functions implement the MemoryContext API for Bump contexts.
+ */
+static void *BumpAlloc(MemoryContext context, Size size);
+static void BumpFree(MemoryContext context, void *pointer);
+static void *BumpRealloc(MemoryContext context, void *pointer, Size size);
+static void BumpInit(MemoryContext context);
+static void BumpReset(MemoryContext context);
+static void BumpDelete(MemoryContext context);
+static Size BumpGetChunkSpace(MemoryContext context, void *pointer);
+static bool BumpIsEmpty(MemoryContext context);
+static void BumpStats(MemoryContext context, int level, bool print,
+		  MemoryContextCounters *totals);
+#ifdef MEMORY_CONTEXT_CHECKING
+static void BumpCheck(MemoryContext context);
+#endif
+
+/*
+ * This is the virtual function table for Bump contexts.
+ */
+static MemoryContextMethods BumpMethods = {
+	BumpAlloc,
+	BumpFree,
+	BumpRealloc,
+	BumpInit,
+	BumpReset,
+	BumpDelete,
+	BumpGetChunkSpace,
+	BumpIsEmpty,
+	BumpStats
+#ifdef MEMORY_CONTEXT_CHECKING
+	,BumpCheck
+#endif
+};
+
+/* ----------
+ * Debug macros
+ * ----------
+ */
+#ifdef HAVE_ALLOCINFO
+#define BumpAllocInfo(_cxt, _ptr, _size) \
+			fprintf(stderr, "BumpAlloc: %s: %p, %zu\n", \
+				(_cxt)->header.name, (_ptr), (_size))
+#else
+#define BumpAllocInfo(_cxt, _ptr, _size)
+#endif
+
+
+/*
+ * BumpContextCreate
+ *		Create a new Bump context.
+ *
+ * parent: parent context, or NULL if top-level context
+ * name: name of context (for debugging --- string will be copied)
+ * minContextSize: ignored; accepted so the ALLOCSET_*_SIZES macros can be
+ *		used to specify the block sizes
+ * initBlockSize: initial allocation block size
+ * maxBlockSize: maximum allocation block size
+ */
+MemoryContext
+BumpContextCreate(MemoryContext parent,
+				  const char *name,
+				  Size minContextSize,
+				  Size initBlockSize,
+				  Size maxBlockSize)
+{
+	BumpContext *set;
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	StaticAssertStmt(offsetof(BumpChunk, context) + sizeof(MemoryContext) ==
+					 MAXALIGN(sizeof(BumpChunk)),
+					 "padding calculation in BumpChunk is wrong");
+#endif
+
+	/*
+	 * Validate the block sizes the same way AllocSetContextCreate() does.
+	 * (If we're going to throw an error, we should do so before the context
+	 * is created, not after.)
+	 */
+	if (initBlockSize != MAXALIGN(initBlockSize) ||
+		initBlockSize < 1024)
+		elog(ERROR, "invalid initBlockSize for memory context: %zu",
+			 initBlockSize);
+	if (maxBlockSize != MAXALIGN(maxBlockSize) ||
+		maxBlockSize < initBlockSize ||
+		!AllocHugeSizeIsValid(maxBlockSize))	/* must be safe to double */
+		elog(ERROR, "invalid maxBlockSize for memory context: %zu",
+			 maxBlockSize);
+
+	/* Do the type-independent part of context creation */
+	set = (BumpContext *) MemoryContextCreate(T_BumpContext,
+											  sizeof(BumpContext),
+											  &BumpMethods,
+											  parent,
+											  name);
+
+	set->initBlockSize = initBlockSize;
+	set->maxBlockSize = maxBlockSize;
+	set->nextBlockSize = initBlockSize;
+
+	/*
+	 * Requests bigger than a fraction of the largest block we'll allocate
+	 * get a dedicated block.  Otherwise a big request arriving when the
+	 * current block is nearly full would waste most of that block.
+	 */
+	set->allocChunkLimit = MAXALIGN_DOWN(maxBlockSize / Bump_CHUNK_FRACTION);
+
+	return (MemoryContext) set;
+}
+
+/*
+ * BumpInit
+ *		Context-type-specific initialization routine.
+ */
+static void
+BumpInit(MemoryContext context)
+{
+	BumpContext *set = (BumpContext *) context;
+
+	dlist_init(&set->blocks);
+}
+
+/*
+ * BumpReset
+ *		Frees all memory which is allocated in the given set.
+ *
+ * All blocks are returned to malloc(); we don't keep a keeper block.
+ */
+static void
+BumpReset(MemoryContext context)
+{
+	BumpContext *set = (BumpContext *) context;
+	dlist_mutable_iter miter;
+
+	AssertArg(BumpIsValid(set));
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	/* Check for corruption and leaks before freeing */
+	BumpCheck(context);
+#endif
+
+	dlist_foreach_modify(miter, &set->blocks)
+	{
+		BumpBlock  *block = dlist_container(BumpBlock, node, miter.cur);
+
+		dlist_delete(miter.cur);
+
+#ifdef CLOBBER_FREED_MEMORY
+		wipe_mem(block, block->blksize);
+#endif
+		free(block);
+	}
+
+	/* Reset block size allocation sequence, too */
+	set->nextBlockSize = set->initBlockSize;
+}
+
+/*
+ * BumpDelete
+ *		Frees all memory which is allocated in the given set, in preparation
+ *		for deletion of the set.  We simply call BumpReset().
+ */
+static void
+BumpDelete(MemoryContext context)
+{
+	BumpReset(context);
+}
+
+/*
+ * BumpAlloc
+ *		Returns pointer to allocated memory of given size or NULL if
+ *		request could not be completed; memory is added to the set.
+ *
+ * No request may exceed:
+ *		MAXALIGN_DOWN(SIZE_MAX) - Bump_BLOCKHDRSZ - Bump_CHUNKHDRSZ
+ * All callers use a much-lower limit.
+ */
+static void *
+BumpAlloc(MemoryContext context, Size size)
+{
+	BumpContext *set = (BumpContext *) context;
+	BumpBlock  *block = NULL;
+	char	   *ptr;
+	Size		chunk_size = MAXALIGN(size);
+	Size		required_size = chunk_size + Bump_CHUNKHDRSZ;
+
+	AssertArg(BumpIsValid(set));
+
+	if (chunk_size > set->allocChunkLimit)
+	{
+		/*
+		 * Big request: give it a dedicated block.  Put the block at the tail
+		 * of the list, so that the current block remains at the head.
+		 */
+		Size		blksize = required_size + Bump_BLOCKHDRSZ;
+
+		block = (BumpBlock *) malloc(blksize);
+		if (block == NULL)
+			return NULL;
+
+		block->blksize = blksize;
+		block->freeptr = block->endptr = ((char *) block) + blksize;
+
+		dlist_push_tail(&set->blocks, &block->node);
+
+		ptr = ((char *) block) + Bump_BLOCKHDRSZ;
+	}
+	else
+	{
+		if (!dlist_is_empty(&set->blocks))
+			block = dlist_head_element(BumpBlock, node, &set->blocks);
+
+		/* Start a new block if the current one can't fit the request */
+		if (block == NULL ||
+			(Size) (block->endptr - block->freeptr) < required_size)
+		{
+			Size		blksize = set->nextBlockSize;
+
+			/* Block sizes double, up to maxBlockSize */
+			set->nextBlockSize <<= 1;
+			if (set->nextBlockSize > set->maxBlockSize)
+				set->nextBlockSize = set->maxBlockSize;
+
+			/* The block must fit at least this request */
+			while (blksize < required_size + Bump_BLOCKHDRSZ)
+				blksize <<= 1;
+
+			block = (BumpBlock *) malloc(blksize);
+			if (block == NULL)
+				return NULL;
+
+			block->blksize = blksize;
+			block->freeptr = ((char *) block) + Bump_BLOCKHDRSZ;
+			block->endptr = ((char *) block) + blksize;
+
+			/* Mark unallocated space NOACCESS. */
+			VALGRIND_MAKE_MEM_NOACCESS(block->freeptr,
+									   blksize - Bump_BLOCKHDRSZ);
+
+			dlist_push_head(&set->blocks, &block->node);
+		}
+
+		ptr = block->freeptr;
+		block->freeptr += required_size;
+		Assert(block->freeptr <= block->endptr);
+
+		VALGRIND_MAKE_MEM_UNDEFINED(ptr, required_size);
+	}
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	{
+		BumpChunk  *chunk = (BumpChunk *) ptr;
+
+		chunk->size = chunk_size;
+		chunk->requested_size = size;
+		chunk->context = set;
+		/* set mark to catch clobber of "unused" space */
+		if (size < chunk_size)
+			set_sentinel(ptr + Bump_CHUNKHDRSZ, size);
+	}
+#endif
+
+	ptr += Bump_CHUNKHDRSZ;
+
+#ifdef RANDOMIZE_ALLOCATED_MEMORY
+	/* fill the allocated space with junk */
+	randomize_mem(ptr, size);
+#endif
+
+	BumpAllocInfo(set, ptr, size);
+	return ptr;
+}
+
+/*
+ * BumpFree
+ *		Unsupported.
+ *
+ * Only reachable in MEMORY_CONTEXT_CHECKING builds; otherwise there is no
+ * chunk header for pfree() to find this context with.
+ */
+static void
+BumpFree(MemoryContext context, void *pointer)
+{
+	elog(ERROR, "pfree is not supported by the bump memory allocator");
+}
+
+/*
+ * BumpRealloc
+ *		Unsupported, see BumpFree().
+ */
+static void *
+BumpRealloc(MemoryContext context, void *pointer, Size size)
+{
+	elog(ERROR, "%s is not supported by the bump memory allocator", "realloc");
+	return NULL;				/* keep compiler quiet */
+}
+
+/*
+ * BumpGetChunkSpace
+ *		Unsupported, see BumpFree().
+ */
+static Size
+BumpGetChunkSpace(MemoryContext context, void *pointer)
+{
+	elog(ERROR, "%s is not supported by the bump memory allocator",
+		 "GetMemoryChunkSpace");
+	return 0;					/* keep compiler quiet */
+}
+
+/*
+ * BumpIsEmpty
+ *		Is a BumpContext empty of any allocated space?
+ */
+static bool
+BumpIsEmpty(MemoryContext context)
+{
+	BumpContext *set = (BumpContext *) context;
+
+	return dlist_is_empty(&set->blocks);
+}
+
+/*
+ * BumpStats
+ *		Compute stats about memory consumption of a Bump context.
+ *
+ * level: recursion level (0 at top level); used for print indentation.
+ * print: true to print stats to stderr.
+ * totals: if not NULL, add stats about this context into *totals.
+ */
+static void
+BumpStats(MemoryContext context, int level, bool print,
+		  MemoryContextCounters *totals)
+{
+	BumpContext *set = (BumpContext *) context;
+	Size		nblocks = 0;
+	Size		totalspace = 0;
+	Size		freespace = 0;
+	dlist_iter	iter;
+
+	dlist_foreach(iter, &set->blocks)
+	{
+		BumpBlock  *block = dlist_container(BumpBlock, node, iter.cur);
+
+		nblocks++;
+		totalspace += block->blksize;
+		freespace += (block->endptr - block->freeptr);
+	}
+
+	if (print)
+	{
+		int			i;
+
+		for (i = 0; i < level; i++)
+			fprintf(stderr, "  ");
+		fprintf(stderr,
+				"Bump: %s: %zu total in %zd blocks; %zu free; %zu used\n",
+				set->header.name, totalspace, nblocks, freespace,
+				totalspace - freespace);
+	}
+
+	if (totals)
+	{
+		totals->nblocks += nblocks;
+		totals->totalspace += totalspace;
+		totals->freespace += freespace;
+	}
+}
+
+
+#ifdef MEMORY_CONTEXT_CHECKING
+
+/*
+ * BumpCheck
+ *		Walk through chunks and check consistency of memory.
+ *
+ * NOTE: report errors as WARNING, *not* ERROR or FATAL.  Otherwise you'll
+ * find yourself in an infinite loop when trouble occurs, because this
+ * routine will be entered again when elog cleanup tries to release memory!
+ */
+static void
+BumpCheck(MemoryContext context)
+{
+	BumpContext *set = (BumpContext *) context;
+	char	   *name = set->header.name;
+	dlist_iter	iter;
+
+	dlist_foreach(iter, &set->blocks)
+	{
+		BumpBlock  *block = dlist_container(BumpBlock, node, iter.cur);
+		char	   *ptr = ((char *) block) + Bump_BLOCKHDRSZ;
+
+		if (block->freeptr < ptr || block->freeptr > block->endptr)
+			elog(WARNING, "problem in bump %s: corrupt header in block %p",
+				 name, block);
+
+		while (ptr < block->freeptr)
+		{
+			BumpChunk  *chunk = (BumpChunk *) ptr;
+
+			if (chunk->context != set)
+				elog(WARNING, "problem in bump %s: bogus context link in block %p, chunk %p",
+					 name, block, chunk);
+
+			if (chunk->size < chunk->requested_size ||
+				chunk->size != MAXALIGN(chunk->size))
+				elog(WARNING, "problem in bump %s: bogus chunk size in block %p, chunk %p",
+					 name, block, chunk);
+
+			/* check sentinel */
+			if (chunk->requested_size < chunk->size &&
+				!sentinel_ok(chunk, Bump_CHUNKHDRSZ + chunk->requested_size))
+				elog(WARNING, "problem in bump %s: detected write past chunk end in block %p, chunk %p",
+					 name, block, chunk);
+
+			ptr += Bump_CHUNKHDRSZ + chunk->size;
+		}
+
+		if (ptr != block->freeptr)
+			elog(WARNING, "problem in bump %s: chunk sizes do not add up in block %p",
+				 name, block);
+	}
+}
+
+#endif							/* MEMORY_CONTEXT_CHECKING */
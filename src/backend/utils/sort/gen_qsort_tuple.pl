@@ -53,6 +53,54 @@ print <<'EOM';
 EOM
 emit_qsort_implementation();
 
+# Specializations for a leading key whose datum1 compares as an unsigned
+# integer, a signed 64-bit integer or a signed 32-bit integer.  Only the
+# leading key is compared inline; ties go to the generic comparetup routine.
+$EXTRAARGS   = ', Tuplesortstate *state';
+$EXTRAPARAMS = ', state';
+$CMPPARAMS   = ', state';
+
+$SUFFIX = 'tuple_unsigned';
+emit_specialized_comparator('Unsigned');
+emit_qsort_implementation();
+
+$SUFFIX = 'tuple_signed';
+print "\n#if SIZEOF_DATUM >= 8\n";
+emit_specialized_comparator('Signed');
+emit_qsort_implementation();
+print "#endif\n";
+
+$SUFFIX = 'tuple_int32';
+emit_specialized_comparator('Int32');
+emit_qsort_implementation();
+
+sub emit_specialized_comparator
+{
+	my $KIND = shift;
+
+	print <<EOM;
+
+static inline int
+cmp_$SUFFIX(SortTuple *a, SortTuple *b, Tuplesortstate *state)
+{
+	int			compare;
+
+	compare = Apply${KIND}SortComparator(a->datum1, a->isnull1,
+										b->datum1, b->isnull1,
+										state->sortKeys);
+	if (compare != 0)
+		return compare;
+
+	/* With only one sort key, there is nothing to break the tie */
+	if (state->onlyKey != NULL)
+		return 0;
+
+	return state->comparetup(a, b, state);
+}
+
+EOM
+}
+
 sub emit_qsort_boilerplate
 {
 	print <<'EOM';
@@ -59,6 +59,54 @@ comparison_shim(Datum x, Datum y, SortSupport ssup)
 	return result;
 }
 
+/*
+ * Comparators for datatypes whose Datum (or abbreviated key) sorts the same
+ * way as an unsigned integer, a signed 64-bit integer or a signed 32-bit
+ * integer.  tuplesort.c recognizes these by address and uses sort routines
+ * with the comparison inlined, so they should be preferred over equivalent
+ * type-specific functions.
+ */
+int
+ssup_datum_unsigned_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	if (x < y)
+		return -1;
+	else if (x > y)
+		return 1;
+	else
+		return 0;
+}
+
+#if SIZEOF_DATUM >= 8
+int
+ssup_datum_signed_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	int64		xx = (int64) x;
+	int64		yy = (int64) y;
+
+	if (xx < yy)
+		return -1;
+	else if (xx > yy)
+		return 1;
+	else
+		return 0;
+}
+#endif
+
+int
+ssup_datum_int32_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	int32		xx = DatumGetInt32(x);
+	int32		yy = DatumGetInt32(y);
+
+	if (xx < yy)
+		return -1;
+	else if (xx > yy)
+		return 1;
+	else
+		return 0;
+}
+
 /*
  * Set up a shim function to allow use of an old-style btree comparison
  * function as if it were a sort support comparator.
@@ -5610,6 +5610,7 @@ getTables(Archive *fout, int *numTables)
 	int			i_partkeydef;
 	int			i_ispartition;
 	int			i_partbound;
+	int			i_amname;
 
 	/* Make sure we are in proper schema */
 	selectSourceSchema(fout, "pg_catalog");
@@ -5714,6 +5715,7 @@ getTables(Archive *fout, int *numTables)
 						  "OR %s IS NOT NULL"
 						  "))"
 						  "AS changed_acl, "
+						  "(SELECT amname FROM pg_am a WHERE a.oid = c.relam AND c.relkind = '%c') AS amname, "
 						  "%s AS partkeydef, "
 						  "%s AS ispartition, "
 						  "%s AS partbound "
@@ -5740,6 +5742,7 @@ getTables(Archive *fout, int *numTables)
 						  attracl_subquery->data,
 						  attinitacl_subquery->data,
 						  attinitracl_subquery->data,
+						  RELKIND_RELATION,
 						  partkeydef,
 						  ispartition,
 						  partbound,
@@ -5789,6 +5792,7 @@ getTables(Archive *fout, int *numTables)
 						  "WHEN 'check_option=cascaded' = ANY (c.reloptions) THEN 'CASCADED'::text ELSE NULL END AS checkoption, "
 						  "tc.reloptions AS toast_reloptions, "
 						  "NULL AS changed_acl, "
+						  "NULL AS amname, "
 						  "NULL AS partkeydef, "
 						  "false AS ispartition, "
 						  "NULL AS partbound "
@@ -5838,6 +5842,7 @@ getTables(Archive *fout, int *numTables)
 						  "WHEN 'check_option=cascaded' = ANY (c.reloptions) THEN 'CASCADED'::text ELSE NULL END AS checkoption, "
 						  "tc.reloptions AS toast_reloptions, "
 						  "NULL AS changed_acl, "
+						  "NULL AS amname, "
 						  "NULL AS partkeydef, "
 						  "false AS ispartition, "
 						  "NULL AS partbound "
@@ -5887,6 +5892,7 @@ getTables(Archive *fout, int *numTables)
 						  "WHEN 'check_option=cascaded' = ANY (c.reloptions) THEN 'CASCADED'::text ELSE NULL END AS checkoption, "
 						  "tc.reloptions AS toast_reloptions, "
 						  "NULL AS changed_acl, "
+						  "NULL AS amname, "
 						  "NULL AS partkeydef, "
 						  "false AS ispartition, "
 						  "NULL AS partbound "
@@ -5934,6 +5940,7 @@ getTables(Archive *fout, int *numTables)
 						  "c.reloptions AS reloptions, "
 						  "tc.reloptions AS toast_reloptions, "
 						  "NULL AS changed_acl, "
+						  "NULL AS amname, "
 						  "NULL AS partkeydef, "
 						  "false AS ispartition, "
 						  "NULL AS partbound "
@@ -5981,6 +5988,7 @@ getTables(Archive *fout, int *numTables)
 						  "c.reloptions AS reloptions, "
 						  "tc.reloptions AS toast_reloptions, "
 						  "NULL AS changed_acl, "
+						  "NULL AS amname, "
 						  "NULL AS partkeydef, "
 						  "false AS ispartition, "
 						  "NULL AS partbound "
@@ -6027,6 +6035,7 @@ getTables(Archive *fout, int *numTables)
 						  "c.reloptions AS reloptions, "
 						  "tc.reloptions AS toast_reloptions, "
 						  "NULL AS changed_acl, "
+						  "NULL AS amname, "
 						  "NULL AS partkeydef, "
 						  "false AS ispartition, "
 						  "NULL AS partbound "
@@ -6073,6 +6082,7 @@ getTables(Archive *fout, int *numTables)
 						  "c.reloptions AS reloptions, "
 						  "NULL AS toast_reloptions, "
 						  "NULL AS changed_acl, "
+						  "NULL AS amname, "
 						  "NULL AS partkeydef, "
 						  "false AS ispartition, "
 						  "NULL AS partbound "
@@ -6118,6 +6128,7 @@ getTables(Archive *fout, int *numTables)
 						  "NULL AS reloptions, "
 						  "NULL AS toast_reloptions, "
 						  "NULL AS changed_acl, "
+						  "NULL AS amname, "
 						  "NULL AS partkeydef, "
 						  "false AS ispartition, "
 						  "NULL AS partbound "
@@ -6187,6 +6198,7 @@ getTables(Archive *fout, int *numTables)
 	i_reloftype = PQfnumber(res, "reloftype");
 	i_is_identity_sequence = PQfnumber(res, "is_identity_sequence");
 	i_changed_acl = PQfnumber(res, "changed_acl");
+	i_amname = PQfnumber(res, "amname");
 	i_partkeydef = PQfnumber(res, "partkeydef");
 	i_ispartition = PQfnumber(res, "ispartition");
 	i_partbound = PQfnumber(res, "partbound");
@@ -6292,6 +6304,12 @@ getTables(Archive *fout, int *numTables)
 		tblinfo[i].is_identity_sequence = (i_is_identity_sequence >= 0 &&
 										   strcmp(PQgetvalue(res, i, i_is_identity_sequence), "t") == 0);
 
+		/* Table access method name, or NULL for the heap */
+		if (PQgetisnull(res, i, i_amname))
+			tblinfo[i].amname = NULL;
+		else
+			tblinfo[i].amname = pg_strdup(PQgetvalue(res, i, i_amname));
+
 		/* Partition key string or NULL */
 		tblinfo[i].partkeydef = pg_strdup(PQgetvalue(res, i, i_partkeydef));
 		tblinfo[i].ispartition = (strcmp(PQgetvalue(res, i, i_ispartition), "t") == 0);
@@ -12373,6 +12391,9 @@ dumpAccessMethod(Archive *fout, AccessMethodInfo *aminfo)
 		case AMTYPE_INDEX:
 			appendPQExpBuffer(q, "TYPE INDEX ");
 			break;
+		case AMTYPE_TABLE:
+			appendPQExpBuffer(q, "TYPE TABLE ");
+			break;
 		default:
 			write_msg(NULL, "WARNING: invalid type \"%c\" of access method \"%s\"\n",
 					  aminfo->amtype, qamname);
@@ -15451,6 +15472,9 @@ dumpTableSchema(Archive *fout, TableInfo *tbinfo)
 			if (tbinfo->relkind == RELKIND_PARTITIONED_TABLE)
 				appendPQExpBuffer(q, "\nPARTITION BY %s", tbinfo->partkeydef);
 
+			if (tbinfo->amname != NULL)
+				appendPQExpBuffer(q, "\nUSING %s", fmtId(tbinfo->amname));
+
 			if (tbinfo->relkind == RELKIND_FOREIGN_TABLE)
 				appendPQExpBuffer(q, "\nSERVER %s", fmtId(srvname));
 		}
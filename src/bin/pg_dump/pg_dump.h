@@ -269,6 +269,7 @@ typedef struct _tableInfo
 	bool		relispopulated; /* relation is populated */
 	char		relreplident;	/* replica identifier */
 	char	   *reltablespace;	/* relation tablespace */
+	char	   *amname;			/* table access method, or NULL for heap */
 	char	   *reloptions;		/* options specified by WITH (...) */
 	char	   *checkoption;	/* WITH CHECK OPTION, if any */
 	char	   *toast_reloptions;	/* WITH options for the TOAST table */
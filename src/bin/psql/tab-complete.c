@@ -2247,7 +2247,7 @@ psql_completion(const char *text, int start, int end)
 		COMPLETE_WITH_CONST("TYPE");
 	/* Complete "CREATE ACCESS METHOD <name> TYPE" */
 	else if (Matches5("CREATE", "ACCESS", "METHOD", MatchAny, "TYPE"))
-		COMPLETE_WITH_CONST("INDEX");
+		COMPLETE_WITH_LIST2("INDEX", "TABLE");
 	/* Complete "CREATE ACCESS METHOD <name> TYPE <type>" */
 	else if (Matches6("CREATE", "ACCESS", "METHOD", MatchAny, "TYPE", MatchAny))
 		COMPLETE_WITH_CONST("HANDLER");
@@ -2465,7 +2465,7 @@ psql_completion(const char *text, int start, int end)
 	else if (Matches3("CREATE", "STATISTICS", MatchAny))
 		COMPLETE_WITH_LIST2("(", "ON");
 	else if (Matches4("CREATE", "STATISTICS", MatchAny, "("))
-		COMPLETE_WITH_LIST2("ndistinct", "dependencies");
+		COMPLETE_WITH_LIST3("ndistinct", "dependencies", "mcv");
 	else if (HeadMatches3("CREATE", "STATISTICS", MatchAny) &&
 			 previous_words[0][0] == '(' &&
 			 previous_words[0][strlen(previous_words[0]) - 1] == ')')
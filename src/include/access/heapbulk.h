@@ -0,0 +1,29 @@
+/*-------------------------------------------------------------------------
+ *
+ * heapbulk.h
+ *	  Declarations for bulk writing of new heap pages
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/heapbulk.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef HEAPBULK_H
+#define HEAPBULK_H
+
+#include "access/htup.h"
+#include "utils/relcache.h"
+
+/* struct definition is private to heapbulk.c */
+typedef struct HeapBulkWriteStateData *HeapBulkWriteState;
+
+extern bool heap_can_bulk_write(Relation rel);
+extern HeapBulkWriteState begin_heap_bulk_write(Relation rel, CommandId cid,
+					  int options);
+extern void heap_bulk_write_tuples(HeapBulkWriteState state, HeapTuple *tuples,
+					   int ntuples);
+extern void end_heap_bulk_write(HeapBulkWriteState state);
+
+#endif							/* HEAPBULK_H */
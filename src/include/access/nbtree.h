@@ -21,6 +21,8 @@
 #include "catalog/pg_index.h"
 #include "lib/stringinfo.h"
 #include "storage/bufmgr.h"
+#include "storage/dsm.h"
+#include "storage/shm_toc.h"
 
 /* There's room for a 16-bit vacuum cycle ID in BTPageOpaqueData */
 typedef uint16 BTCycleId;
@@ -372,6 +374,17 @@ typedef struct BTArrayKeyInfo
 	Datum	   *elem_values;	/* array of num_elems Datums */
 } BTArrayKeyInfo;
 
+/*
+ * State of a skip scan, which is used when there are scan keys on the second
+ * index column but none on the first.  See _bt_skip_advance.
+ */
+typedef enum BTSkipState
+{
+	BTSKIP_NONE,				/* not a skip scan */
+	BTSKIP_PREFIX,				/* scanning the entries with one leading value */
+	BTSKIP_RANGE				/* gave up skipping, scanning the rest in full */
+} BTSkipState;
+
 typedef struct BTScanOpaqueData
 {
 	/* these fields are set by _bt_preprocess_keys(): */
@@ -388,6 +401,20 @@ typedef struct BTScanOpaqueData
 	BTArrayKeyInfo *arrayKeys;	/* info about each equality-type array key */
 	MemoryContext arrayContext; /* scan-lifespan context for array data */
 
+	/* workspace for skip scans */
+	BTSkipState skipState;		/* see above */
+	ScanKey		skipKeyData;	/* leading-column key + copy of scan->keyData */
+	FmgrInfo	skipEqProc;		/* leading column's equality function */
+	Datum		skipPrefix;		/* current leading-column value */
+	bool		skipPrefixIsNull;
+	BlockNumber skipPrefixPage; /* leaf page where we found skipPrefix */
+	int			skipNearCount;	/* # of consecutive skips that stayed on the
+								 * same leaf page */
+	BTSkipState markSkipState;	/* skip scan state at the mark */
+	Datum		markSkipPrefix;
+	bool		markSkipPrefixIsNull;
+	MemoryContext skipContext;	/* scan-lifespan context for skip scan data */
+
 	/* info about killed items if any (killedItems is NULL if never used) */
 	int		   *killedItems;	/* currPos.items indexes of killed items */
 	int			numKilled;		/* number of currently stored items */
@@ -430,8 +457,6 @@ typedef BTScanOpaqueData *BTScanOpaque;
 /*
  * external entry points for btree, in nbtree.c
  */
-extern IndexBuildResult *btbuild(Relation heap, Relation index,
-		struct IndexInfo *indexInfo);
 extern void btbuildempty(Relation index);
 extern bool btinsert(Relation rel, Datum *values, bool *isnull,
 		 ItemPointer ht_ctid, Relation heapRel,
@@ -510,6 +535,8 @@ extern bool _bt_first(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_next(IndexScanDesc scan, ScanDirection dir);
 extern Buffer _bt_get_endpoint(Relation rel, uint32 level, bool rightmost,
 				 Snapshot snapshot);
+extern bool _bt_start_skip_scan(IndexScanDesc scan, ScanDirection dir);
+extern bool _bt_skip_advance(IndexScanDesc scan, ScanDirection dir);
 
 /*
  * prototypes for functions in nbtutils.c
@@ -523,6 +550,11 @@ extern void _bt_start_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_advance_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern void _bt_mark_array_keys(IndexScanDesc scan);
 extern void _bt_restore_array_keys(IndexScanDesc scan);
+extern void _bt_preprocess_skip_scan(IndexScanDesc scan);
+extern void _bt_set_skip_prefix(IndexScanDesc scan, BTSkipState state,
+					Datum prefix, bool isnull);
+extern void _bt_mark_skip_scan(IndexScanDesc scan);
+extern void _bt_restore_skip_scan(IndexScanDesc scan);
 extern void _bt_preprocess_keys(IndexScanDesc scan);
 extern IndexTuple _bt_checkkeys(IndexScanDesc scan,
 			  Page page, OffsetNumber offnum,
@@ -547,13 +579,8 @@ extern bool btvalidate(Oid opclassoid);
 /*
  * prototypes for functions in nbtsort.c
  */
-typedef struct BTSpool BTSpool; /* opaque type known only within nbtsort.c */
-
-extern BTSpool *_bt_spoolinit(Relation heap, Relation index,
-			  bool isunique, bool isdead);
-extern void _bt_spooldestroy(BTSpool *btspool);
-extern void _bt_spool(BTSpool *btspool, ItemPointer self,
-		  Datum *values, bool *isnull);
-extern void _bt_leafbuild(BTSpool *btspool, BTSpool *spool2);
+extern IndexBuildResult *btbuild(Relation heap, Relation index,
+		struct IndexInfo *indexInfo);
+extern void _bt_parallel_build_main(dsm_segment *seg, shm_toc *toc);
 
 #endif							/* NBTREE_H */
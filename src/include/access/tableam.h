@@ -0,0 +1,219 @@
+/*-------------------------------------------------------------------------
+ *
+ * tableam.h
+ *	  API for Postgres table access methods.
+ *
+ * Copyright (c) 2017, PostgreSQL Global Development Group
+ *
+ * src/include/access/tableam.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef TABLEAM_H
+#define TABLEAM_H
+
+#include "access/heapam.h"
+#include "access/sdir.h"
+#include "executor/tuptable.h"
+#include "utils/rel.h"
+#include "utils/snapshot.h"
+
+/* This file shouldn't depend on vacuum.h. */
+struct VacuumParams;
+
+/*
+ * A scan descriptor is private to the table AM that created it; callers just
+ * hand it back to the AM.
+ */
+typedef struct TableScanDescData *TableScanDesc;
+
+
+/*
+ * Callback function signatures --- see tableam.sgml for more info.
+ *
+ * Tuples are passed to and from the AM in the executor's usual formats:
+ * scans and fetches store them in a TupleTableSlot, and new tuples arrive
+ * as HeapTuples.  An AM that stores data in some other format converts
+ * between it and these.
+ */
+
+/* start a scan of the whole table */
+typedef TableScanDesc (*scan_begin_function) (Relation rel,
+											  Snapshot snapshot,
+											  int nkeys,
+											  ScanKey key);
+
+/* restart a scan */
+typedef void (*scan_rescan_function) (TableScanDesc scan, ScanKey key);
+
+/* end a scan */
+typedef void (*scan_end_function) (TableScanDesc scan);
+
+/*
+ * fetch the next visible tuple into slot; false at end of scan.  The slot's
+ * contents must remain valid until the slot is cleared or reused, even if
+ * the scan goes on to fetch more tuples into other slots.
+ */
+typedef bool (*scan_getnextslot_function) (TableScanDesc scan,
+										   ScanDirection direction,
+										   TupleTableSlot *slot);
+
+/* fetch the row version identified by tid, if visible to snapshot */
+typedef bool (*tuple_fetch_row_version_function) (Relation rel,
+												  ItemPointer tid,
+												  Snapshot snapshot,
+												  TupleTableSlot *slot);
+
+/*
+ * is the row version in slot, as stored there by scan_getnextslot or
+ * tuple_fetch_row_version, visible to snapshot?
+ */
+typedef bool (*tuple_satisfies_snapshot_function) (Relation rel,
+												   TupleTableSlot *slot,
+												   Snapshot snapshot);
+
+/* insert a tuple, setting its t_self */
+typedef Oid (*tuple_insert_function) (Relation rel,
+									  HeapTuple tup,
+									  CommandId cid,
+									  int options,
+									  BulkInsertState bistate);
+
+/* delete the tuple identified by tid */
+typedef HTSU_Result (*tuple_delete_function) (Relation rel,
+											  ItemPointer tid,
+											  CommandId cid,
+											  Snapshot crosscheck,
+											  bool wait,
+											  HeapUpdateFailureData *hufd);
+
+/* replace the tuple identified by otid with newtup, setting its t_self */
+typedef HTSU_Result (*tuple_update_function) (Relation rel,
+											  ItemPointer otid,
+											  HeapTuple newtup,
+											  CommandId cid,
+											  Snapshot crosscheck,
+											  bool wait,
+											  HeapUpdateFailureData *hufd,
+											  LockTupleMode *lockmode);
+
+/* VACUUM (but not VACUUM FULL) the table */
+typedef void (*relation_vacuum_function) (Relation rel,
+										  int options,
+										  struct VacuumParams *params,
+										  BufferAccessStrategy bstrategy);
+
+/*
+ * API struct for a table AM.  The handler function must return a pointer to
+ * one of these that stays valid for the life of the backend, normally a
+ * static const struct, as relcache entries point to it.
+ */
+typedef struct TableAmRoutine
+{
+	NodeTag		type;
+
+	/* scans */
+	scan_begin_function scan_begin;
+	scan_rescan_function scan_rescan;
+	scan_end_function scan_end;
+	scan_getnextslot_function scan_getnextslot;
+
+	/* visibility-checked fetch of a single row version */
+	tuple_fetch_row_version_function tuple_fetch_row_version;
+
+	/* visibility of a row version already fetched */
+	tuple_satisfies_snapshot_function tuple_satisfies_snapshot;
+
+	/* modifications */
+	tuple_insert_function tuple_insert;
+	tuple_delete_function tuple_delete;
+	tuple_update_function tuple_update;
+
+	/* maintenance */
+	relation_vacuum_function relation_vacuum;
+} TableAmRoutine;
+
+
+/*
+ * Wrappers for calling a relation's table AM.  The relation must be a table
+ * or materialized view (or a TOAST table), which always have rd_tableam set.
+ */
+static inline TableScanDesc
+table_beginscan(Relation rel, Snapshot snapshot, int nkeys, ScanKey key)
+{
+	return rel->rd_tableam->scan_begin(rel, snapshot, nkeys, key);
+}
+
+static inline void
+table_rescan(Relation rel, TableScanDesc scan, ScanKey key)
+{
+	rel->rd_tableam->scan_rescan(scan, key);
+}
+
+static inline void
+table_endscan(Relation rel, TableScanDesc scan)
+{
+	rel->rd_tableam->scan_end(scan);
+}
+
+static inline bool
+table_scan_getnextslot(Relation rel, TableScanDesc scan,
+					   ScanDirection direction, TupleTableSlot *slot)
+{
+	return rel->rd_tableam->scan_getnextslot(scan, direction, slot);
+}
+
+static inline bool
+table_fetch_row_version(Relation rel, ItemPointer tid, Snapshot snapshot,
+						TupleTableSlot *slot)
+{
+	return rel->rd_tableam->tuple_fetch_row_version(rel, tid, snapshot, slot);
+}
+
+static inline bool
+table_tuple_satisfies_snapshot(Relation rel, TupleTableSlot *slot,
+							   Snapshot snapshot)
+{
+	return rel->rd_tableam->tuple_satisfies_snapshot(rel, slot, snapshot);
+}
+
+static inline Oid
+table_insert(Relation rel, HeapTuple tup, CommandId cid, int options,
+			 BulkInsertState bistate)
+{
+	return rel->rd_tableam->tuple_insert(rel, tup, cid, options, bistate);
+}
+
+static inline HTSU_Result
+table_delete(Relation rel, ItemPointer tid, CommandId cid,
+			 Snapshot crosscheck, bool wait, HeapUpdateFailureData *hufd)
+{
+	return rel->rd_tableam->tuple_delete(rel, tid, cid, crosscheck, wait,
+										 hufd);
+}
+
+static inline HTSU_Result
+table_update(Relation rel, ItemPointer otid, HeapTuple newtup, CommandId cid,
+			 Snapshot crosscheck, bool wait, HeapUpdateFailureData *hufd,
+			 LockTupleMode *lockmode)
+{
+	return rel->rd_tableam->tuple_update(rel, otid, newtup, cid, crosscheck,
+										 wait, hufd, lockmode);
+}
+
+static inline void
+table_relation_vacuum(Relation rel, int options, struct VacuumParams *params,
+					  BufferAccessStrategy bstrategy)
+{
+	rel->rd_tableam->relation_vacuum(rel, options, params, bstrategy);
+}
+
+
+/* Functions in access/table/tableamapi.c */
+extern const TableAmRoutine *GetTableAmRoutine(Oid amhandler);
+extern const TableAmRoutine *GetTableAmRoutineByAmId(Oid amoid);
+
+/* Functions in access/heap/heapam_handler.c */
+extern const TableAmRoutine *GetHeapamTableAmRoutine(void);
+
+#endif							/* TABLEAM_H */
@@ -135,6 +135,14 @@ typedef struct VariableCacheData
 	TransactionId latestCompletedXid;	/* newest XID that has committed or
 										 * aborted */
 
+	/*
+	 * Number of top-level transactions with XIDs that have completed, or
+	 * otherwise left the set of running XIDs, since startup.  Used to decide
+	 * whether a previously computed snapshot is still valid, see
+	 * GetSnapshotData().  Also protected by ProcArrayLock.
+	 */
+	uint64		xactCompletionCount;
+
 	/*
 	 * These fields are protected by CLogTruncationLock
 	 */
@@ -43,6 +43,25 @@ typedef struct tupleConstr
 	bool		has_not_null;
 } TupleConstr;
 
+/*
+ * Deforming program of a tuple descriptor: one step per attribute, holding
+ * what heaptuple.c needs to extract that attribute from a tuple.  The steps
+ * are kept in an array of their own so that deforming a tuple doesn't have
+ * to chase a pointer to each attribute's Form_pg_attribute, and they carry
+ * precomputed alignment padding, so that fixed-width attributes following a
+ * variable-width one don't have to be aligned one by one.  See
+ * build_deform_steps() in heaptuple.c for how they are worked out.
+ */
+typedef struct TupleDeformStep
+{
+	int32		attoff;			/* offset in tuple data, if fixed, else -1 */
+	int16		attlen;			/* copies of the attribute's properties */
+	bool		attbyval;
+	char		attalign;
+	uint8		attpad;			/* padding before this attribute, if !attrealign */
+	bool		attrealign;		/* must the offset be aligned at run time? */
+} TupleDeformStep;
+
 /*
  * This struct is passed around within the backend to describe the structure
  * of tuples.  For tuples coming from on-disk relations, the information is
@@ -67,6 +86,10 @@ typedef struct tupleConstr
  * context and go away when the context is freed.  We set the tdrefcount
  * field of such a descriptor to -1, while reference-counted descriptors
  * always have tdrefcount >= 0.
+ *
+ * tddeform has room for natts deforming steps, which are filled in when the
+ * tupdesc is first used to deform a tuple; tdnfixed is -1 until then.
+ * Functions that change an attribute's entry reset it.
  */
 typedef struct tupleDesc
 {
@@ -78,6 +101,8 @@ typedef struct tupleDesc
 	int32		tdtypmod;		/* typmod for tuple type */
 	bool		tdhasoid;		/* tuple has oid attribute in its header */
 	int			tdrefcount;		/* reference count, or -1 if not counting */
+	int			tdnfixed;		/* # of leading atts at fixed offsets, or -1 */
+	TupleDeformStep *tddeform;	/* array of natts deforming steps */
 }		   *TupleDesc;
 
 
@@ -62,6 +62,7 @@ extern Oid heap_create_with_catalog(const char *relname,
 						 List *cooked_constraints,
 						 char relkind,
 						 char relpersistence,
+						 Oid accessmtd,
 						 bool shared_relation,
 						 bool mapped_relation,
 						 bool oidislocal,
@@ -420,6 +420,9 @@ extern void ExecScanReScan(ScanState *node);
 extern void ExecInitResultTupleSlot(EState *estate, PlanState *planstate);
 extern void ExecInitScanTupleSlot(EState *estate, ScanState *scanstate);
 extern TupleTableSlot *ExecInitExtraTupleSlot(EState *estate);
+extern TupleBatch *ExecInitTupleBatch(EState *estate, TupleDesc tupdesc,
+				   int maxslots);
+extern void ExecClearTupleBatch(TupleBatch *batch);
 extern TupleTableSlot *ExecInitNullTupleSlot(EState *estate,
 					  TupleDesc tupType);
 extern TupleDesc ExecTypeFromTL(List *targetList, bool hasoid);
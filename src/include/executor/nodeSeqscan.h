@@ -21,6 +21,10 @@ extern SeqScanState *ExecInitSeqScan(SeqScan *node, EState *estate, int eflags);
 extern void ExecEndSeqScan(SeqScanState *node);
 extern void ExecReScanSeqScan(SeqScanState *node);
 
+/* batch mode support */
+extern TupleBatch *ExecSeqScanInitBatch(SeqScanState *node, int maxslots);
+extern int	ExecSeqScanBatch(SeqScanState *node, TupleBatch *batch);
+
 /* parallel scan support */
 extern void ExecSeqScanEstimate(SeqScanState *node, ParallelContext *pcxt);
 extern void ExecSeqScanInitializeDSM(SeqScanState *node, ParallelContext *pcxt);
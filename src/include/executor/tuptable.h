@@ -106,6 +106,11 @@
  * MINIMAL_TUPLE_OFFSET bytes before tts_mintuple.  This allows column
  * extraction to treat the case identically to regular physical tuples.
  *
+ * tts_bufhdr is workspace for a table AM that stores a tuple in a buffer page
+ * in the slot, but gets the tuple's header in storage that it reuses for the
+ * next tuple, such as a heap scan's rs_ctup.  Copying the header here lets the
+ * slot's contents stay valid while the scan moves on.
+ *
  * tts_slow/tts_off are saved state for slot_deform_tuple, and should not
  * be touched by any other code.
  *----------
@@ -126,6 +131,7 @@ typedef struct TupleTableSlot
 	bool	   *tts_isnull;		/* current per-attribute isnull flags */
 	MinimalTuple tts_mintuple;	/* minimal tuple, or NULL if none */
 	HeapTupleData tts_minhdr;	/* workspace for minimal-tuple-only case */
+	HeapTupleData tts_bufhdr;	/* workspace for buffer tuple's header */
 	long		tts_off;		/* saved state for slot_deform_tuple */
 } TupleTableSlot;
 
@@ -16,8 +16,10 @@
 
 #include "access/genam.h"
 #include "access/heapam.h"
+#include "access/tableam.h"
 #include "access/tupconvert.h"
 #include "executor/instrument.h"
+#include "lib/ilist.h"
 #include "lib/pairingheap.h"
 #include "nodes/params.h"
 #include "nodes/plannodes.h"
@@ -121,11 +123,12 @@ typedef struct ExprState
  *		ReadyForInserts		is it valid for inserts?
  *		Concurrent			are we doing a concurrent index build?
  *		BrokenHotChain		did we detect any broken HOT chains?
+ *		ParallelWorkers		# of workers requested (excludes leader)
  *		AmCache				private cache area for index AM
  *		Context				memory context holding this IndexInfo
  *
- * ii_Concurrent and ii_BrokenHotChain are used only during index build;
- * they're conventionally set to false otherwise.
+ * ii_Concurrent, ii_BrokenHotChain, and ii_ParallelWorkers are used only
+ * during index build; they're conventionally zeroed otherwise.
  * ----------------
  */
 typedef struct IndexInfo
@@ -147,6 +150,7 @@ typedef struct IndexInfo
 	bool		ii_ReadyForInserts;
 	bool		ii_Concurrent;
 	bool		ii_BrokenHotChain;
+	int			ii_ParallelWorkers;
 	void	   *ii_AmCache;
 	MemoryContext ii_Context;
 } IndexInfo;
@@ -1108,9 +1112,27 @@ typedef struct ScanState
 typedef struct SeqScanState
 {
 	ScanState	ss;				/* its first field is NodeTag */
+	TableScanDesc tablescan;	/* table AM scan, or NULL if not started */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
 } SeqScanState;
 
+/* ----------------
+ *	 TupleBatch information
+ *
+ *		A batch of tuples handed from a scan node to its parent in a single
+ *		call, rather than one ExecProcNode call per tuple.  The parent owns
+ *		the batch, and consumes slots[next] .. slots[nslots - 1] before
+ *		asking for the next batch.  See ExecSeqScanBatch.
+ * ----------------
+ */
+typedef struct TupleBatch
+{
+	int			maxslots;		/* allocated length of slots[] */
+	int			nslots;			/* number of slots filled */
+	int			next;			/* next slot to be consumed */
+	TupleTableSlot **slots;		/* array of maxslots slots */
+} TupleBatch;
+
 /* ----------------
  *	 SampleScanState information
  * ----------------
@@ -1730,6 +1752,60 @@ typedef struct MaterialState
 	Tuplestorestate *tuplestorestate;
 } MaterialState;
 
+/* ----------------
+ *	 ResultCacheInstrumentation information
+ *
+ *		counters kept by a result cache node, for EXPLAIN ANALYZE
+ * ----------------
+ */
+typedef struct ResultCacheInstrumentation
+{
+	uint64		cache_hits;		/* rescans answered from the cache */
+	uint64		cache_misses;	/* rescans that had to run the subplan */
+	uint64		cache_evictions;	/* entries evicted to free memory */
+	uint64		cache_overflows;	/* rescans whose rows didn't fit */
+	uint64		mem_peak;		/* peak memory usage, in bytes */
+} ResultCacheInstrumentation;
+
+/* ----------------
+ *	 ResultCacheState information
+ *
+ *		result cache nodes keep the rows their subplan returned for each
+ *		set of parameter values in a hash table, up to work_mem, and evict
+ *		the least recently used entries when that runs out.
+ *		See nodeResultCache.c.
+ * ----------------
+ */
+struct resultcache_hash;		/* the hash table type, in nodeResultCache.c */
+struct ResultCacheEntry;
+struct ResultCacheTuple;
+
+typedef struct ResultCacheState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	int			rc_status;		/* state of ExecResultCache's state machine */
+	int			nkeys;			/* number of cache keys */
+	struct resultcache_hash *hashtable; /* hash table of cache entries */
+	TupleDesc	hashkeydesc;	/* tuple descriptor of the cache keys */
+	TupleTableSlot *tableslot;	/* holds the key of an existing entry */
+	TupleTableSlot *probeslot;	/* holds the key being looked up */
+	List	   *param_exprs;	/* ExprStates computing the keys */
+	AttrNumber *keyColIdx;		/* 1 .. nkeys, for execTuplesMatch */
+	FmgrInfo   *eqfunctions;	/* equality function of each key */
+	FmgrInfo   *hashfunctions;	/* hash function of each key */
+	MemoryContext tableContext; /* holds the entries, keys and tuples */
+	MemoryContext tempContext;	/* short-term context for hashing and
+								 * comparing keys */
+	dlist_head	lru_list;		/* keys, least recently used first */
+	struct ResultCacheEntry *entry; /* entry for the current scan, if any */
+	struct ResultCacheTuple *last_tuple;	/* last tuple returned or cached */
+	bool		singlerow;		/* entries complete after the first row? */
+	uint64		mem_used;		/* bytes of memory used by the cache */
+	uint64		mem_limit;		/* memory limit, in bytes */
+	Bitmapset  *keyparamids;	/* ids of the params in param_exprs */
+	ResultCacheInstrumentation stats;	/* for EXPLAIN ANALYZE */
+} ResultCacheState;
+
 /* ----------------
  *	 SortState information
  * ----------------
@@ -1806,6 +1882,7 @@ typedef struct AggState
 	Tuplesortstate *sort_in;	/* sorted input to phases > 1 */
 	Tuplesortstate *sort_out;	/* input is copied here for next phase */
 	TupleTableSlot *sort_slot;	/* slot for sort results */
+	TupleBatch *input_batch;	/* batch of outer tuples, if fetched that way */
 	/* these fields are used in AGG_PLAIN and AGG_SORTED modes: */
 	AggStatePerGroup pergroup;	/* per-Aggref-per-group working state */
 	HeapTuple	grp_firstTuple; /* copy of first tuple of current group */
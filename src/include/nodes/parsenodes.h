@@ -2003,6 +2003,7 @@ typedef struct CreateStmt
 	List	   *options;		/* options from WITH clause */
 	OnCommitAction oncommit;	/* what do we do at COMMIT? */
 	char	   *tablespacename; /* table space to use, or NULL */
+	char	   *accessMethod;	/* table access method, or NULL for heap */
 	bool		if_not_exists;	/* just do nothing if it already exists? */
 } CreateStmt;
 
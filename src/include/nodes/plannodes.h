@@ -735,6 +735,28 @@ typedef struct Material
 	Plan		plan;
 } Material;
 
+/* ----------------
+ *		result cache node
+ *
+ * Caches the rows its subplan returns for each set of values of the
+ * param_exprs, so that rescanning it with values that were seen before
+ * doesn't have to run the subplan again.  The subplan must depend on no
+ * other parameters that change between rescans.  If singlerow is true,
+ * a cache entry is complete after the first row, because the parent only
+ * ever asks for one.
+ * ----------------
+ */
+typedef struct ResultCache
+{
+	Plan		plan;
+	int			numKeys;		/* number of cache keys */
+	Oid		   *hashOperators;	/* hashable equality operator of each key */
+	List	   *param_exprs;	/* the cache keys */
+	bool		singlerow;		/* entries complete after the first row? */
+	uint32		est_entries;	/* planner's estimate of the number of
+								 * entries that will fit, or 0 if unknown */
+} ResultCache;
+
 /* ----------------
  *		sort node
  * ----------------
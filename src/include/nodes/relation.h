@@ -1226,6 +1226,25 @@ typedef struct MaterialPath
 	Path	   *subpath;
 } MaterialPath;
 
+/*
+ * ResultCachePath represents a ResultCache plan node, i.e., a cache of the
+ * rows its parameterized subpath returns for each set of values of
+ * param_exprs.  It's used on the inner side of a nestloop, where rescans
+ * with parameter values seen before can be served from the cache.  calls is
+ * the number of rescans expected; est_entries is filled in by costing.
+ */
+typedef struct ResultCachePath
+{
+	Path		path;
+	Path	   *subpath;		/* path whose rows are cached */
+	List	   *hash_operators; /* hashable equality operator of each key */
+	List	   *param_exprs;	/* the cache keys */
+	bool		singlerow;		/* entries complete after the first row? */
+	double		calls;			/* expected number of rescans */
+	uint32		est_entries;	/* expected number of entries that will fit
+								 * in the cache, or 0 if unknown */
+} ResultCachePath;
+
 /*
  * UniquePath represents elimination of distinct rows from the output of
  * its subpath.
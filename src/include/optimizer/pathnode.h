@@ -75,6 +75,13 @@ extern MergeAppendPath *create_merge_append_path(PlannerInfo *root,
 extern ResultPath *create_result_path(PlannerInfo *root, RelOptInfo *rel,
 				   PathTarget *target, List *resconstantqual);
 extern MaterialPath *create_material_path(RelOptInfo *rel, Path *subpath);
+extern ResultCachePath *create_resultcache_path(PlannerInfo *root,
+						RelOptInfo *rel,
+						Path *subpath,
+						List *param_exprs,
+						List *hash_operators,
+						bool singlerow,
+						double calls);
 extern UniquePath *create_unique_path(PlannerInfo *root, RelOptInfo *rel,
 				   Path *subpath, SpecialJoinInfo *sjinfo);
 extern GatherPath *create_gather_path(PlannerInfo *root,
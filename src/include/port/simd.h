@@ -0,0 +1,112 @@
+/*-------------------------------------------------------------------------
+ *
+ * simd.h
+ *	  Support for platform-specific vector operations.
+ *
+ * These helpers let code test many bytes at a time for the presence of
+ * particular values.  On x86-64, where SSE2 is always available, a vector
+ * is a 128-bit SSE2 register.  Elsewhere we fall back to treating a uint64
+ * as a vector of 8 bytes ("SIMD within a register"), which is still a good
+ * deal faster than examining one byte at a time.
+ *
+ * The result of vector8_eq() is only meant to be combined with vector8_or()
+ * and tested with vector8_is_highbit_set().  In the fallback
+ * implementation it may also flag bytes following a real match, so callers
+ * can use it to find out whether a vector contains a byte of interest, but
+ * must locate that byte by other means.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/port/simd.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SIMD_H
+#define SIMD_H
+
+#if defined(__x86_64__) || defined(_M_AMD64)
+/*
+ * SSE2 instructions are part of the spec for the 64-bit x86 ISA, so we can
+ * use them without a runtime check.
+ */
+#include <emmintrin.h>
+#define USE_SSE2
+typedef __m128i Vector8;
+
+#else
+#define USE_NO_SIMD
+typedef uint64 Vector8;
+#endif
+
+
+/*
+ * Load a chunk of memory into the given vector.  No alignment is required.
+ */
+static inline void
+vector8_load(Vector8 *v, const uint8 *s)
+{
+#ifdef USE_SSE2
+	*v = _mm_loadu_si128((const __m128i *) s);
+#else
+	memcpy(v, s, sizeof(Vector8));
+#endif
+}
+
+/*
+ * Create a vector with all elements set to the same value.
+ */
+static inline Vector8
+vector8_broadcast(const uint8 c)
+{
+#ifdef USE_SSE2
+	return _mm_set1_epi8((char) c);
+#else
+	return ~UINT64CONST(0) / 0xFF * c;
+#endif
+}
+
+/*
+ * Flag the elements of v1 that are equal to the corresponding elements of
+ * v2, by setting their high bit.  See the notes at the top of the file.
+ */
+static inline Vector8
+vector8_eq(const Vector8 v1, const Vector8 v2)
+{
+#ifdef USE_SSE2
+	return _mm_cmpeq_epi8(v1, v2);
+#else
+	/* a byte of v1 ^ v2 is zero where they match; see "haszero" */
+	Vector8		x = v1 ^ v2;
+
+	return (x - vector8_broadcast(0x01)) & ~x & vector8_broadcast(0x80);
+#endif
+}
+
+/*
+ * Return the bitwise OR of the two vectors.
+ */
+static inline Vector8
+vector8_or(const Vector8 v1, const Vector8 v2)
+{
+#ifdef USE_SSE2
+	return _mm_or_si128(v1, v2);
+#else
+	return v1 | v2;
+#endif
+}
+
+/*
+ * Return true if the high bit of any element is set.
+ */
+static inline bool
+vector8_is_highbit_set(const Vector8 v)
+{
+#ifdef USE_SSE2
+	return _mm_movemask_epi8(v) != 0;
+#else
+	return (v & vector8_broadcast(0x80)) != 0;
+#endif
+}
+
+#endif							/* SIMD_H */
@@ -213,6 +213,8 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_PREDICATE_LOCK_MANAGER,
 	LWTRANCHE_PARALLEL_QUERY_DSA,
 	LWTRANCHE_TBM,
+	LWTRANCHE_RECORD_TYPMOD_DSA,
+	LWTRANCHE_RECORD_TYPMOD_REGISTRY,
 	LWTRANCHE_FIRST_USER_DEFINED
 }			BuiltinTrancheIds;
 
@@ -62,12 +62,24 @@ struct XidCache
 	(PROC_IN_VACUUM | PROC_IN_ANALYZE | PROC_VACUUM_FOR_WRAPAROUND)
 
 /*
- * We allow a small number of "weak" relation locks (AccesShareLock,
+ * We allow a limited number of "weak" relation locks (AccesShareLock,
  * RowShareLock, RowExclusiveLock) to be recorded in the PGPROC structure
  * rather than the main lock table.  This eases contention on the lock
  * manager LWLocks.  See storage/lmgr/README for additional details.
+ *
+ * The fast-path slots are divided into groups of FP_LOCK_SLOTS_PER_GROUP
+ * slots, and a relation can only be stored in the group selected by hashing
+ * its OID, so that a lookup never has to examine more than one group.  The
+ * number of groups is derived from max_locks_per_transaction at startup (see
+ * InitializeFastPathLocks), and the arrays themselves live in shared memory
+ * separately from the PGPROC array.
  */
-#define		FP_LOCK_SLOTS_PER_BACKEND 16
+extern PGDLLIMPORT int FastPathLockGroupsPerBackend;
+
+#define		FP_LOCK_GROUPS_PER_BACKEND_MAX	1024
+#define		FP_LOCK_SLOTS_PER_GROUP		16	/* don't change */
+#define		FastPathLockSlotsPerBackend() \
+	(FP_LOCK_SLOTS_PER_GROUP * FastPathLockGroupsPerBackend)
 
 /*
  * An invalid pgprocno.  Must be larger than the maximum number of PGPROC
@@ -175,8 +187,9 @@ struct PGPROC
 	LWLock		backendLock;
 
 	/* Lock manager data, recording fast-path locks taken by this backend. */
-	uint64		fpLockBits;		/* lock modes held for each fast-path slot */
-	Oid			fpRelId[FP_LOCK_SLOTS_PER_BACKEND]; /* slots for rel oids */
+	uint64	   *fpLockBits;		/* lock modes held for each fast-path slot,
+								 * one word per group of slots */
+	Oid		   *fpRelId;		/* slots for rel oids */
 	bool		fpVXIDLock;		/* are we holding a fast-path VXID lock? */
 	LocalTransactionId fpLocalTransactionId;	/* lxid for fast-path VXID
 												 * lock */
@@ -277,6 +290,7 @@ extern int	DeadlockTimeout;
 extern int	StatementTimeout;
 extern int	LockTimeout;
 extern int	IdleInTransactionSessionTimeout;
+extern int	IdleSessionTimeout;
 extern bool log_lock_waits;
 
 
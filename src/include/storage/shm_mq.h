@@ -70,9 +70,11 @@ extern shm_mq *shm_mq_get_queue(shm_mq_handle *mqh);
 
 /* Send or receive messages. */
 extern shm_mq_result shm_mq_send(shm_mq_handle *mqh,
-			Size nbytes, const void *data, bool nowait);
+			Size nbytes, const void *data, bool nowait,
+			bool force_flush);
 extern shm_mq_result shm_mq_sendv(shm_mq_handle *mqh,
-			 shm_mq_iovec *iov, int iovcnt, bool nowait);
+			 shm_mq_iovec *iov, int iovcnt, bool nowait,
+			 bool force_flush);
 extern shm_mq_result shm_mq_receive(shm_mq_handle *mqh,
 			   Size *nbytesp, void **datap, bool nowait);
 
@@ -20,6 +20,9 @@
 #ifndef INT8_H
 #define INT8_H
 
+/* enough room for the text form of any int64, without the trailing NUL */
+#define MAXINT8LEN		25
+
 extern bool scanint8(const char *str, bool errorOK, int64 *result);
 
 #endif							/* INT8_H */
@@ -155,6 +155,13 @@ typedef struct RelationData
 	 */
 	bytea	   *rd_options;		/* parsed pg_class.reloptions */
 
+	/*
+	 * Table access method, set for tables, materialized views and TOAST
+	 * tables.  It points to a struct owned by the AM, never freed.
+	 */
+	/* use "struct" here to avoid needing to include tableam.h: */
+	const struct TableAmRoutine *rd_tableam;
+
 	/* These are non-NULL only for an index relation: */
 	Form_pg_index rd_index;		/* pg_index tuple describing this index */
 	/* use "struct" here to avoid needing to include htup.h: */
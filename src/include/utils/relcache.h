@@ -66,6 +66,7 @@ extern void RelationSetIndexList(Relation relation,
 					 List *indexIds, Oid oidIndex);
 
 extern void RelationInitIndexAccessInfo(Relation relation);
+extern void RelationInitTableAccessMethod(Relation relation);
 
 /* caller must include pg_publication.h */
 struct PublicationActions;
@@ -110,6 +110,13 @@ typedef struct SnapshotData
 
 	TimestampTz whenTaken;		/* timestamp when snapshot was taken */
 	XLogRecPtr	lsn;			/* position in the WAL stream when taken */
+
+	/*
+	 * The ShmemVariableCache->xactCompletionCount value the snapshot's
+	 * contents were computed at, or 0 if they can't be reused (for example
+	 * because they were copied in from an imported snapshot).
+	 */
+	uint64		snapXactCompletionCount;
 } SnapshotData;
 
 /*
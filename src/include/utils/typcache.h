@@ -18,6 +18,7 @@
 
 #include "access/tupdesc.h"
 #include "fmgr.h"
+#include "storage/dsm_impl.h"
 
 
 /* DomainConstraintCache is an opaque struct known only within typcache.c */
@@ -158,6 +159,10 @@ extern TupleDesc lookup_rowtype_tupdesc_copy(Oid type_id, int32 typmod);
 
 extern void assign_record_type_typmod(TupleDesc tupDesc);
 
+extern dsm_handle GetSharedRecordTypmodRegistry(void);
+
+extern void AttachSharedRecordTypmodRegistry(dsm_handle handle);
+
 extern int	compare_values_of_enum(TypeCacheEntry *tcache, Oid arg1, Oid arg2);
 
 #endif							/* TYPCACHE_H */
@@ -3338,6 +3338,7 @@ makeEmptyPGconn(void)
 
 	conn->status = CONNECTION_BAD;
 	conn->asyncStatus = PGASYNC_IDLE;
+	conn->pipelineStatus = PQ_PIPELINE_OFF;
 	conn->xactStatus = PQTRANS_IDLE;
 	conn->options_valid = false;
 	conn->nonblocking = false;
@@ -3436,6 +3437,7 @@ freePGconn(PGconn *conn)
 		free(conn->client_encoding_initial);
 	if (conn->events)
 		free(conn->events);
+	pqFreeCommandQueue(conn->cmd_queue_recycle);
 	if (conn->pghost)
 		free(conn->pghost);
 	if (conn->pghostaddr)
@@ -3599,6 +3601,11 @@ closePGconn(PGconn *conn)
 	resetPQExpBuffer(&conn->errorMessage);
 	release_all_addrinfo(conn);
 
+	/* forget about any commands still queued in pipeline mode */
+	pqFreeCommandQueue(conn->cmd_queue_head);
+	conn->cmd_queue_head = conn->cmd_queue_tail = NULL;
+	conn->pipelineStatus = PQ_PIPELINE_OFF;
+
 	notify = conn->notifyHead;
 	while (notify != NULL)
 	{
@@ -39,7 +39,9 @@ char	   *const pgresStatus[] = {
 	"PGRES_NONFATAL_ERROR",
 	"PGRES_FATAL_ERROR",
 	"PGRES_COPY_BOTH",
-	"PGRES_SINGLE_TUPLE"
+	"PGRES_SINGLE_TUPLE",
+	"PGRES_PIPELINE_SYNC",
+	"PGRES_PIPELINE_ABORTED"
 };
 
 /*
@@ -53,6 +55,13 @@ static bool static_std_strings = false;
 static PGEvent *dupEvents(PGEvent *events, int count);
 static bool pqAddTuple(PGresult *res, PGresAttValue *tup);
 static bool PQsendQueryStart(PGconn *conn);
+static bool pqRememberCommand(PGconn *conn, PGQueryClass queryclass,
+				  const char *query);
+static PGcmdQueueEntry *pqAllocCmdQueueEntry(PGconn *conn);
+static void pqAppendCmdQueueEntry(PGconn *conn, PGcmdQueueEntry *entry);
+static void pqRecycleCmdQueueEntry(PGconn *conn, PGcmdQueueEntry *entry);
+static void pqPipelineProcessQueue(PGconn *conn);
+static int	pqPipelineFlush(PGconn *conn);
 static int PQsendQueryGuts(PGconn *conn,
 				const char *command,
 				const char *stmtName,
@@ -181,6 +190,7 @@ PQmakeEmptyPGresult(PGconn *conn, ExecStatusType status)
 			case PGRES_COPY_IN:
 			case PGRES_COPY_BOTH:
 			case PGRES_SINGLE_TUPLE:
+			case PGRES_PIPELINE_SYNC:
 				/* non-error cases */
 				break;
 			default:
@@ -1142,6 +1152,18 @@ PQsendQuery(PGconn *conn, const char *query)
 		return 0;
 	}
 
+	/*
+	 * The simple query protocol implies a Sync, and may return any number of
+	 * results, so it can't be mixed with pipelined commands.
+	 */
+	if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("%s not allowed in pipeline mode\n"),
+						  "PQsendQuery");
+		return 0;
+	}
+
 	/* construct the outgoing Query message */
 	if (pqPutMsgStart('Q', false, conn) < 0 ||
 		pqPuts(query, conn) < 0 ||
@@ -1286,33 +1308,33 @@ PQsendPrepare(PGconn *conn,
 	if (pqPutMsgEnd(conn) < 0)
 		goto sendFailed;
 
-	/* construct the Sync message */
-	if (pqPutMsgStart('S', false, conn) < 0 ||
-		pqPutMsgEnd(conn) < 0)
-		goto sendFailed;
-
-	/* remember we are doing just a Parse */
-	conn->queryclass = PGQUERY_PREPARE;
+	/* construct the Sync message, unless the application does that */
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+	{
+		if (pqPutMsgStart('S', false, conn) < 0 ||
+			pqPutMsgEnd(conn) < 0)
+			goto sendFailed;
+	}
 
-	/* and remember the query text too, if possible */
-	/* if insufficient memory, last_query just winds up NULL */
-	if (conn->last_query)
-		free(conn->last_query);
-	conn->last_query = strdup(query);
+	/* remember we are doing just a Parse, and the query text */
+	if (!pqRememberCommand(conn, PGQUERY_PREPARE, query))
+		goto sendFailed;
 
 	/*
 	 * Give the data a push.  In nonblock mode, don't complain if we're unable
 	 * to send it all; PQgetResult() will do any additional flushing needed.
 	 */
-	if (pqFlush(conn) < 0)
+	if (pqPipelineFlush(conn) < 0)
 		goto sendFailed;
 
 	/* OK, it's launched! */
-	conn->asyncStatus = PGASYNC_BUSY;
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+		conn->asyncStatus = PGASYNC_BUSY;
 	return 1;
 
 sendFailed:
-	pqHandleSendFailure(conn);
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+		pqHandleSendFailure(conn);
 	return 0;
 }
 
@@ -1377,24 +1399,265 @@ PQsendQueryStart(PGconn *conn)
 						  libpq_gettext("no connection to the server\n"));
 		return false;
 	}
-	/* Can't send while already busy, either. */
-	if (conn->asyncStatus != PGASYNC_IDLE)
+	/* Can't send while already busy, either, unless enqueuing for later */
+	if (conn->asyncStatus != PGASYNC_IDLE &&
+		conn->pipelineStatus == PQ_PIPELINE_OFF)
 	{
 		printfPQExpBuffer(&conn->errorMessage,
 						  libpq_gettext("another command is already in progress\n"));
 		return false;
 	}
 
-	/* initialize async result-accumulation state */
-	pqClearAsyncResult(conn);
+	if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+	{
+		/*
+		 * In pipeline mode the connection may still be receiving the results
+		 * of earlier commands, so leave the async result state alone; it
+		 * gets reset when this command reaches the head of the queue.  We
+		 * can queue behind anything but a COPY, though.
+		 */
+		if (conn->asyncStatus == PGASYNC_COPY_IN ||
+			conn->asyncStatus == PGASYNC_COPY_OUT ||
+			conn->asyncStatus == PGASYNC_COPY_BOTH)
+		{
+			printfPQExpBuffer(&conn->errorMessage,
+							  libpq_gettext("cannot queue commands during COPY\n"));
+			return false;
+		}
+	}
+	else
+	{
+		/* initialize async result-accumulation state */
+		pqClearAsyncResult(conn);
 
-	/* reset single-row processing mode */
-	conn->singleRowMode = false;
+		/* reset single-row processing mode */
+		conn->singleRowMode = false;
+	}
 
 	/* ready to send command message */
 	return true;
 }
 
+/*
+ * pqRememberCommand
+ *		Record the kind of command just sent, and its text if any
+ *
+ * Outside pipeline mode, the command becomes the current one right away.  In
+ * pipeline mode it is appended to the command queue, and becomes current
+ * once the application has consumed the results of the commands ahead of it.
+ *
+ * The query text is only used for error reporting, so failing to copy it is
+ * not fatal.  Returns false if a queue entry could not be allocated.
+ */
+static bool
+pqRememberCommand(PGconn *conn, PGQueryClass queryclass, const char *query)
+{
+	PGcmdQueueEntry *entry;
+
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+	{
+		conn->queryclass = queryclass;
+		/* if insufficient memory, last_query just winds up NULL */
+		if (conn->last_query)
+			free(conn->last_query);
+		conn->last_query = query ? strdup(query) : NULL;
+		return true;
+	}
+
+	entry = pqAllocCmdQueueEntry(conn);
+	if (entry == NULL)
+		return false;
+	entry->queryclass = queryclass;
+	entry->query = query ? strdup(query) : NULL;
+	pqAppendCmdQueueEntry(conn, entry);
+	return true;
+}
+
+/*
+ * pqAllocCmdQueueEntry
+ *		Get a command queue entry, from the recycle list if possible
+ *
+ * Returns NULL on out-of-memory, with conn->errorMessage set.
+ */
+static PGcmdQueueEntry *
+pqAllocCmdQueueEntry(PGconn *conn)
+{
+	PGcmdQueueEntry *entry;
+
+	if (conn->cmd_queue_recycle == NULL)
+	{
+		entry = (PGcmdQueueEntry *) malloc(sizeof(PGcmdQueueEntry));
+		if (entry == NULL)
+		{
+			printfPQExpBuffer(&conn->errorMessage,
+							  libpq_gettext("out of memory\n"));
+			return NULL;
+		}
+	}
+	else
+	{
+		entry = conn->cmd_queue_recycle;
+		conn->cmd_queue_recycle = entry->next;
+	}
+	entry->next = NULL;
+	entry->query = NULL;
+
+	return entry;
+}
+
+/*
+ * pqAppendCmdQueueEntry
+ *		Add a sent command to the end of the pipeline's command queue
+ *
+ * If nothing was in progress, the new command becomes the current one.
+ */
+static void
+pqAppendCmdQueueEntry(PGconn *conn, PGcmdQueueEntry *entry)
+{
+	Assert(entry->next == NULL);
+
+	if (conn->cmd_queue_head == NULL)
+		conn->cmd_queue_head = entry;
+	else
+		conn->cmd_queue_tail->next = entry;
+	conn->cmd_queue_tail = entry;
+
+	if (conn->asyncStatus == PGASYNC_IDLE)
+		pqPipelineProcessQueue(conn);
+}
+
+/*
+ * pqRecycleCmdQueueEntry
+ *		Push a no-longer-needed command queue entry onto the recycle list
+ */
+static void
+pqRecycleCmdQueueEntry(PGconn *conn, PGcmdQueueEntry *entry)
+{
+	if (entry->query)
+	{
+		free(entry->query);
+		entry->query = NULL;
+	}
+	entry->next = conn->cmd_queue_recycle;
+	conn->cmd_queue_recycle = entry;
+}
+
+/*
+ * pqCommandQueueAdvance
+ *		Remove the current command from the head of the command queue
+ *
+ * Called once all of its results have been handed to the application (or
+ * there's no hope of getting them anymore).
+ */
+void
+pqCommandQueueAdvance(PGconn *conn)
+{
+	PGcmdQueueEntry *prevquery = conn->cmd_queue_head;
+
+	if (prevquery == NULL)
+		return;
+
+	conn->cmd_queue_head = prevquery->next;
+	if (conn->cmd_queue_head == NULL)
+		conn->cmd_queue_tail = NULL;
+
+	prevquery->next = NULL;
+	pqRecycleCmdQueueEntry(conn, prevquery);
+}
+
+/*
+ * pqFreeCommandQueue
+ *		Free all the entries of a command queue or recycle list
+ */
+void
+pqFreeCommandQueue(PGcmdQueueEntry *queue)
+{
+	while (queue != NULL)
+	{
+		PGcmdQueueEntry *cur = queue;
+
+		queue = cur->next;
+		if (cur->query)
+			free(cur->query);
+		free(cur);
+	}
+}
+
+/*
+ * pqPipelineProcessQueue
+ *		Make the command at the head of the queue the current one
+ *
+ * Called when the application has consumed all results of the previous
+ * command (or none was in progress).  If the queue is empty, we go idle.
+ *
+ * Once a command in the pipeline has failed, the server discards everything
+ * up to the next Sync, so there's nothing to wait for: we hand the
+ * application a PGRES_PIPELINE_ABORTED result for each skipped command.
+ */
+static void
+pqPipelineProcessQueue(PGconn *conn)
+{
+	PGcmdQueueEntry *head = conn->cmd_queue_head;
+
+	Assert(conn->asyncStatus == PGASYNC_IDLE ||
+		   conn->asyncStatus == PGASYNC_PIPELINE_IDLE);
+
+	/* single-row mode must be requested for each command, if desired */
+	conn->singleRowMode = false;
+
+	if (head == NULL)
+	{
+		conn->asyncStatus = PGASYNC_IDLE;
+		return;
+	}
+
+	/* initialize async result-accumulation state */
+	pqClearAsyncResult(conn);
+
+	/* the protocol code looks at queryclass and last_query */
+	conn->queryclass = head->queryclass;
+	if (conn->last_query)
+		free(conn->last_query);
+	conn->last_query = head->query;
+	head->query = NULL;
+
+	if (conn->pipelineStatus == PQ_PIPELINE_ABORTED &&
+		head->queryclass != PGQUERY_SYNC)
+	{
+		conn->result = PQmakeEmptyPGresult(conn, PGRES_PIPELINE_ABORTED);
+		if (!conn->result)
+		{
+			printfPQExpBuffer(&conn->errorMessage,
+							  libpq_gettext("out of memory\n"));
+			pqSaveErrorResult(conn);
+		}
+		conn->asyncStatus = PGASYNC_READY;
+	}
+	else
+	{
+		/* allow parsing to continue */
+		conn->asyncStatus = PGASYNC_BUSY;
+	}
+}
+
+/*
+ * pqPipelineFlush
+ *		Flush after sending a command
+ *
+ * In pipeline mode, we don't flush after each command, so that many commands
+ * travel in few packets.  pqPutMsgEnd already sends the buffered data in 8kB
+ * chunks as it accumulates, which keeps the output buffer small; the rest is
+ * forced out by PQpipelineSync or PQflush.  Otherwise this is the same as
+ * pqFlush.
+ */
+static int
+pqPipelineFlush(PGconn *conn)
+{
+	if (conn->pipelineStatus != PQ_PIPELINE_ON)
+		return pqFlush(conn);
+	return 0;
+}
+
 /*
  * PQsendQueryGuts
  *		Common code for protocol-3.0 query sending
@@ -1535,36 +1798,33 @@ PQsendQueryGuts(PGconn *conn,
 		pqPutMsgEnd(conn) < 0)
 		goto sendFailed;
 
-	/* construct the Sync message */
-	if (pqPutMsgStart('S', false, conn) < 0 ||
-		pqPutMsgEnd(conn) < 0)
-		goto sendFailed;
-
-	/* remember we are using extended query protocol */
-	conn->queryclass = PGQUERY_EXTENDED;
+	/* construct the Sync message, unless the application does that */
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+	{
+		if (pqPutMsgStart('S', false, conn) < 0 ||
+			pqPutMsgEnd(conn) < 0)
+			goto sendFailed;
+	}
 
-	/* and remember the query text too, if possible */
-	/* if insufficient memory, last_query just winds up NULL */
-	if (conn->last_query)
-		free(conn->last_query);
-	if (command)
-		conn->last_query = strdup(command);
-	else
-		conn->last_query = NULL;
+	/* remember we are using extended query protocol, and the query text */
+	if (!pqRememberCommand(conn, PGQUERY_EXTENDED, command))
+		goto sendFailed;
 
 	/*
 	 * Give the data a push.  In nonblock mode, don't complain if we're unable
 	 * to send it all; PQgetResult() will do any additional flushing needed.
 	 */
-	if (pqFlush(conn) < 0)
+	if (pqPipelineFlush(conn) < 0)
 		goto sendFailed;
 
 	/* OK, it's launched! */
-	conn->asyncStatus = PGASYNC_BUSY;
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+		conn->asyncStatus = PGASYNC_BUSY;
 	return 1;
 
 sendFailed:
-	pqHandleSendFailure(conn);
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+		pqHandleSendFailure(conn);
 	return 0;
 }
 
@@ -1738,6 +1998,9 @@ PQgetResult(PGconn *conn)
 			 */
 			pqSaveErrorResult(conn);
 			conn->asyncStatus = PGASYNC_IDLE;
+			/* nothing more will arrive for any queued commands */
+			while (conn->cmd_queue_head != NULL)
+				pqCommandQueueAdvance(conn);
 			return pqPrepareAsyncResult(conn);
 		}
 
@@ -1751,10 +2014,54 @@ PQgetResult(PGconn *conn)
 		case PGASYNC_IDLE:
 			res = NULL;			/* query is complete */
 			break;
+		case PGASYNC_PIPELINE_IDLE:
+
+			/*
+			 * Return the NULL that ends the current command's results, and
+			 * move on to the next queued command, if any.
+			 */
+			pqPipelineProcessQueue(conn);
+			res = NULL;
+			break;
 		case PGASYNC_READY:
-			res = pqPrepareAsyncResult(conn);
-			/* Set the state back to BUSY, allowing parsing to proceed. */
-			conn->asyncStatus = PGASYNC_BUSY;
+			if (conn->pipelineStatus != PQ_PIPELINE_OFF &&
+				!(conn->result &&
+				  conn->result->resultStatus == PGRES_SINGLE_TUPLE))
+			{
+				/*
+				 * In pipeline mode, this is the last result of the current
+				 * command.  The following call returns NULL, except after a
+				 * sync, which isn't a query the application waits on.
+				 *
+				 * A Sync's queue entry is only consumed by its
+				 * ReadyForQuery, though.  An error can be raised while
+				 * processing the Sync itself, for instance by a deferred
+				 * constraint checked at commit; ReadyForQuery still follows,
+				 * so keep the entry and keep parsing.  That's also what
+				 * takes the pipeline out of the aborted state.
+				 */
+				res = pqPrepareAsyncResult(conn);
+				if (res && res->resultStatus == PGRES_PIPELINE_SYNC)
+				{
+					pqCommandQueueAdvance(conn);
+					conn->asyncStatus = PGASYNC_PIPELINE_IDLE;
+					pqPipelineProcessQueue(conn);
+				}
+				else if (conn->cmd_queue_head != NULL &&
+						 conn->cmd_queue_head->queryclass == PGQUERY_SYNC)
+					conn->asyncStatus = PGASYNC_BUSY;
+				else
+				{
+					pqCommandQueueAdvance(conn);
+					conn->asyncStatus = PGASYNC_PIPELINE_IDLE;
+				}
+			}
+			else
+			{
+				res = pqPrepareAsyncResult(conn);
+				/* Set the state back to BUSY, allowing parsing to proceed. */
+				conn->asyncStatus = PGASYNC_BUSY;
+			}
 			break;
 		case PGASYNC_COPY_IN:
 			res = getCopyResult(conn, PGRES_COPY_IN);
@@ -1831,6 +2138,230 @@ getCopyResult(PGconn *conn, ExecStatusType copytype)
 }
 
 
+/*
+ * PQpipelineStatus
+ *		Return the pipeline mode status of the connection
+ */
+PGpipelineStatus
+PQpipelineStatus(const PGconn *conn)
+{
+	if (!conn)
+		return PQ_PIPELINE_OFF;
+
+	return conn->pipelineStatus;
+}
+
+/*
+ * PQenterPipelineMode
+ *		Put an idle connection in pipeline mode.
+ *
+ * In pipeline mode, commands sent with PQsendQueryParams and siblings are
+ * queued without waiting for the results of the ones before, and without an
+ * implicit Sync; the application marks synchronization points with
+ * PQpipelineSync.  Results are then read back in order with PQgetResult, so
+ * a whole series of statements needs only one network round trip.
+ *
+ * Returns 1 on success, 0 on failure.  Entering pipeline mode when already
+ * in it is a no-op.
+ */
+int
+PQenterPipelineMode(PGconn *conn)
+{
+	if (!conn)
+		return 0;
+
+	/* succeed with no action if already in pipeline mode */
+	if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+		return 1;
+
+	if (conn->asyncStatus != PGASYNC_IDLE)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("cannot enter pipeline mode, connection not idle\n"));
+		return 0;
+	}
+
+	/* The extended query protocol is needed to send commands without Sync */
+	if (PG_PROTOCOL_MAJOR(conn->pversion) < 3)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("function requires at least protocol version 3.0\n"));
+		return 0;
+	}
+
+	conn->pipelineStatus = PQ_PIPELINE_ON;
+
+	return 1;
+}
+
+/*
+ * PQexitPipelineMode
+ *		End pipeline mode and return to normal command mode.
+ *
+ * Only possible once all the results of the pipeline have been collected.
+ * Returns 1 on success, 0 on failure.
+ */
+int
+PQexitPipelineMode(PGconn *conn)
+{
+	if (!conn)
+		return 0;
+
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+		return 1;
+
+	switch (conn->asyncStatus)
+	{
+		case PGASYNC_READY:
+			/* there are some uncollected results */
+			printfPQExpBuffer(&conn->errorMessage,
+							  libpq_gettext("cannot exit pipeline mode with uncollected results\n"));
+			return 0;
+
+		case PGASYNC_BUSY:
+			printfPQExpBuffer(&conn->errorMessage,
+							  libpq_gettext("cannot exit pipeline mode while busy\n"));
+			return 0;
+
+		case PGASYNC_COPY_IN:
+		case PGASYNC_COPY_OUT:
+		case PGASYNC_COPY_BOTH:
+			printfPQExpBuffer(&conn->errorMessage,
+							  libpq_gettext("cannot exit pipeline mode while in COPY\n"));
+			return 0;
+
+		case PGASYNC_IDLE:
+		case PGASYNC_PIPELINE_IDLE:
+			/* OK */
+			break;
+	}
+
+	/* still work to process */
+	if (conn->cmd_queue_head != NULL)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("cannot exit pipeline mode with uncollected results\n"));
+		return 0;
+	}
+
+	conn->pipelineStatus = PQ_PIPELINE_OFF;
+	conn->asyncStatus = PGASYNC_IDLE;
+
+	/* Flush any pending data in out buffer */
+	if (pqFlush(conn) < 0)
+		return 0;				/* error message is setup already */
+	return 1;
+}
+
+/*
+ * PQpipelineSync
+ *		Send a Sync message as part of a pipeline, and flush to server
+ *
+ * The server commits (or, after an error, rolls back) any implicit
+ * transaction at this point, and a failure in one part of the pipeline no
+ * longer affects what comes after it.  PQgetResult returns a result with
+ * status PGRES_PIPELINE_SYNC when it gets there.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int
+PQpipelineSync(PGconn *conn)
+{
+	PGcmdQueueEntry *entry;
+
+	if (!conn)
+		return 0;
+
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("cannot send pipeline when not in pipeline mode\n"));
+		return 0;
+	}
+
+	if (conn->asyncStatus == PGASYNC_COPY_IN ||
+		conn->asyncStatus == PGASYNC_COPY_OUT ||
+		conn->asyncStatus == PGASYNC_COPY_BOTH)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("cannot send pipeline while in COPY\n"));
+		return 0;
+	}
+
+	entry = pqAllocCmdQueueEntry(conn);
+	if (entry == NULL)
+		return 0;				/* error msg already set */
+
+	/* construct the Sync message */
+	if (pqPutMsgStart('S', false, conn) < 0 ||
+		pqPutMsgEnd(conn) < 0)
+	{
+		pqRecycleCmdQueueEntry(conn, entry);
+		return 0;
+	}
+
+	entry->queryclass = PGQUERY_SYNC;
+	pqAppendCmdQueueEntry(conn, entry);
+
+	/*
+	 * Give the data a push.  In nonblock mode, don't complain if we're unable
+	 * to send it all; PQgetResult() will do any additional flushing needed.
+	 */
+	if (pqFlush(conn) < 0)
+		return 0;
+
+	return 1;
+}
+
+/*
+ * PQsendFlushRequest
+ *		Ask the server to flush its output buffer
+ *
+ * Without this, or a Sync, the server may hold on to the results of pipelined
+ * commands until its output buffer fills up.  The request itself is only
+ * queued; it goes out with the next flush of our own output buffer.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int
+PQsendFlushRequest(PGconn *conn)
+{
+	if (!conn)
+		return 0;
+
+	/* Don't try to send if we know there's no live connection. */
+	if (conn->status != CONNECTION_OK)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("no connection to the server\n"));
+		return 0;
+	}
+
+	/* Can't send while already busy, either, unless enqueuing for later */
+	if (conn->asyncStatus != PGASYNC_IDLE &&
+		conn->pipelineStatus == PQ_PIPELINE_OFF)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("another command is already in progress\n"));
+		return 0;
+	}
+
+	/* This isn't gonna work on a 2.0 server */
+	if (PG_PROTOCOL_MAJOR(conn->pversion) < 3)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("function requires at least protocol version 3.0\n"));
+		return 0;
+	}
+
+	if (pqPutMsgStart('H', false, conn) < 0 ||
+		pqPutMsgEnd(conn) < 0)
+		return 0;
+
+	return 1;
+}
+
+
 /*
  * PQexec
  *	  send a query to the backend and package up the result in a PGresult
@@ -1932,6 +2463,13 @@ PQexecStart(PGconn *conn)
 	if (!conn)
 		return false;
 
+	if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("synchronous command execution functions are not allowed in pipeline mode\n"));
+		return false;
+	}
+
 	/*
 	 * Silently discard any prior query result that application didn't eat.
 	 * This is probably poor design, but it's here for backward compatibility.
@@ -2148,34 +2686,33 @@ PQsendDescribe(PGconn *conn, char desc_type, const char *desc_target)
 		pqPutMsgEnd(conn) < 0)
 		goto sendFailed;
 
-	/* construct the Sync message */
-	if (pqPutMsgStart('S', false, conn) < 0 ||
-		pqPutMsgEnd(conn) < 0)
-		goto sendFailed;
-
-	/* remember we are doing a Describe */
-	conn->queryclass = PGQUERY_DESCRIBE;
-
-	/* reset last-query string (not relevant now) */
-	if (conn->last_query)
+	/* construct the Sync message, unless the application does that */
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
 	{
-		free(conn->last_query);
-		conn->last_query = NULL;
+		if (pqPutMsgStart('S', false, conn) < 0 ||
+			pqPutMsgEnd(conn) < 0)
+			goto sendFailed;
 	}
 
+	/* remember we are doing a Describe (last-query string not relevant) */
+	if (!pqRememberCommand(conn, PGQUERY_DESCRIBE, NULL))
+		goto sendFailed;
+
 	/*
 	 * Give the data a push.  In nonblock mode, don't complain if we're unable
 	 * to send it all; PQgetResult() will do any additional flushing needed.
 	 */
-	if (pqFlush(conn) < 0)
+	if (pqPipelineFlush(conn) < 0)
 		goto sendFailed;
 
 	/* OK, it's launched! */
-	conn->asyncStatus = PGASYNC_BUSY;
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+		conn->asyncStatus = PGASYNC_BUSY;
 	return 1;
 
 sendFailed:
-	pqHandleSendFailure(conn);
+	if (conn->pipelineStatus == PQ_PIPELINE_OFF)
+		pqHandleSendFailure(conn);
 	return 0;
 }
 
@@ -2321,9 +2858,10 @@ PQputCopyEnd(PGconn *conn, const char *errormsg)
 
 		/*
 		 * If we sent the COPY command in extended-query mode, we must issue a
-		 * Sync as well.
+		 * Sync as well.  In pipeline mode, that's up to the application.
 		 */
-		if (conn->queryclass != PGQUERY_SIMPLE)
+		if (conn->queryclass != PGQUERY_SIMPLE &&
+			conn->pipelineStatus == PQ_PIPELINE_OFF)
 		{
 			if (pqPutMsgStart('S', false, conn) < 0 ||
 				pqPutMsgEnd(conn) < 0)
@@ -2569,6 +3107,14 @@ PQfn(PGconn *conn,
 	/* clear the error string */
 	resetPQExpBuffer(&conn->errorMessage);
 
+	if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("%s not allowed in pipeline mode\n"),
+						  "PQfn");
+		return NULL;
+	}
+
 	if (conn->sock == PGINVALID_SOCKET || conn->asyncStatus != PGASYNC_IDLE ||
 		conn->result != NULL)
 	{
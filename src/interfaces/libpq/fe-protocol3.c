@@ -219,11 +219,37 @@ pqParseInput3(PGconn *conn)
 					if (pqGetErrorNotice3(conn, true))
 						return;
 					conn->asyncStatus = PGASYNC_READY;
+
+					/*
+					 * The server skips the rest of a pipeline up to the next
+					 * Sync after an error.
+					 */
+					if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+						conn->pipelineStatus = PQ_PIPELINE_ABORTED;
 					break;
 				case 'Z':		/* backend is ready for new query */
 					if (getReadyForQuery(conn))
 						return;
-					conn->asyncStatus = PGASYNC_IDLE;
+					if (conn->pipelineStatus != PQ_PIPELINE_OFF)
+					{
+						/*
+						 * In pipeline mode, this is the response to a Sync,
+						 * which gets a result of its own.  It also ends any
+						 * aborted state.
+						 */
+						conn->result = PQmakeEmptyPGresult(conn,
+														   PGRES_PIPELINE_SYNC);
+						if (!conn->result)
+						{
+							printfPQExpBuffer(&conn->errorMessage,
+											  libpq_gettext("out of memory"));
+							pqSaveErrorResult(conn);
+						}
+						conn->pipelineStatus = PQ_PIPELINE_ON;
+						conn->asyncStatus = PGASYNC_READY;
+					}
+					else
+						conn->asyncStatus = PGASYNC_IDLE;
 					break;
 				case 'I':		/* empty query */
 					if (conn->result == NULL)
@@ -1828,9 +1854,10 @@ pqEndcopy3(PGconn *conn)
 
 		/*
 		 * If we sent the COPY command in extended-query mode, we must issue a
-		 * Sync as well.
+		 * Sync as well.  In pipeline mode, that's up to the application.
 		 */
-		if (conn->queryclass != PGQUERY_SIMPLE)
+		if (conn->queryclass != PGQUERY_SIMPLE &&
+			conn->pipelineStatus == PQ_PIPELINE_OFF)
 		{
 			if (pqPutMsgStart('S', false, conn) < 0 ||
 				pqPutMsgEnd(conn) < 0)
@@ -216,6 +216,9 @@ typedef enum
 	PGASYNC_IDLE,				/* nothing's happening, dude */
 	PGASYNC_BUSY,				/* query in progress */
 	PGASYNC_READY,				/* result ready for PQgetResult */
+	PGASYNC_PIPELINE_IDLE,		/* pipeline mode: result of the current
+								 * command was returned, next PQgetResult
+								 * returns NULL and moves to the next one */
 	PGASYNC_COPY_IN,			/* Copy In data transfer in progress */
 	PGASYNC_COPY_OUT,			/* Copy Out data transfer in progress */
 	PGASYNC_COPY_BOTH			/* Copy In/Out data transfer in progress */
@@ -227,9 +230,23 @@ typedef enum
 	PGQUERY_SIMPLE,				/* simple Query protocol (PQexec) */
 	PGQUERY_EXTENDED,			/* full Extended protocol (PQexecParams) */
 	PGQUERY_PREPARE,			/* Parse only (PQprepare) */
-	PGQUERY_DESCRIBE			/* Describe Statement or Portal */
+	PGQUERY_DESCRIBE,			/* Describe Statement or Portal */
+	PGQUERY_SYNC				/* Sync (at end of a pipeline) */
 } PGQueryClass;
 
+/*
+ * An entry in the pending command queue used in pipeline mode.  Commands
+ * are appended as they are sent, and removed as their results are handed to
+ * the application.  The head of the queue is the command whose results are
+ * currently being received.
+ */
+typedef struct PGcmdQueueEntry
+{
+	PGQueryClass queryclass;	/* Query type */
+	char	   *query;			/* SQL command, or NULL if none/unknown/OOM */
+	struct PGcmdQueueEntry *next;	/* list link */
+} PGcmdQueueEntry;
+
 /* PGSetenvStatusType defines the state of the PQSetenv state machine */
 /* (this is used only for 2.0-protocol connections) */
 typedef enum
@@ -381,6 +398,7 @@ struct pg_conn
 	PGTransactionStatusType xactStatus; /* never changes to ACTIVE */
 	PGQueryClass queryclass;
 	char	   *last_query;		/* last SQL command, or NULL if unknown */
+	PGpipelineStatus pipelineStatus;	/* status of pipeline mode */
 	char		last_sqlstate[6];	/* last reported SQLSTATE */
 	bool		options_valid;	/* true if OK to attempt connection */
 	bool		nonblocking;	/* whether this connection is using nonblock
@@ -391,6 +409,15 @@ struct pg_conn
 	PGnotify   *notifyHead;		/* oldest unreported Notify msg */
 	PGnotify   *notifyTail;		/* newest unreported Notify msg */
 
+	/*
+	 * Commands sent in pipeline mode whose results have not been returned
+	 * yet.  Entries are recycled through cmd_queue_recycle to save malloc
+	 * calls.
+	 */
+	PGcmdQueueEntry *cmd_queue_head;
+	PGcmdQueueEntry *cmd_queue_tail;
+	PGcmdQueueEntry *cmd_queue_recycle;
+
 	/* Support for multiple hosts in connection string */
 	int			nconnhost;		/* # of possible hosts */
 	int			whichhost;		/* host we're currently considering */
@@ -578,6 +605,8 @@ extern void pqSaveParameterStatus(PGconn *conn, const char *name,
 					  const char *value);
 extern int	pqRowProcessor(PGconn *conn, const char **errmsgp);
 extern void pqHandleSendFailure(PGconn *conn);
+extern void pqCommandQueueAdvance(PGconn *conn);
+extern void pqFreeCommandQueue(PGcmdQueueEntry *queue);
 
 /* === in fe-protocol2.c === */
 
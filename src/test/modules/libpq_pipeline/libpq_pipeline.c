@@ -0,0 +1,458 @@
+/*-------------------------------------------------------------------------
+ *
+ * libpq_pipeline.c
+ *		Verify libpq pipeline execution functionality
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *		src/test/modules/libpq_pipeline/libpq_pipeline.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres_fe.h"
+
+#include "libpq-fe.h"
+
+
+static const char *const progname = "libpq_pipeline";
+
+/* Number of rows inserted by test_pipelined_insert */
+#define NINSERTS	1000
+
+static void pg_fatal(const char *fmt,...) pg_attribute_printf(1, 2)
+			pg_attribute_noreturn();
+
+
+/*
+ * Report a test failure and exit.
+ */
+static void
+pg_fatal(const char *fmt,...)
+{
+	va_list		args;
+
+	fflush(stdout);
+
+	fprintf(stderr, "%s: ", progname);
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	fprintf(stderr, "\n");
+
+	exit(1);
+}
+
+/*
+ * Run a command outside pipeline mode, and check that it succeeded.
+ */
+static void
+exec_command(PGconn *conn, const char *command)
+{
+	PGresult   *res;
+
+	res = PQexec(conn, command);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		pg_fatal("\"%s\" failed: %s", command, PQerrorMessage(conn));
+	PQclear(res);
+}
+
+/*
+ * Fetch the next result, and check that it has the expected status.
+ * For an error, also check the SQLSTATE if one is given.
+ */
+static PGresult *
+expect_result(PGconn *conn, ExecStatusType status, const char *sqlstate,
+			  const char *what)
+{
+	PGresult   *res;
+
+	res = PQgetResult(conn);
+	if (res == NULL)
+		pg_fatal("%s: expected %s, got NULL: %s",
+				 what, PQresStatus(status), PQerrorMessage(conn));
+	if (PQresultStatus(res) != status)
+		pg_fatal("%s: expected %s, got %s: %s",
+				 what, PQresStatus(status),
+				 PQresStatus(PQresultStatus(res)), PQerrorMessage(conn));
+	if (sqlstate != NULL)
+	{
+		const char *got = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+
+		if (got == NULL || strcmp(got, sqlstate) != 0)
+			pg_fatal("%s: expected SQLSTATE %s, got %s",
+					 what, sqlstate, got ? got : "none");
+	}
+
+	return res;
+}
+
+/*
+ * Check that the next result is the NULL that ends a command's results.
+ */
+static void
+expect_null(PGconn *conn, const char *what)
+{
+	PGresult   *res;
+
+	res = PQgetResult(conn);
+	if (res != NULL)
+		pg_fatal("%s: expected NULL, got %s",
+				 what, PQresStatus(PQresultStatus(res)));
+}
+
+/*
+ * Check the pipeline status of the connection.
+ */
+static void
+expect_pipeline_status(PGconn *conn, PGpipelineStatus status,
+					   const char *what)
+{
+	if (PQpipelineStatus(conn) != status)
+		pg_fatal("%s: expected pipeline status %d, got %d",
+				 what, (int) status, (int) PQpipelineStatus(conn));
+}
+
+/*
+ * Check that a single-row, single-column result holds the expected value.
+ */
+static void
+expect_value(PGresult *res, const char *value, const char *what)
+{
+	if (PQntuples(res) != 1 || PQnfields(res) != 1)
+		pg_fatal("%s: expected one row with one column, got %d rows with %d columns",
+				 what, PQntuples(res), PQnfields(res));
+	if (strcmp(PQgetvalue(res, 0, 0), value) != 0)
+		pg_fatal("%s: expected \"%s\", got \"%s\"",
+				 what, value, PQgetvalue(res, 0, 0));
+}
+
+static void
+enter_pipeline(PGconn *conn)
+{
+	if (PQenterPipelineMode(conn) != 1)
+		pg_fatal("failed to enter pipeline mode: %s", PQerrorMessage(conn));
+	expect_pipeline_status(conn, PQ_PIPELINE_ON, "after entering pipeline");
+}
+
+static void
+exit_pipeline(PGconn *conn)
+{
+	if (PQexitPipelineMode(conn) != 1)
+		pg_fatal("failed to exit pipeline mode: %s", PQerrorMessage(conn));
+	expect_pipeline_status(conn, PQ_PIPELINE_OFF, "after exiting pipeline");
+}
+
+static void
+send_query(PGconn *conn, const char *command, const char *param)
+{
+	const char *values[1];
+
+	values[0] = param;
+	if (PQsendQueryParams(conn, command, param ? 1 : 0, NULL,
+						  param ? values : NULL, NULL, NULL, 0) != 1)
+		pg_fatal("failed to send \"%s\": %s", command, PQerrorMessage(conn));
+}
+
+static void
+send_sync(PGconn *conn)
+{
+	if (PQpipelineSync(conn) != 1)
+		pg_fatal("pipeline sync failed: %s", PQerrorMessage(conn));
+}
+
+
+/*
+ * One command and a sync.
+ */
+static void
+test_simple_pipeline(PGconn *conn)
+{
+	PGresult   *res;
+
+	enter_pipeline(conn);
+	send_query(conn, "SELECT $1", "1");
+
+	if (PQexitPipelineMode(conn) != 0)
+		pg_fatal("exiting pipeline mode with a command in progress didn't fail");
+
+	send_sync(conn);
+
+	res = expect_result(conn, PGRES_TUPLES_OK, NULL, "query result");
+	expect_value(res, "1", "query result");
+	PQclear(res);
+	expect_null(conn, "end of query results");
+
+	res = expect_result(conn, PGRES_PIPELINE_SYNC, NULL, "sync");
+	PQclear(res);
+
+	exit_pipeline(conn);
+}
+
+/*
+ * Two syncs in one pipeline, read back after everything has been sent.
+ */
+static void
+test_multi_pipelines(PGconn *conn)
+{
+	PGresult   *res;
+
+	enter_pipeline(conn);
+	send_query(conn, "SELECT $1", "1");
+	send_sync(conn);
+	send_query(conn, "SELECT $1", "2");
+	send_sync(conn);
+
+	res = expect_result(conn, PGRES_TUPLES_OK, NULL, "first query");
+	expect_value(res, "1", "first query");
+	PQclear(res);
+	expect_null(conn, "end of first query");
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC, NULL, "first sync"));
+
+	res = expect_result(conn, PGRES_TUPLES_OK, NULL, "second query");
+	expect_value(res, "2", "second query");
+	PQclear(res);
+	expect_null(conn, "end of second query");
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC, NULL, "second sync"));
+
+	exit_pipeline(conn);
+}
+
+/*
+ * An error inside the pipeline: the commands after it are skipped up to the
+ * sync, whose implicit transaction is rolled back, and the pipeline works
+ * normally again after that.
+ */
+static void
+test_pipeline_abort(PGconn *conn)
+{
+	PGresult   *res;
+
+	exec_command(conn, "CREATE TABLE pq_pipeline_demo (itemno integer)");
+
+	enter_pipeline(conn);
+	send_query(conn, "INSERT INTO pq_pipeline_demo VALUES ($1)", "1");
+	send_query(conn, "SELECT no_such_function($1)", "1");
+	send_query(conn, "INSERT INTO pq_pipeline_demo VALUES ($1)", "2");
+	send_sync(conn);
+	send_query(conn, "INSERT INTO pq_pipeline_demo VALUES ($1)", "3");
+	send_sync(conn);
+
+	PQclear(expect_result(conn, PGRES_COMMAND_OK, NULL, "first insert"));
+	expect_null(conn, "end of first insert");
+
+	PQclear(expect_result(conn, PGRES_FATAL_ERROR, "42883", "failing query"));
+	expect_pipeline_status(conn, PQ_PIPELINE_ABORTED, "after error");
+	expect_null(conn, "end of failing query");
+
+	PQclear(expect_result(conn, PGRES_PIPELINE_ABORTED, NULL,
+						  "skipped insert"));
+	expect_null(conn, "end of skipped insert");
+
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC, NULL, "first sync"));
+	expect_pipeline_status(conn, PQ_PIPELINE_ON, "after first sync");
+
+	PQclear(expect_result(conn, PGRES_COMMAND_OK, NULL, "insert after sync"));
+	expect_null(conn, "end of insert after sync");
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC, NULL, "second sync"));
+
+	exit_pipeline(conn);
+
+	/* Only the insert after the first sync was committed */
+	res = PQexec(conn, "SELECT string_agg(itemno::text, ',' ORDER BY itemno) FROM pq_pipeline_demo");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		pg_fatal("checking table contents failed: %s", PQerrorMessage(conn));
+	expect_value(res, "3", "table contents");
+	PQclear(res);
+
+	exec_command(conn, "DROP TABLE pq_pipeline_demo");
+}
+
+/*
+ * An error raised by the sync itself, here a deferred unique constraint
+ * checked when the implicit transaction commits.  The error is followed by
+ * the sync's result, which must end the aborted state.
+ */
+static void
+test_sync_error(PGconn *conn)
+{
+	PGresult   *res;
+
+	exec_command(conn, "CREATE TABLE pq_pipeline_defer (id integer UNIQUE DEFERRABLE INITIALLY DEFERRED)");
+
+	enter_pipeline(conn);
+	send_query(conn, "INSERT INTO pq_pipeline_defer VALUES ($1)", "1");
+	send_query(conn, "INSERT INTO pq_pipeline_defer VALUES ($1)", "1");
+	send_sync(conn);
+	send_query(conn, "SELECT $1", "1");
+	send_sync(conn);
+
+	PQclear(expect_result(conn, PGRES_COMMAND_OK, NULL, "first insert"));
+	expect_null(conn, "end of first insert");
+	PQclear(expect_result(conn, PGRES_COMMAND_OK, NULL, "second insert"));
+	expect_null(conn, "end of second insert");
+
+	PQclear(expect_result(conn, PGRES_FATAL_ERROR, "23505", "commit at sync"));
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC, NULL, "first sync"));
+	expect_pipeline_status(conn, PQ_PIPELINE_ON, "after failed sync");
+
+	res = expect_result(conn, PGRES_TUPLES_OK, NULL, "query after sync");
+	expect_value(res, "1", "query after sync");
+	PQclear(res);
+	expect_null(conn, "end of query after sync");
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC, NULL, "second sync"));
+
+	exit_pipeline(conn);
+
+	res = PQexec(conn, "SELECT count(*) FROM pq_pipeline_defer");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		pg_fatal("checking table contents failed: %s", PQerrorMessage(conn));
+	expect_value(res, "0", "table contents");
+	PQclear(res);
+
+	exec_command(conn, "DROP TABLE pq_pipeline_defer");
+}
+
+/*
+ * Enough commands that the output buffer is sent in several pieces before
+ * the sync.
+ */
+static void
+test_pipelined_insert(PGconn *conn)
+{
+	PGresult   *res;
+	char		buf[32];
+	int			i;
+
+	exec_command(conn, "CREATE TABLE pq_pipeline_insert (id integer, t text)");
+
+	enter_pipeline(conn);
+	for (i = 1; i <= NINSERTS; i++)
+	{
+		snprintf(buf, sizeof(buf), "%d", i);
+		send_query(conn,
+				   "INSERT INTO pq_pipeline_insert VALUES ($1, repeat('x', 10))",
+				   buf);
+	}
+	send_sync(conn);
+
+	for (i = 1; i <= NINSERTS; i++)
+	{
+		PQclear(expect_result(conn, PGRES_COMMAND_OK, NULL, "insert"));
+		expect_null(conn, "end of insert");
+	}
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC, NULL, "sync"));
+
+	exit_pipeline(conn);
+
+	res = PQexec(conn, "SELECT count(DISTINCT id) FROM pq_pipeline_insert");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		pg_fatal("checking table contents failed: %s", PQerrorMessage(conn));
+	snprintf(buf, sizeof(buf), "%d", NINSERTS);
+	expect_value(res, buf, "table contents");
+	PQclear(res);
+
+	exec_command(conn, "DROP TABLE pq_pipeline_insert");
+}
+
+/*
+ * Functions that can't be used in pipeline mode must fail cleanly, without
+ * disturbing the pipeline.
+ */
+static void
+test_disallowed_in_pipeline(PGconn *conn)
+{
+	PGresult   *res;
+
+	enter_pipeline(conn);
+
+	res = PQexec(conn, "SELECT 1");
+	if (PQresultStatus(res) != PGRES_FATAL_ERROR)
+		pg_fatal("PQexec should fail in pipeline mode");
+	PQclear(res);
+
+	if (PQsendQuery(conn, "SELECT 1") != 0)
+		pg_fatal("PQsendQuery should fail in pipeline mode");
+
+	send_query(conn, "SELECT $1", "1");
+	send_sync(conn);
+	res = expect_result(conn, PGRES_TUPLES_OK, NULL, "query");
+	expect_value(res, "1", "query");
+	PQclear(res);
+	expect_null(conn, "end of query");
+	PQclear(expect_result(conn, PGRES_PIPELINE_SYNC, NULL, "sync"));
+
+	exit_pipeline(conn);
+}
+
+
+static const struct
+{
+	const char *name;
+	void		(*func) (PGconn *conn);
+}			tests[] =
+{
+	{"disallowed_in_pipeline", test_disallowed_in_pipeline},
+	{"multi_pipelines", test_multi_pipelines},
+	{"pipeline_abort", test_pipeline_abort},
+	{"pipelined_insert", test_pipelined_insert},
+	{"simple_pipeline", test_simple_pipeline},
+	{"sync_error", test_sync_error},
+	{NULL, NULL}
+};
+
+static void
+usage(void)
+{
+	fprintf(stderr, "Usage: %s TESTNAME [CONNINFO]\n", progname);
+	fprintf(stderr, "       %s tests\n", progname);
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *conninfo = "";
+	PGconn	   *conn;
+	int			i;
+
+	if (argc < 2 || argc > 3)
+	{
+		usage();
+		exit(1);
+	}
+
+	if (strcmp(argv[1], "tests") == 0)
+	{
+		for (i = 0; tests[i].name != NULL; i++)
+			printf("%s\n", tests[i].name);
+		exit(0);
+	}
+
+	for (i = 0; tests[i].name != NULL; i++)
+	{
+		if (strcmp(argv[1], tests[i].name) == 0)
+			break;
+	}
+	if (tests[i].name == NULL)
+	{
+		fprintf(stderr, "%s: \"%s\" is not a recognized test name\n",
+				progname, argv[1]);
+		usage();
+		exit(1);
+	}
+
+	if (argc > 2)
+		conninfo = argv[2];
+
+	conn = PQconnectdb(conninfo);
+	if (PQstatus(conn) != CONNECTION_OK)
+		pg_fatal("connection to database failed: %s", PQerrorMessage(conn));
+
+	tests[i].func(conn);
+
+	PQfinish(conn);
+	return 0;
+}
@@ -0,0 +1,30 @@
+# Run the pipeline mode tests of libpq_pipeline against a temporary server
+
+use strict;
+use warnings;
+
+use IPC::Run;
+use PostgresNode;
+use TestLib;
+use Test::More;
+
+my $node = get_new_node('main');
+$node->init;
+$node->start;
+
+my $program = "$ENV{TESTDIR}/libpq_pipeline";
+
+my ($out, $err);
+my $result = IPC::Run::run [ $program, 'tests' ], '>', \$out, '2>', \$err;
+die "could not list tests: $err" unless $result;
+my @tests = split(/\s+/, $out);
+
+plan tests => scalar @tests;
+
+foreach my $testname (@tests)
+{
+	command_ok([ $program, $testname, $node->connstr('postgres') ],
+		"libpq_pipeline $testname");
+}
+
+$node->stop('fast');
@@ -31,7 +31,7 @@ typedef struct
 } worker_state;
 
 static void setup_dynamic_shared_memory(int64 queue_size, int nworkers,
-							dsm_segment **segp,
+							bool force_flush, dsm_segment **segp,
 							test_shm_mq_header **hdrp,
 							shm_mq **outp, shm_mq **inp);
 static worker_state *setup_background_workers(int nworkers,
@@ -46,8 +46,9 @@ static bool check_worker_status(worker_state *wstate);
  * for a test run.
  */
 void
-test_shm_mq_setup(int64 queue_size, int32 nworkers, dsm_segment **segp,
-				  shm_mq_handle **output, shm_mq_handle **input)
+test_shm_mq_setup(int64 queue_size, int32 nworkers, bool force_flush,
+				  dsm_segment **segp, shm_mq_handle **output,
+				  shm_mq_handle **input)
 {
 	dsm_segment *seg;
 	test_shm_mq_header *hdr;
@@ -56,7 +57,8 @@ test_shm_mq_setup(int64 queue_size, int32 nworkers, dsm_segment **segp,
 	worker_state *wstate;
 
 	/* Set up a dynamic shared memory segment. */
-	setup_dynamic_shared_memory(queue_size, nworkers, &seg, &hdr, &outq, &inq);
+	setup_dynamic_shared_memory(queue_size, nworkers, force_flush, &seg, &hdr,
+								&outq, &inq);
 	*segp = seg;
 
 	/* Register background workers. */
@@ -88,7 +90,8 @@ test_shm_mq_setup(int64 queue_size, int32 nworkers, dsm_segment **segp,
  */
 static void
 setup_dynamic_shared_memory(int64 queue_size, int nworkers,
-							dsm_segment **segp, test_shm_mq_header **hdrp,
+							bool force_flush, dsm_segment **segp,
+							test_shm_mq_header **hdrp,
 							shm_mq **outp, shm_mq **inp)
 {
 	shm_toc_estimator e;
@@ -136,6 +139,7 @@ setup_dynamic_shared_memory(int64 queue_size, int nworkers,
 	hdr->workers_total = nworkers;
 	hdr->workers_attached = 0;
 	hdr->workers_ready = 0;
+	hdr->force_flush = force_flush;
 	shm_toc_insert(toc, 0, hdr);
 
 	/* Set up one message queue per worker, plus one. */
@@ -70,10 +70,11 @@ test_shm_mq(PG_FUNCTION_ARGS)
 				 errmsg("number of workers must be a positive integer")));
 
 	/* Set up dynamic shared memory segment and background workers. */
-	test_shm_mq_setup(queue_size, nworkers, &seg, &outqh, &inqh);
+	test_shm_mq_setup(queue_size, nworkers, true, &seg, &outqh, &inqh);
 
 	/* Send the initial message. */
-	res = shm_mq_send(outqh, message_size, message_contents, false);
+	res = shm_mq_send(outqh, message_size, message_contents, false,
+					  true);
 	if (res != SHM_MQ_SUCCESS)
 		ereport(ERROR,
 				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
@@ -97,7 +98,7 @@ test_shm_mq(PG_FUNCTION_ARGS)
 			break;
 
 		/* Send it back out. */
-		res = shm_mq_send(outqh, len, data, false);
+		res = shm_mq_send(outqh, len, data, false, true);
 		if (res != SHM_MQ_SUCCESS)
 			ereport(ERROR,
 					(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
@@ -136,6 +137,8 @@ test_shm_mq_pipelined(PG_FUNCTION_ARGS)
 	int32		loop_count = PG_GETARG_INT32(2);
 	int32		nworkers = PG_GETARG_INT32(3);
 	bool		verify = PG_GETARG_BOOL(4);
+	bool		force_flush = PG_GETARG_BOOL(5);
+	bool		outq_detached = false;
 	int32		send_count = 0;
 	int32		receive_count = 0;
 	dsm_segment *seg;
@@ -161,7 +164,7 @@ test_shm_mq_pipelined(PG_FUNCTION_ARGS)
 				 errmsg("number of workers must be a non-negative integer")));
 
 	/* Set up dynamic shared memory segment and background workers. */
-	test_shm_mq_setup(queue_size, nworkers, &seg, &outqh, &inqh);
+	test_shm_mq_setup(queue_size, nworkers, force_flush, &seg, &outqh, &inqh);
 
 	/* Main loop. */
 	for (;;)
@@ -177,7 +180,8 @@ test_shm_mq_pipelined(PG_FUNCTION_ARGS)
 		 */
 		if (send_count < loop_count)
 		{
-			res = shm_mq_send(outqh, message_size, message_contents, true);
+			res = shm_mq_send(outqh, message_size, message_contents, true,
+							  force_flush);
 			if (res == SHM_MQ_SUCCESS)
 			{
 				++send_count;
@@ -188,6 +192,18 @@ test_shm_mq_pipelined(PG_FUNCTION_ARGS)
 						(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
 						 errmsg("could not send message")));
 		}
+		else if (!force_flush && !outq_detached)
+		{
+			/*
+			 * When messages aren't flushed as they're sent, the last few may
+			 * still be pending.  Detaching from the queue publishes them, and
+			 * lets each worker in turn see the end of its input, so that it
+			 * exits and publishes whatever it has pending too.
+			 */
+			shm_mq_detach(shm_mq_get_queue(outqh));
+			outq_detached = true;
+			wait = false;
+		}
 
 		/*
 		 * If we haven't yet received the message the requisite number of
@@ -32,12 +32,13 @@ typedef struct
 	int			workers_total;
 	int			workers_attached;
 	int			workers_ready;
+	bool		force_flush;	/* should workers flush each message? */
 } test_shm_mq_header;
 
 /* Set up dynamic shared memory and background workers for test run. */
 extern void test_shm_mq_setup(int64 queue_size, int32 nworkers,
-				  dsm_segment **seg, shm_mq_handle **output,
-				  shm_mq_handle **input);
+				  bool force_flush, dsm_segment **seg,
+				  shm_mq_handle **output, shm_mq_handle **input);
 
 /* Main entrypoint for a worker. */
 extern void test_shm_mq_main(Datum) pg_attribute_noreturn();
@@ -32,7 +32,8 @@ static void handle_sigterm(SIGNAL_ARGS);
 static void attach_to_queues(dsm_segment *seg, shm_toc *toc,
 				 int myworkernumber, shm_mq_handle **inqhp,
 				 shm_mq_handle **outqhp);
-static void copy_messages(shm_mq_handle *inqh, shm_mq_handle *outqh);
+static void copy_messages(shm_mq_handle *inqh, shm_mq_handle *outqh,
+			  bool force_flush);
 
 /*
  * Background worker entrypoint.
@@ -130,7 +131,7 @@ test_shm_mq_main(Datum main_arg)
 	SetLatch(&registrant->procLatch);
 
 	/* Do the work. */
-	copy_messages(inqh, outqh);
+	copy_messages(inqh, outqh, hdr->force_flush);
 
 	/*
 	 * We're done.  Explicitly detach the shared memory segment so that we
@@ -174,7 +175,7 @@ attach_to_queues(dsm_segment *seg, shm_toc *toc, int myworkernumber,
  * after this point is cleanup.
  */
 static void
-copy_messages(shm_mq_handle *inqh, shm_mq_handle *outqh)
+copy_messages(shm_mq_handle *inqh, shm_mq_handle *outqh, bool force_flush)
 {
 	Size		len;
 	void	   *data;
@@ -191,10 +192,15 @@ copy_messages(shm_mq_handle *inqh, shm_mq_handle *outqh)
 			break;
 
 		/* Send it back out. */
-		res = shm_mq_send(outqh, len, data, false);
+		res = shm_mq_send(outqh, len, data, false, force_flush);
 		if (res != SHM_MQ_SUCCESS)
 			break;
 	}
+
+	/*
+	 * If we didn't flush each message, some may still be pending; that's OK,
+	 * since detaching from the queue on our way out publishes them.
+	 */
 }
 
 /*
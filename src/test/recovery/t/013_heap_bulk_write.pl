@@ -0,0 +1,141 @@
+# Test WAL replay of heaps loaded with the bulk write facility.
+#
+# CREATE TABLE AS, REFRESH MATERIALIZED VIEW and COPY into a table created
+# in the same transaction build the new pages locally and WAL-log them as
+# XLOG_FPI records carrying many blocks each.  Check that a standby and
+# crash recovery both restore every block.
+use strict;
+use warnings;
+
+use PostgresNode;
+use TestLib;
+use Test::More tests => 7;
+
+my $node_master = get_new_node('master');
+$node_master->init(allows_streaming => 1);
+$node_master->append_conf(
+	'postgresql.conf', qq{
+autovacuum = off
+});
+$node_master->start;
+
+$node_master->backup('master_backup');
+my $node_standby = get_new_node('standby');
+$node_standby->init_from_backup($node_master, 'master_backup',
+	has_streaming => 1);
+$node_standby->start;
+
+# Enough rows for a few hundred pages, so that the loads take several
+# batches, each of them several WAL records.
+my $copy_file = $node_master->basedir . '/bulk_copy.data';
+$node_master->safe_psql(
+	'postgres', qq{
+create table bulk_ctas as
+  select g as a, md5(g::text) as b from generate_series(1, 50000) g;
+create materialized view bulk_mv as
+  select a, b from bulk_ctas where a % 2 = 0 with no data;
+refresh materialized view bulk_mv;
+copy bulk_ctas to '$copy_file';
+begin;
+create table bulk_copy (a int, b text);
+copy bulk_copy from '$copy_file';
+commit;
+});
+
+my $check_query = qq{
+select 'bulk_ctas', count(*), sum(a), md5(string_agg(b, ',' order by a)),
+       pg_relation_size('bulk_ctas') > 32 * current_setting('block_size')::int
+  from bulk_ctas
+union all
+select 'bulk_mv', count(*), sum(a), md5(string_agg(b, ',' order by a)),
+       pg_relation_size('bulk_mv') > 32 * current_setting('block_size')::int
+  from bulk_mv
+union all
+select 'bulk_copy', count(*), sum(a), md5(string_agg(b, ',' order by a)),
+       pg_relation_size('bulk_copy') > 32 * current_setting('block_size')::int
+  from bulk_copy;
+};
+
+my $expected = $node_master->safe_psql(
+	'postgres', qq{
+select 'bulk_ctas', count(*), sum(g), md5(string_agg(md5(g::text), ',' order by g)), true
+  from generate_series(1, 50000) g
+union all
+select 'bulk_mv', count(*), sum(g), md5(string_agg(md5(g::text), ',' order by g)), true
+  from generate_series(2, 50000, 2) g
+union all
+select 'bulk_copy', count(*), sum(g), md5(string_agg(md5(g::text), ',' order by g)), true
+  from generate_series(1, 50000) g;
+});
+
+is($node_master->safe_psql('postgres', $check_query),
+	$expected, 'bulk loaded data is correct on master');
+
+my $until_lsn = $node_master->lsn('insert');
+$node_master->wait_for_catchup($node_standby, 'replay', $until_lsn);
+
+is($node_standby->safe_psql('postgres', $check_query),
+	$expected, 'bulk loaded data is replayed on standby');
+
+# Inserting into, updating and deleting from the loaded pages afterwards
+# must work, and be replayed on top of the full-page images.
+$node_master->safe_psql(
+	'postgres', qq{
+insert into bulk_copy values (0, 'zero');
+update bulk_copy set b = upper(b) where a % 1000 = 0;
+delete from bulk_copy where a % 3 = 0;
+});
+
+my $dml_query = qq{
+select count(*), sum(a), md5(string_agg(b, ',' order by a)) from bulk_copy;
+};
+my $dml_expected = $node_master->safe_psql('postgres', $dml_query);
+
+$until_lsn = $node_master->lsn('insert');
+$node_master->wait_for_catchup($node_standby, 'replay', $until_lsn);
+
+is($node_standby->safe_psql('postgres', $dml_query),
+	$dml_expected, 'changes to bulk loaded pages are replayed on standby');
+
+# Now load some more after a checkpoint and crash, so that crash recovery
+# has to replay the full-page images.
+$node_master->safe_psql('postgres', 'checkpoint');
+$node_master->safe_psql(
+	'postgres', qq{
+create table bulk_ctas2 as
+  select g as a, md5(g::text) as b from generate_series(1, 50000) g;
+begin;
+truncate bulk_copy;
+copy bulk_copy from '$copy_file';
+commit;
+refresh materialized view bulk_mv;
+});
+
+my $crash_query = qq{
+select count(*), sum(a), md5(string_agg(b, ',' order by a)) from bulk_ctas2
+union all
+select count(*), sum(a), md5(string_agg(b, ',' order by a)) from bulk_copy
+union all
+select count(*), sum(a), md5(string_agg(b, ',' order by a)) from bulk_mv;
+};
+my $crash_expected = $node_master->safe_psql('postgres', $crash_query);
+
+$until_lsn = $node_master->lsn('insert');
+$node_master->wait_for_catchup($node_standby, 'replay', $until_lsn);
+
+$node_master->stop('immediate');
+$node_master->start;
+
+is($node_master->safe_psql('postgres', $crash_query),
+	$crash_expected, 'bulk loaded data survives crash recovery');
+is($node_master->safe_psql('postgres', $check_query),
+	$expected, 'bulk loaded data is still correct after crash recovery');
+
+is($node_standby->safe_psql('postgres', $crash_query),
+	$crash_expected, 'second bulk load is replayed on standby');
+
+# The standby must still be able to read everything after a restart, which
+# discards whatever it had in shared buffers.
+$node_standby->restart;
+is($node_standby->safe_psql('postgres', $check_query),
+	$expected, 'bulk loaded data is correct on standby after restart');
@@ -21,6 +21,7 @@
 #include <signal.h>
 
 #include "access/htup_details.h"
+#include "access/tableam.h"
 #include "access/transam.h"
 #include "access/tuptoaster.h"
 #include "access/xact.h"
@@ -1098,3 +1099,119 @@ test_atomic_ops(PG_FUNCTION_ARGS)
 
 	PG_RETURN_BOOL(true);
 }
+
+
+/*
+ * A table access method that discards everything inserted into it, to test
+ * that code which only knows how to handle the heap rejects its tables.
+ */
+typedef struct BlackholeScanDescData
+{
+	Relation	rel;
+} BlackholeScanDescData;
+
+static TableScanDesc
+blackhole_scan_begin(Relation rel, Snapshot snapshot, int nkeys, ScanKey key)
+{
+	BlackholeScanDescData *scan = palloc(sizeof(BlackholeScanDescData));
+
+	scan->rel = rel;
+	return (TableScanDesc) scan;
+}
+
+static void
+blackhole_scan_rescan(TableScanDesc scan, ScanKey key)
+{
+}
+
+static void
+blackhole_scan_end(TableScanDesc scan)
+{
+	pfree(scan);
+}
+
+static bool
+blackhole_scan_getnextslot(TableScanDesc scan, ScanDirection direction,
+						   TupleTableSlot *slot)
+{
+	ExecClearTuple(slot);
+	return false;
+}
+
+static bool
+blackhole_fetch_row_version(Relation rel, ItemPointer tid, Snapshot snapshot,
+							TupleTableSlot *slot)
+{
+	return false;
+}
+
+static bool
+blackhole_tuple_satisfies_snapshot(Relation rel, TupleTableSlot *slot,
+								   Snapshot snapshot)
+{
+	/* we never hand out any tuples to check */
+	elog(ERROR, "blackhole table \"%s\" has no tuples",
+		 RelationGetRelationName(rel));
+	return false;
+}
+
+static Oid
+blackhole_tuple_insert(Relation rel, HeapTuple tup, CommandId cid,
+					   int options, BulkInsertState bistate)
+{
+	ItemPointerSetInvalid(&tup->t_self);
+	return HeapTupleGetOid(tup);
+}
+
+static HTSU_Result
+blackhole_tuple_delete(Relation rel, ItemPointer tid, CommandId cid,
+					   Snapshot crosscheck, bool wait,
+					   HeapUpdateFailureData *hufd)
+{
+	elog(ERROR, "blackhole table \"%s\" has no tuples",
+		 RelationGetRelationName(rel));
+	return HeapTupleInvisible;
+}
+
+static HTSU_Result
+blackhole_tuple_update(Relation rel, ItemPointer otid, HeapTuple newtup,
+					   CommandId cid, Snapshot crosscheck, bool wait,
+					   HeapUpdateFailureData *hufd, LockTupleMode *lockmode)
+{
+	elog(ERROR, "blackhole table \"%s\" has no tuples",
+		 RelationGetRelationName(rel));
+	return HeapTupleInvisible;
+}
+
+static void
+blackhole_relation_vacuum(Relation rel, int options,
+						  struct VacuumParams *params,
+						  BufferAccessStrategy bstrategy)
+{
+}
+
+static const TableAmRoutine blackhole_methods = {
+	T_TableAmRoutine,
+
+	blackhole_scan_begin,
+	blackhole_scan_rescan,
+	blackhole_scan_end,
+	blackhole_scan_getnextslot,
+
+	blackhole_fetch_row_version,
+
+	blackhole_tuple_satisfies_snapshot,
+
+	blackhole_tuple_insert,
+	blackhole_tuple_delete,
+	blackhole_tuple_update,
+
+	blackhole_relation_vacuum
+};
+
+PG_FUNCTION_INFO_V1(blackhole_tableam_handler);
+Datum
+blackhole_tableam_handler(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(&blackhole_methods);
+}
@@ -120,6 +120,22 @@ select array(select sum(x+y) s
             from generate_series(1,3) y group by y order by s)
   from generate_series(1,3) x;
 
+-- Test rescans of an aggregate reading a seqscan in batches
+select x, (select count(*) from tenk1 where ten < x)
+  from generate_series(0,2) x;
+
+-- Test that aggregates reading a seqscan in batches see every input row
+explain (costs off)
+  select count(*), sum(unique1), avg(unique1), sum(four),
+         count(distinct stringu1)
+  from tenk1;
+select count(*), sum(unique1), avg(unique1), sum(four),
+       count(distinct stringu1)
+  from tenk1;
+select ten, count(*), sum(unique1), sum(four) from tenk1
+  group by ten order by ten;
+select count(*), sum(unique1), sum(four) from tenk1 where ten = 3;
+
 --
 -- test for bitwise integer aggregates
 --
@@ -92,3 +92,105 @@ vacuum btree_tall_tbl;
 -- need to insert some rows to cause the fast root page to split.
 insert into btree_tall_tbl (id, t)
   select g, repeat('x', 100) from generate_series(1, 500) g;
+
+--
+-- Test skip scans, which use quals on the second index column when there are
+-- none on the first
+--
+create table btree_skip_tbl (a int4, b int4, c int4);
+insert into btree_skip_tbl
+  select g % 4, g, g from generate_series(1, 4000) g;
+insert into btree_skip_tbl (a, b) values (null, 5), (null, 6), (null, null);
+create index btree_skip_idx on btree_skip_tbl (a, b);
+vacuum analyze btree_skip_tbl;
+
+set enable_seqscan to false;
+set enable_indexscan to true;
+set enable_bitmapscan to false;
+explain (costs off)
+select * from btree_skip_tbl where b between 5 and 7 order by a, b;
+select a, b from btree_skip_tbl where b between 5 and 7 order by a, b;
+select a, b from btree_skip_tbl where b between 5 and 7 order by a desc, b desc;
+
+-- changing direction in mid-scan
+begin;
+declare c scroll cursor for
+  select a, b from btree_skip_tbl where b between 5 and 7 order by a, b;
+fetch 2 from c;
+fetch backward 1 from c;
+fetch all from c;
+fetch backward all from c;
+commit;
+
+-- mark and restore
+set enable_hashjoin to false;
+set enable_nestloop to false;
+select v.x, t.a, t.b
+  from (values (1, 'x'), (1, 'y'), (3, 'z')) v(a, x)
+  join btree_skip_tbl t on t.a = v.a
+  where t.b between 5 and 7 order by v.x;
+reset enable_hashjoin;
+reset enable_nestloop;
+
+set enable_indexscan to false;
+set enable_bitmapscan to true;
+explain (costs off)
+select count(*) from btree_skip_tbl where b between 5 and 7;
+select count(*) from btree_skip_tbl where b between 5 and 7;
+
+-- descending first column, with nulls first
+drop index btree_skip_idx;
+create index btree_skip_desc_idx on btree_skip_tbl (a desc, b);
+set enable_indexscan to true;
+set enable_bitmapscan to false;
+select a, b from btree_skip_tbl where b <= 6 order by a desc, b;
+
+-- too many distinct values in the first column to keep skipping
+create table btree_skip_many as
+  select g as a, g % 10 as b from generate_series(1, 5000) g;
+create index btree_skip_many_idx on btree_skip_many (a, b);
+vacuum analyze btree_skip_many;
+select count(*) from btree_skip_many where b = 3;
+select a from btree_skip_many where b = 3 order by a desc limit 3;
+
+reset enable_seqscan;
+reset enable_indexscan;
+reset enable_bitmapscan;
+drop table btree_skip_tbl;
+drop table btree_skip_many;
+
+--
+-- Test parallel btree index builds
+--
+create table btree_parallel_tbl as
+  select g as a, (g * 7919) % 10000 as b, g % 100 as c
+  from generate_series(1, 10000) g;
+alter table btree_parallel_tbl set (parallel_workers = 2);
+set max_parallel_maintenance_workers = 2;
+
+set client_min_messages = debug1;
+create index btree_parallel_b_idx on btree_parallel_tbl (b);
+create unique index btree_parallel_b_uniq on btree_parallel_tbl (b);
+\set VERBOSITY terse
+create unique index btree_parallel_c_uniq on btree_parallel_tbl (c);
+\set VERBOSITY default
+create index concurrently btree_parallel_ca_idx on btree_parallel_tbl (c, a);
+set max_parallel_maintenance_workers = 0;
+create index btree_parallel_a_idx on btree_parallel_tbl (a);
+reset client_min_messages;
+reset max_parallel_maintenance_workers;
+
+select c.relname, c.reltuples, i.indisvalid
+  from pg_class c join pg_index i on i.indexrelid = c.oid
+  where i.indrelid = 'btree_parallel_tbl'::regclass
+  order by c.relname;
+
+set enable_seqscan to false;
+set enable_bitmapscan to false;
+select b from btree_parallel_tbl where b < 5 order by b;
+select b from btree_parallel_tbl where b > 9994 order by b;
+select count(*) from btree_parallel_tbl where b between 1000 and 1999;
+select count(*), min(a), max(a) from btree_parallel_tbl where c = 42;
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table btree_parallel_tbl;
@@ -411,6 +411,40 @@ test1
 
 SELECT * FROM instead_of_insert_tbl;
 
+-- test PARALLEL option
+CREATE TABLE parallel_copy_tbl (a int, b text DEFAULT 'x', c int CHECK (c > 0));
+CREATE INDEX ON parallel_copy_tbl (a);
+COPY parallel_copy_tbl TO stdout WITH (PARALLEL 2); -- fail
+COPY parallel_copy_tbl (a, c) FROM stdin WITH (FORMAT csv, HEADER, PARALLEL 2);
+a,c
+1,10
+2,20
+3,30
+4,40
+5,50
+\.
+SELECT count(*), sum(a), sum(c), min(b), max(b) FROM parallel_copy_tbl;
+
+-- test multi-insert buffering for partitions
+CREATE TABLE parted_copytest (a int, b int, c text) PARTITION BY LIST (b);
+CREATE TABLE parted_copytest_a1 (c text, b int, a int);
+ALTER TABLE parted_copytest ATTACH PARTITION parted_copytest_a1 FOR VALUES IN (1);
+CREATE TABLE parted_copytest_a2 PARTITION OF parted_copytest FOR VALUES IN (2);
+CREATE UNIQUE INDEX ON parted_copytest_a2 (a);
+COPY parted_copytest FROM stdin;
+1	1	one
+2	2	two
+3	1	three
+4	2	four
+\.
+SELECT tableoid::regclass, * FROM parted_copytest ORDER BY a;
+COPY parted_copytest FROM stdin; -- fail, reporting the right line
+5	1	five
+6	2	six
+7	1	seven
+2	2	two again
+\.
+DROP TABLE parted_copytest;
 
 -- clean up
 DROP TABLE forcetest;
@@ -425,3 +459,4 @@ DROP FUNCTION fn_x_after();
 DROP TABLE instead_of_insert_tbl;
 DROP VIEW instead_of_insert_tbl_view;
 DROP FUNCTION fun_instead_of_insert_tbl();
+DROP TABLE parallel_copy_tbl;
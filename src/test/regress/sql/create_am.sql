@@ -68,3 +68,58 @@ DROP ACCESS METHOD gist2;
 
 -- Drop access method cascade
 DROP ACCESS METHOD gist2 CASCADE;
+
+--
+-- Test table access methods
+--
+
+-- Make heap2 with heap_tableam_handler.  It stores its tables exactly like
+-- the heap does, but through a separate pg_am entry.
+CREATE ACCESS METHOD heap2 TYPE TABLE HANDLER heap_tableam_handler;
+
+-- Verify return type checks for handlers
+CREATE ACCESS METHOD bogus TYPE TABLE HANDLER bthandler;
+CREATE ACCESS METHOD bogus TYPE INDEX HANDLER heap_tableam_handler;
+
+SELECT amname, amhandler, amtype FROM pg_am WHERE amtype = 't' ORDER BY 1;
+
+-- Create a table using heap2, and check that the basic operations go
+-- through it
+CREATE TABLE tableam_tbl_heap2(f1 int) USING heap2;
+INSERT INTO tableam_tbl_heap2 VALUES (1), (2), (3);
+UPDATE tableam_tbl_heap2 SET f1 = f1 * 10 WHERE f1 = 2;
+DELETE FROM tableam_tbl_heap2 WHERE f1 = 1 RETURNING *;
+SELECT f1 FROM tableam_tbl_heap2 ORDER BY f1;
+VACUUM tableam_tbl_heap2;
+SELECT f1 FROM tableam_tbl_heap2 ORDER BY f1;
+
+SELECT a.amname FROM pg_class c, pg_am a
+WHERE c.relam = a.oid AND c.oid = 'tableam_tbl_heap2'::regclass;
+
+-- blackhole discards whatever is inserted into it.  Its own routines work,
+-- but the parts of the system that still use the heap directly must refuse
+-- to touch its tables.
+CREATE ACCESS METHOD blackhole TYPE TABLE HANDLER blackhole_tableam_handler;
+CREATE TABLE tableam_tbl_blackhole(f1 int) USING blackhole;
+INSERT INTO tableam_tbl_blackhole VALUES (1), (2), (3);
+SELECT f1 FROM tableam_tbl_blackhole;
+VACUUM tableam_tbl_blackhole;
+COPY tableam_tbl_blackhole TO stdout;
+CREATE INDEX tableam_tbl_blackhole_idx ON tableam_tbl_blackhole(f1);
+VACUUM FULL tableam_tbl_blackhole;
+DROP TABLE tableam_tbl_blackhole;
+DROP ACCESS METHOD blackhole;
+
+-- USING must name a table access method
+CREATE TABLE tableam_tbl_btree(f1 int) USING btree;
+CREATE TABLE tableam_tbl_nonexistent(f1 int) USING nonexistent;
+
+-- Partitioned tables have no storage of their own
+CREATE TABLE tableam_parted_heap2 (a text) PARTITION BY LIST (a) USING heap2;
+
+-- Try to drop access method: fail because of dependent objects
+DROP ACCESS METHOD heap2;
+
+-- cleanup
+DROP TABLE tableam_tbl_heap2;
+DROP ACCESS METHOD heap2;
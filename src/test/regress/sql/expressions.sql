@@ -34,3 +34,17 @@ SELECT current_schema;
 SET search_path = 'pg_catalog';
 SELECT current_schema;
 RESET search_path;
+
+
+--
+-- Tests for ScalarArrayOpExpr with a large constant array, which is
+-- evaluated with a hash table
+--
+SELECT x, x IN (1, 2, 3, 4, 5, 6, 7, 8, 9) AS in_list,
+       x IN (1, 2, 3, 4, 5, 6, 7, 8, NULL) AS in_list_null,
+       x::text IN ('1', '2', '3', '4', '5', '6', '7', '8', '9') AS text_in
+FROM (VALUES (1), (9), (10), (NULL)) AS v(x);
+-- NOT IN is still done the old way, but must agree
+SELECT x, x NOT IN (1, 2, 3, 4, 5, 6, 7, 8, 9) AS not_in_list,
+       x = ANY ('{1,2,3,4,5,6,7,8,9,1,2,3}'::int[]) AS any_dups
+FROM (VALUES (1), (10), (NULL)) AS v(x);
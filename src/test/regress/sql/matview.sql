@@ -236,3 +236,21 @@ SELECT mvtest_func();
 SELECT * FROM mvtest1;
 SELECT * FROM mvtest2;
 ROLLBACK;
+
+-- REFRESH builds the new heap's pages locally; check a refresh spanning
+-- many pages, and a concurrent one, which does the same for its diff table
+CREATE TABLE mvtest_bulk_t AS
+  SELECT g AS a, repeat('x', g % 200) AS b FROM generate_series(1, 20000) g;
+CREATE MATERIALIZED VIEW mvtest_bulk AS
+  SELECT a, b FROM mvtest_bulk_t WHERE a % 2 = 0 WITH NO DATA;
+REFRESH MATERIALIZED VIEW mvtest_bulk;
+SELECT count(*), count(DISTINCT ctid), sum(a), sum(length(b)) FROM mvtest_bulk;
+CREATE UNIQUE INDEX mvtest_bulk_a ON mvtest_bulk (a);
+UPDATE mvtest_bulk_t SET b = 'changed' WHERE a % 1000 = 2;
+DELETE FROM mvtest_bulk_t WHERE a % 4 = 0;
+REFRESH MATERIALIZED VIEW CONCURRENTLY mvtest_bulk;
+SELECT count(*), sum(a), count(*) FILTER (WHERE b = 'changed') FROM mvtest_bulk;
+REFRESH MATERIALIZED VIEW mvtest_bulk;
+SELECT count(*), sum(a), count(*) FILTER (WHERE b = 'changed') FROM mvtest_bulk;
+DROP MATERIALIZED VIEW mvtest_bulk;
+DROP TABLE mvtest_bulk_t;
@@ -1151,17 +1151,26 @@ SELECT oid, opcname FROM pg_opclass WHERE NOT amvalidate(oid);
 
 SELECT p1.oid, p1.amname
 FROM pg_am AS p1
-WHERE p1.amhandler = 0;
+WHERE p1.amhandler = 0 OR p1.amtype NOT IN ('i', 't');
 
 -- Check for amhandler functions with the wrong signature
 
 SELECT p1.oid, p1.amname, p2.oid, p2.proname
 FROM pg_am AS p1, pg_proc AS p2
-WHERE p2.oid = p1.amhandler AND
+WHERE p2.oid = p1.amhandler AND p1.amtype = 'i' AND
     (p2.prorettype != 'index_am_handler'::regtype OR p2.proretset
      OR p2.pronargs != 1
      OR p2.proargtypes[0] != 'internal'::regtype);
 
+-- Check for table amhandler functions with the wrong signature
+
+SELECT p1.oid, p1.amname, p2.oid, p2.proname
+FROM pg_am AS p1, pg_proc AS p2
+WHERE p2.oid = p1.amhandler AND p1.amtype = 't' AND
+    (p2.prorettype != 'table_am_handler'::regtype OR p2.proretset
+     OR p2.pronargs != 1
+     OR p2.proargtypes[0] != 'internal'::regtype);
+
 
 -- **************** pg_amop ****************
 
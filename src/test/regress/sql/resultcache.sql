@@ -0,0 +1,66 @@
+--
+-- Result Cache
+--
+
+-- Perform an EXPLAIN ANALYZE on a query, hiding the memory usage and,
+-- optionally, the eviction count, which depend on the platform.
+create function explain_resultcache(query text, hide_evictions bool) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute format('explain (analyze, costs off, summary off, timing off) %s',
+            query)
+    loop
+        if hide_evictions = true then
+            ln := regexp_replace(ln, 'Evictions: \d+', 'Evictions: N');
+        end if;
+        ln := regexp_replace(ln, 'Memory Usage: \d+', 'Memory Usage: N');
+        return next ln;
+    end loop;
+end;
+$$;
+
+CREATE TABLE rc_outer (a int);
+INSERT INTO rc_outer SELECT i % 10 FROM generate_series(1, 1000) i;
+-- each value five times in a row
+CREATE TABLE rc_outer2 (a int);
+INSERT INTO rc_outer2 SELECT i / 5 FROM generate_series(0, 4999) i;
+CREATE TABLE rc_inner (a int, b int);
+INSERT INTO rc_inner SELECT i, i FROM generate_series(0, 9999) i;
+CREATE INDEX rc_inner_a_idx ON rc_inner (a);
+ANALYZE rc_outer, rc_outer2, rc_inner;
+
+SET enable_hashjoin TO off;
+SET enable_mergejoin TO off;
+
+-- Off by default
+EXPLAIN (COSTS OFF)
+SELECT COUNT(*), SUM(i.b) FROM rc_outer o INNER JOIN rc_inner i ON o.a = i.a;
+
+SET enable_resultcache TO on;
+
+-- Ten distinct keys: every scan after the first for each is a cache hit
+SELECT explain_resultcache('
+SELECT COUNT(*), SUM(i.b) FROM rc_outer o INNER JOIN rc_inner i ON o.a = i.a;',
+false);
+
+SELECT COUNT(*), SUM(i.b) FROM rc_outer o INNER JOIN rc_inner i ON o.a = i.a;
+
+-- Too many keys to cache them all in 64kB, so some entries are evicted
+SET work_mem TO '64kB';
+SELECT explain_resultcache('
+SELECT COUNT(*), SUM(i.b) FROM rc_outer2 o INNER JOIN rc_inner i ON o.a = i.a;',
+true);
+
+SELECT COUNT(*), SUM(i.b) FROM rc_outer2 o INNER JOIN rc_inner i ON o.a = i.a;
+
+RESET work_mem;
+RESET enable_resultcache;
+RESET enable_mergejoin;
+RESET enable_hashjoin;
+
+DROP TABLE rc_outer, rc_outer2, rc_inner;
+DROP FUNCTION explain_resultcache(text, bool);
@@ -103,3 +103,20 @@ COPY (SELECT 1 INTO frak UNION SELECT 2) TO 'blob';
 SELECT * FROM (SELECT 1 INTO f) bar;
 CREATE VIEW foo AS SELECT 1 INTO b;
 INSERT INTO b SELECT 1 INTO f;
+
+--
+-- CREATE TABLE AS builds the new table's pages locally; check that a load
+-- spanning many pages, with some toasted values, reads back correctly
+--
+CREATE TABLE ctas_bulk AS
+  SELECT g AS a, repeat('x', g % 200) AS b,
+         CASE WHEN g % 5000 = 0 THEN
+           (SELECT string_agg(md5(i::text), '') FROM generate_series(g, g + 299) i)
+         END AS c
+  FROM generate_series(1, 20000) g;
+SELECT count(*), count(DISTINCT ctid), sum(a), sum(length(b)),
+       count(c), sum(length(c))
+  FROM ctas_bulk;
+SELECT a FROM ctas_bulk
+  WHERE c = (SELECT string_agg(md5(i::text), '') FROM generate_series(a, a + 299) i);
+DROP TABLE ctas_bulk;
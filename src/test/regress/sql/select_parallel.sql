@@ -126,6 +126,26 @@ select string4 from tenk1 order by string4 limit 5;
 reset max_parallel_workers;
 reset enable_hashagg;
 
+-- the query feeding an INSERT or CREATE TABLE AS can run in parallel, with
+-- the leader inserting the rows
+create table parallel_write (unique1 int, stringu1 name);
+explain (costs off)
+  insert into parallel_write select unique1, stringu1 from tenk1
+  where hundred > 1;
+insert into parallel_write select unique1, stringu1 from tenk1
+  where hundred > 1;
+select count(*) from parallel_write;
+explain (costs off)
+  create table parallel_write_ctas as select unique1 from tenk1
+  where hundred > 1;
+-- but not if inserting into the target could run parallel-unsafe code
+create function parallel_write_check(int) returns bool as
+  $$begin return $1 >= 0; end$$ language plpgsql;
+alter table parallel_write add check (parallel_write_check(unique1));
+explain (costs off)
+  insert into parallel_write select unique1, stringu1 from tenk1
+  where hundred > 1;
+
 set force_parallel_mode=1;
 
 explain (costs off)
@@ -134,6 +154,10 @@ explain (costs off)
 -- to increase the parallel query test coverage
 EXPLAIN (analyze, timing off, summary off, costs off) SELECT * FROM tenk1;
 
+-- transient record types made in a worker must be known to the leader
+select row(unique1, ten) as r, array[row(ten, unique1)] as a
+  from tenk1 where unique1 < 3 order by unique1;
+
 -- provoke error in worker
 select stringu1::int2 from tenk1 where unique1 = 1;
 
@@ -282,3 +282,114 @@ EXPLAIN (COSTS OFF)
  SELECT * FROM functional_dependencies WHERE a = 1 AND b = '1' AND c = 1;
 
 RESET random_page_cost;
+
+-- MCV lists
+CREATE TABLE mcv_lists (
+    filler1 TEXT,
+    filler2 NUMERIC,
+    a INT,
+    b TEXT,
+    filler3 DATE,
+    c INT,
+    d TEXT
+);
+
+-- helper function returning the estimated and actual number of rows
+CREATE FUNCTION check_estimated_rows(text) RETURNS TABLE (estimated int, actual int)
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    ln text;
+    tmp text[];
+BEGIN
+    FOR ln IN EXECUTE format('EXPLAIN ANALYZE %s', $1)
+    LOOP
+        tmp := regexp_match(ln, 'rows=(\d*) .* rows=(\d*)');
+        RETURN QUERY SELECT tmp[1]::int, tmp[2]::int;
+        RETURN;
+    END LOOP;
+END;
+$$;
+
+-- perfectly correlated groups
+INSERT INTO mcv_lists (a, b, c, filler1)
+     SELECT mod(i,100), mod(i,100), mod(i,100), i FROM generate_series(1,5000) s(i);
+
+ANALYZE mcv_lists;
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a = 1 AND b = ''1''');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a < 10 AND c < 10');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a = 1 AND b = ''1'' AND c = 1');
+
+-- create statistics
+CREATE STATISTICS mcv_lists_stats (mcv) ON a, b, c FROM mcv_lists;
+
+ANALYZE mcv_lists;
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a = 1 AND b = ''1''');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a < 10 AND c < 10');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a = 1 AND b = ''1'' AND c = 1');
+
+-- check change of column type resets the MCV list
+SELECT stxmcv IS NOT NULL AS built FROM pg_statistic_ext WHERE stxname = 'mcv_lists_stats';
+
+ALTER TABLE mcv_lists ALTER COLUMN c TYPE numeric;
+
+SELECT stxmcv IS NOT NULL AS built FROM pg_statistic_ext WHERE stxname = 'mcv_lists_stats';
+
+ANALYZE mcv_lists;
+
+SELECT stxmcv IS NOT NULL AS built FROM pg_statistic_ext WHERE stxname = 'mcv_lists_stats';
+
+-- 100 distinct combinations with NULL values, all in the MCV list
+TRUNCATE mcv_lists;
+DROP STATISTICS mcv_lists_stats;
+
+INSERT INTO mcv_lists (a, b, c, filler1)
+     SELECT
+         (CASE WHEN mod(i,100) = 1 THEN NULL ELSE mod(i,100) END),
+         (CASE WHEN mod(i,100) <= 1 THEN NULL ELSE mod(i,100) END),
+         (CASE WHEN mod(i,100) <= 2 THEN NULL ELSE mod(i,100) END),
+         i
+     FROM generate_series(1,5000) s(i);
+
+ANALYZE mcv_lists;
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a IS NULL AND b IS NULL');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a IS NULL AND b IS NULL AND c IS NULL');
+
+-- create statistics
+CREATE STATISTICS mcv_lists_stats (mcv) ON a, b, c FROM mcv_lists;
+
+ANALYZE mcv_lists;
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a IS NULL AND b IS NULL');
+
+SELECT * FROM check_estimated_rows('SELECT * FROM mcv_lists WHERE a IS NULL AND b IS NULL AND c IS NULL');
+
+-- the MCV list stores column values, so it's only visible to users that
+-- can read all the columns covered by the statistics object
+SELECT statistics_name, attnames, kinds, mcv_list IS NOT NULL AS built
+  FROM pg_stats_ext WHERE statistics_name = 'mcv_lists_stats';
+
+CREATE ROLE regress_stats_user1;
+GRANT SELECT (a, b) ON mcv_lists TO regress_stats_user1;
+SET SESSION AUTHORIZATION regress_stats_user1;
+SELECT stxmcv FROM pg_statistic_ext WHERE stxname = 'mcv_lists_stats'; -- fail
+SELECT stxname, stxkind FROM pg_statistic_ext WHERE stxname = 'mcv_lists_stats';
+SELECT statistics_name FROM pg_stats_ext WHERE statistics_name = 'mcv_lists_stats';
+RESET SESSION AUTHORIZATION;
+GRANT SELECT (c) ON mcv_lists TO regress_stats_user1;
+SET SESSION AUTHORIZATION regress_stats_user1;
+SELECT statistics_name, mcv_list IS NOT NULL AS built
+  FROM pg_stats_ext WHERE statistics_name = 'mcv_lists_stats';
+RESET SESSION AUTHORIZATION;
+
+DROP TABLE mcv_lists;
+DROP FUNCTION check_estimated_rows(text);
+DROP ROLE regress_stats_user1;
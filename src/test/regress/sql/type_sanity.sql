@@ -343,12 +343,13 @@ WHERE relkind NOT IN ('r', 'i', 'S', 't', 'v', 'm', 'c', 'f', 'p') OR
     relpersistence NOT IN ('p', 'u', 't') OR
     relreplident NOT IN ('d', 'n', 'f', 'i');
 
--- Indexes should have an access method, others not.
+-- Indexes should have an access method, tables may have one (zero means
+-- the heap), others not.
 
 SELECT p1.oid, p1.relname
 FROM pg_class as p1
 WHERE (p1.relkind = 'i' AND p1.relam = 0) OR
-    (p1.relkind != 'i' AND p1.relam != 0);
+    (p1.relkind NOT IN ('i', 'r', 'm', 't') AND p1.relam != 0);
 
 -- **************** pg_attribute ****************
 